@@ -1,4 +1,4 @@
-classdef (Abstract) BaseClass < handle
+classdef (Abstract) BaseClass < matlab.mixin.Copyable
 %mexcpp.BaseClass   Base Matlab class to wrap C++ class instance
 %
 %   An abstract base class to be paird with the mexObjectHandler() template function
@@ -19,6 +19,29 @@ classdef (Abstract) BaseClass < handle
 %      varargout = obj.mexfcn(obj, 'command', varargin) - backend action
 %      varargout = obj.mexfcn('command',varargin)       - backend static action
 %
+%   For frequently called actions, pass the backend handle directly to skip the
+%   backend property lookup (and its copy) in the MEX function:
+%
+%      varargout = obj.mexfcn(obj.backend, obj, 'command', varargin) - backend action
+%
+%   copy(obj) clones the backend C++ object with its copy constructor (the 'clone'
+%   action) without converting its state to mxArrays. The C++ class must be
+%   copy-constructible; large members held by mexCowPtr are shared until modified.
+%
+%   A backend deriving from mexSetGetClass may support saving its state to a file
+%   with the 'saveToFile' and 'loadFromFile' actions, which stream the state without
+%   an in-memory copy. The saveobjToFile and loadobjFromFile helpers use them to keep
+%   only a file reference in a MAT-file:
+%
+%      function B = saveobj(obj)
+%         B = obj.saveobjToFile(); % or obj.saveobjToFile(filename)
+%      end
+%      ...
+%      function obj = loadobj(B) % Static
+%         obj = derivedClass();
+%         obj.loadobjFromFile(B);
+%      end
+%
 %   It is also permissible to use this file as a template for a user's own classdef
 %   instead of using it as a base class. For such use, keep backend property intact
 %   as is (directly accessed by mexObjectHandler) and match mexfcn with the compiled 
@@ -47,4 +70,38 @@ classdef (Abstract) BaseClass < handle
          end
       end
    end
+   
+   methods (Access = protected)
+      function cpObj = copyElement(obj)
+         % clone the backend (not copied as a NonCopyable property)
+         cpObj = copyElement@matlab.mixin.Copyable(obj);
+         if ~isempty(obj.backend)
+            cpObj.backend = obj.mexfcn(obj.backend, obj, 'clone');
+         end
+      end
+   end
+   
+   methods (Access = protected, Hidden)
+      function B = saveobjToFile(obj, filename)
+         %saveobjToFile   saveobj helper to store the backend state in a file
+         %   B = saveobjToFile(obj) saves the backend state to a new temporary file
+         %   and returns struct B with its path in field 'mexfile'. B is small to
+         %   be saved in a MAT-file, but the file must be kept along with it.
+         %
+         %   B = saveobjToFile(obj, filename) saves to the given file instead.
+         if nargin < 2 || isempty(filename)
+            filename = [tempname '.mexobj'];
+         end
+         filename = char(filename);
+         obj.mexfcn(obj.backend, obj, 'saveToFile', filename);
+         B.mexfile = filename;
+      end
+      
+      function loadobjFromFile(obj, B)
+         %loadobjFromFile   loadobj helper to restore the backend state from a file
+         %   loadobjFromFile(obj, B) loads the backend state from the file
+         %   referenced by struct B returned by saveobjToFile.
+         obj.mexfcn(obj.backend, obj, 'loadFromFile', B.mexfile);
+      end
+   end
 end
@@ -0,0 +1,63 @@
+%mexBench Benchmark MATLAB class wrapper (see mexutils_benchmark.m)
+classdef mexBench < mexcpp.BaseClass
+   properties (Dependent,NonCopyable,Transient)
+      Scalar
+      Large
+   end
+   methods (Access = protected, Static, Hidden)
+      varargout = mexfcn(varargin)
+   end
+   methods (Static)
+      function noopStatic()
+         mexBench.mexfcn('noop');
+      end
+      function n = getString(str)
+         n = mexBench.mexfcn('getString', str);
+      end
+      function varargout = stats()
+         % call statistics, if built with MEXUTILS_ENABLE_STATS
+         [varargout{1:nargout}] = mexBench.mexfcn('__stats');
+      end
+   end
+   methods
+      function obj = mexBench(varargin)
+         obj = obj@mexcpp.BaseClass(varargin{:});
+      end
+      
+      %% Noop - action round-trip with the backend handle (fast path)
+      function noop(obj)
+         obj.mexfcn(obj.backend, obj, 'noop');
+      end
+      
+      %% NoopLookup - action round-trip with the backend property lookup
+      function noopLookup(obj)
+         obj.mexfcn(obj, 'noop');
+      end
+      
+      function B = save(obj)
+         B = obj.mexfcn(obj.backend, obj, 'save');
+      end
+      function load(obj, B)
+         obj.mexfcn(obj.backend, obj, 'load', B);
+      end
+      function saveToFile(obj, filename)
+         obj.mexfcn(obj.backend, obj, 'saveToFile', filename);
+      end
+      function loadFromFile(obj, filename)
+         obj.mexfcn(obj.backend, obj, 'loadFromFile', filename);
+      end
+      
+      function val = get.Scalar(obj)
+         val = obj.mexfcn(obj.backend,obj,'get','Scalar');
+      end
+      function val = get.Large(obj)
+         val = obj.mexfcn(obj.backend,obj,'get','Large');
+      end
+      function set.Scalar(obj,val)
+         obj.mexfcn(obj.backend,obj,'set','Scalar',val);
+      end
+      function set.Large(obj,val)
+         obj.mexfcn(obj.backend,obj,'set','Large',val);
+      end
+   end
+end
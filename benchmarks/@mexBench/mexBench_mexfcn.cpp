@@ -0,0 +1,7 @@
+#include "mex.h"
+#include "../mexBench.h"
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexObjectHandler<mexBench>(nlhs, plhs, nrhs, prhs);
+}
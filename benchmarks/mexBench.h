@@ -0,0 +1,104 @@
+/** \file mexBench.h
+ * C++ header file containing the backend class of the mexutils benchmarks
+ */
+
+#pragma once
+
+#include "mex.h"
+#include "mexObjectHandler.h"
+#include "mexArrayView.h"
+#include "mexFileArchive.h"
+#include "mexGetString.h"
+#include "mexSerializer.h"
+
+#include <string>
+
+/**
+ * \brief Backend class of the benchmarks
+ *
+ * A minimal mexSetGetClass with one scalar and one array property, so the benchmarks
+ * measure the overhead of mexutils rather than the work of the class:
+ *
+ * * `noop` object and static actions (call round-trip),
+ * * `Scalar` and `Large` properties (get/set of scalar and large payloads),
+ * * `getString` static action (mexGetString() of its argument, returns the length), and
+ * * `save`/`load` and `saveToFile`/`loadFromFile` (serialization bandwidth).
+ *
+ * Shared by the benchmark MEX function (benchmarks/@mexBench) and the standalone
+ * microbenchmark (benchmarks/standalone).
+ */
+class mexBench : public mexSetGetClass
+{
+public:
+  mexBench(const mxArray *mxObj, int nrhs, const mxArray *prhs[]) : Scalar(0.0) {}
+
+  static std::string get_classname() { return "mexBench"; } // must match the Matlab classname
+
+  static const mexStaticActionTable &static_action_table()
+  {
+    static const mexStaticActionTable table({{"noop", &mexBench::noop_static},
+                                            {"getString", &mexBench::get_string}});
+    return table;
+  }
+
+  static const mexActionTable<mexBench> &action_table()
+  {
+    static const mexActionTable<mexBench> table(mexSetGetClass::action_table(),
+                                                {{"noop", &mexBench::noop_action}});
+    return table;
+  }
+
+  void noop_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {}
+
+  template <class Archive>
+  void serialize(Archive &ar) { ar(Scalar, Large); }
+
+protected:
+  void set_prop(const mxArray *mxObj, const std::string name, const mxArray *value)
+  {
+    if (name == "Scalar")
+    {
+      if (!mxIsDouble(value) || !mxIsScalar(value) || mxIsComplex(value))
+        throw mexRuntimeError("mexBench:invalidPropertyValue", "Scalar must be a real double scalar.");
+      Scalar = mxGetScalar(value);
+    }
+    else if (name == "Large")
+    {
+      mexArrayView<const double> view(value); // throws if not real double
+      Large.assign(view.begin(), view.end());
+    }
+    else
+    {
+      throw mexRuntimeError("mexBench:invalidPropertyName", std::string("Unknown property name:") + name);
+    }
+  }
+
+  mxArray *get_prop(const mxArray *mxObj, const std::string name)
+  {
+    if (name == "Scalar")
+      return mxCreateDoubleScalar(Scalar);
+    if (name == "Large")
+      return export_prop(static_cast<const mexVector<double> &>(Large));
+    throw mexRuntimeError("mexBench:invalidPropertyName", std::string("Unknown property name:") + name);
+  }
+
+  mxArray *save_prop(const mxArray *mxObj) { return mexSerialize(*this); }
+  void load_prop(const mxArray *mxObj, const mxArray *value) { mexDeserialize(value, *this); }
+  void save_to_file(const mxArray *mxObj, const std::string &path) { mexSerializeToFile(*this, path); }
+  void load_from_file(const mxArray *mxObj, const std::string &path) { mexDeserializeFromFile(path, *this); }
+
+private:
+  double Scalar;
+  mexVector<double> Large;
+
+  static void noop_static(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {}
+
+  static void get_string(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nrhs != 1 || nlhs > 1)
+      throw mexRuntimeError("getString:invalidArguments", "getString takes one string and returns up to one output.");
+    std::string str = mexGetString(prhs[0]);
+    if (nlhs > 0)
+      plhs[0] = mxCreateDoubleScalar((double)str.size());
+  }
+};
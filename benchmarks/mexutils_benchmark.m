@@ -0,0 +1,75 @@
+function results = mexutils_benchmark(n)
+%MEXUTILS_BENCHMARK   Measure the overhead of the mexutils hot paths
+%   MEXUTILS_BENCHMARK() runs the benchmarks with the mexBench class and prints
+%   the time per call (and the bandwidth of the save/load benchmarks).
+%
+%   MEXUTILS_BENCHMARK(N) repeats each benchmark N times (default: 10000).
+%
+%   RESULTS = MEXUTILS_BENCHMARK(...) returns a table of the results instead of
+%   printing them.
+%
+%   The times include the MATLAB method call overhead. See
+%   benchmarks/standalone for the microbenchmark of the C++ side only.
+
+if nargin < 1
+   n = 10000;
+end
+
+large = rand(1e6, 1); % 8 MB payload
+str = repmat('a', 1, 1000);
+obj = mexBench();
+obj.Large = large;
+file = [tempname '.mexobj'];
+cleanup = onCleanup(@() delete_if_exists(file));
+
+names = {};
+times = [];
+bytes = [];
+
+bench('create/destroy', @() delete(mexBench()), n, 0);
+bench('noop (fast path)', @() obj.noop(), n, 0);
+bench('noop (property lookup)', @() obj.noopLookup(), n, 0);
+bench('noop (static)', @() mexBench.noopStatic(), n, 0);
+bench('get scalar', @() obj.Scalar, n, 0);
+bench('set scalar', @() set_prop(obj, 'Scalar', 1), n, 0);
+bench('get large', @() obj.Large, max(1, n / 100), 8 * numel(large));
+bench('set large', @() set_prop(obj, 'Large', large), max(1, n / 100), 8 * numel(large));
+bench('mexGetString (1000 chars)', @() mexBench.getString(str), n, 0);
+B = obj.save();
+bench('save', @() obj.save(), max(1, n / 100), 8 * numel(large));
+bench('load', @() obj.load(B), max(1, n / 100), 8 * numel(large));
+bench('saveToFile', @() obj.saveToFile(file), max(1, n / 1000), 8 * numel(large));
+bench('loadFromFile', @() obj.loadFromFile(file), max(1, n / 1000), 8 * numel(large));
+
+microseconds = times * 1e6;
+MBps = bytes ./ times / 2^20;
+MBps(bytes == 0) = NaN;
+T = table(names, microseconds, MBps, 'VariableNames', {'Benchmark', 'TimePerCall_us', 'Bandwidth_MBps'});
+
+if nargout > 0
+   results = T;
+else
+   disp(T);
+end
+
+   function bench(name, fcn, reps, nbytes)
+      fcn(); % warm up
+      t = tic;
+      for k = 1:reps
+         fcn();
+      end
+      names{end+1, 1} = name;
+      times(end+1, 1) = toc(t) / reps;
+      bytes(end+1, 1) = nbytes;
+   end
+end
+
+function set_prop(obj, name, val)
+obj.(name) = val;
+end
+
+function delete_if_exists(file)
+if exist(file, 'file')
+   delete(file);
+end
+end
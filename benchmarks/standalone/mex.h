@@ -0,0 +1,487 @@
+/** \file mex.h
+ * Minimal functional stand-in for MATLAB's mex.h/matrix.h to run mexutils without MATLAB
+ *
+ * Implements the subset of the C MEX API used by the mexutils headers on the host heap,
+ * for the standalone microbenchmark. Errors raised with mexErrMsgIdAndTxt() are thrown as
+ * mexstub::mex_error. Arrays returned by mxGetProperty() are temporaries, released by
+ * mexstub::end_call() as MATLAB does when the MEX function returns.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cctype>
+#include <initializer_list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef ptrdiff_t mwSignedIndex;
+typedef char16_t mxChar;
+typedef bool mxLogical;
+
+typedef enum
+{
+  mxUNKNOWN_CLASS = 0,
+  mxCELL_CLASS,
+  mxSTRUCT_CLASS,
+  mxLOGICAL_CLASS,
+  mxCHAR_CLASS,
+  mxVOID_CLASS,
+  mxDOUBLE_CLASS,
+  mxSINGLE_CLASS,
+  mxINT8_CLASS,
+  mxUINT8_CLASS,
+  mxINT16_CLASS,
+  mxUINT16_CLASS,
+  mxINT32_CLASS,
+  mxUINT32_CLASS,
+  mxINT64_CLASS,
+  mxUINT64_CLASS,
+  mxFUNCTION_CLASS,
+  mxOBJECT_CLASS
+} mxClassID;
+
+typedef enum
+{
+  mxREAL,
+  mxCOMPLEX
+} mxComplexity;
+
+struct mxArray
+{
+  mxClassID id = mxDOUBLE_CLASS;
+  bool complex = false;
+  std::vector<mwSize> dims{0, 0};
+  void *data = nullptr;
+  void *imag = nullptr;
+  std::vector<mxArray *> cells;                  // cell elements or struct fields (numel*nfields)
+  std::vector<std::string> fields;               // struct field names
+  std::string classname;                         // object class name
+  std::map<std::string, mxArray *> properties;   // object properties (scalar objects only)
+  std::vector<mxArray *> objelems;               // object array elements (stub)
+};
+
+namespace mexstub
+{
+inline size_t elsize(mxClassID id)
+{
+  switch (id)
+  {
+  case mxLOGICAL_CLASS:
+  case mxINT8_CLASS:
+  case mxUINT8_CLASS:
+    return 1;
+  case mxCHAR_CLASS:
+  case mxINT16_CLASS:
+  case mxUINT16_CLASS:
+    return 2;
+  case mxSINGLE_CLASS:
+  case mxINT32_CLASS:
+  case mxUINT32_CLASS:
+    return 4;
+  case mxDOUBLE_CLASS:
+  case mxINT64_CLASS:
+  case mxUINT64_CLASS:
+    return 8;
+  default:
+    return sizeof(void *);
+  }
+}
+inline size_t numel(const mxArray *a)
+{
+  size_t n = 1;
+  for (auto d : a->dims)
+    n *= d;
+  return n;
+}
+inline int &lock_count()
+{
+  static int n = 0;
+  return n;
+}
+inline void (*&at_exit())(void)
+{
+  static void (*fcn)(void) = nullptr;
+  return fcn;
+}
+/** Callback used by mexCallMATLAB in the stub (nlhs, plhs, nrhs, prhs, name) */
+typedef int (*call_matlab_fcn)(int, mxArray *[], int, mxArray *[], const char *);
+inline call_matlab_fcn &call_matlab()
+{
+  static call_matlab_fcn fcn = nullptr;
+  return fcn;
+}
+/** Arrays to be released when the MEX call returns */
+inline std::vector<mxArray *> &temporaries()
+{
+  static std::vector<mxArray *> arrays;
+  return arrays;
+}
+/** Exception thrown by mexErrMsgIdAndTxt in the stub */
+struct mex_error : std::runtime_error
+{
+  std::string id;
+  mex_error(const char *i, const char *m) : std::runtime_error(m), id(i) {}
+};
+} // namespace mexstub
+
+inline void *mxMalloc(size_t n) { return std::malloc(n ? n : 1); }
+inline void *mxCalloc(size_t n, size_t sz) { return std::calloc(n ? n : 1, sz ? sz : 1); }
+inline void *mxRealloc(void *p, size_t n) { return std::realloc(p, n ? n : 1); }
+inline void mxFree(void *p) { std::free(p); }
+inline void mexMakeMemoryPersistent(void *) {}
+inline void mexMakeArrayPersistent(mxArray *) {}
+inline void mexLock() { ++mexstub::lock_count(); }
+inline void mexUnlock() { --mexstub::lock_count(); }
+inline int mexIsLocked() { return mexstub::lock_count() > 0; }
+inline int mexAtExit(void (*fcn)(void))
+{
+  mexstub::at_exit() = fcn;
+  return 0;
+}
+inline int mexPrintf(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int n = std::vprintf(fmt, args);
+  va_end(args);
+  return n;
+}
+inline void mexErrMsgIdAndTxt(const char *id, const char *fmt, ...)
+{
+  char buf[1024];
+  va_list args;
+  va_start(args, fmt);
+  std::vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  throw mexstub::mex_error(id, buf);
+}
+inline void mexErrMsgTxt(const char *msg) { throw mexstub::mex_error("", msg); }
+inline void mexWarnMsgIdAndTxt(const char *id, const char *fmt, ...) {}
+
+inline mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims, mxClassID id, mxComplexity c)
+{
+  mxArray *a = new mxArray;
+  a->id = id;
+  a->complex = c == mxCOMPLEX;
+  a->dims.assign(dims, dims + ndim);
+  size_t n = mexstub::numel(a);
+  size_t es = mexstub::elsize(id);
+  if (!n)
+    return a;
+#ifdef MX_HAS_INTERLEAVED_COMPLEX
+  a->data = mxCalloc(n * (a->complex ? 2 : 1), es);
+#else
+  a->data = mxCalloc(n, es);
+  if (a->complex)
+    a->imag = mxCalloc(n, es);
+#endif
+  return a;
+}
+inline mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity c)
+{
+  mwSize dims[2] = {m, n};
+  return mxCreateNumericArray(2, dims, id, c);
+}
+inline mxArray *mxCreateUninitNumericMatrix(mwSize m, mwSize n, mxClassID id, mxComplexity c)
+{
+  return mxCreateNumericMatrix(m, n, id, c);
+}
+inline mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity c) { return mxCreateNumericMatrix(m, n, mxDOUBLE_CLASS, c); }
+inline mxArray *mxCreateDoubleScalar(double v)
+{
+  mxArray *a = mxCreateDoubleMatrix(1, 1, mxREAL);
+  *(double *)a->data = v;
+  return a;
+}
+inline mxArray *mxCreateLogicalMatrix(mwSize m, mwSize n) { return mxCreateNumericMatrix(m, n, mxLOGICAL_CLASS, mxREAL); }
+inline mxArray *mxCreateLogicalScalar(bool v)
+{
+  mxArray *a = mxCreateLogicalMatrix(1, 1);
+  *(mxLogical *)a->data = v;
+  return a;
+}
+inline mxArray *mxCreateString(const char *str)
+{
+  size_t n = std::strlen(str);
+  mxArray *a = mxCreateNumericMatrix(n ? 1 : 0, n, mxCHAR_CLASS, mxREAL);
+  for (size_t i = 0; i < n; ++i)
+    ((mxChar *)a->data)[i] = (unsigned char)str[i];
+  return a;
+}
+inline mxArray *mxCreateCellArray(mwSize ndim, const mwSize *dims)
+{
+  mxArray *a = new mxArray;
+  a->id = mxCELL_CLASS;
+  a->dims.assign(dims, dims + ndim);
+  a->cells.assign(mexstub::numel(a), nullptr);
+  return a;
+}
+inline mxArray *mxCreateCellMatrix(mwSize m, mwSize n)
+{
+  mwSize dims[2] = {m, n};
+  return mxCreateCellArray(2, dims);
+}
+inline mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfields, const char **names)
+{
+  mxArray *a = new mxArray;
+  a->id = mxSTRUCT_CLASS;
+  a->dims = {m, n};
+  a->fields.assign(names, names + nfields);
+  a->cells.assign(m * n * nfields, nullptr);
+  return a;
+}
+/** Stub-only: create an object array of the given class from scalar objects */
+inline mxArray *mxCreateStubObjectArray(const char *classname, std::vector<mxArray *> objs)
+{
+  mxArray *a = new mxArray;
+  a->id = mxOBJECT_CLASS;
+  a->dims = {1, objs.size()};
+  a->classname = classname;
+  a->objelems = objs;
+  return a;
+}
+/** Stub-only: create a scalar object of the given class with the named properties (empty) */
+inline mxArray *mxCreateStubObject(const char *classname, std::initializer_list<const char *> props)
+{
+  mxArray *a = new mxArray;
+  a->id = mxOBJECT_CLASS;
+  a->dims = {1, 1};
+  a->classname = classname;
+  for (auto p : props)
+    a->properties[p] = mxCreateDoubleMatrix(0, 0, mxREAL);
+  return a;
+}
+
+inline void mxDestroyArray(mxArray *a)
+{
+  if (!a)
+    return;
+  std::vector<mxArray *> &temps = mexstub::temporaries();
+  std::vector<mxArray *>::iterator it = std::find(temps.begin(), temps.end(), a);
+  if (it != temps.end())
+    temps.erase(it);
+  for (auto c : a->cells)
+    mxDestroyArray(c);
+  for (auto &p : a->properties)
+    mxDestroyArray(p.second);
+  mxFree(a->data);
+  mxFree(a->imag);
+  delete a;
+}
+inline mxArray *mxDuplicateArray(const mxArray *in)
+{
+  mxArray *a = new mxArray(*in);
+  size_t bytes = mexstub::numel(in) * mexstub::elsize(in->id);
+  if (in->data && bytes && in->id != mxCELL_CLASS && in->id != mxSTRUCT_CLASS)
+  {
+#ifdef MX_HAS_INTERLEAVED_COMPLEX
+    if (in->complex)
+      bytes *= 2;
+#endif
+    a->data = mxMalloc(bytes);
+    std::memcpy(a->data, in->data, bytes);
+  }
+  if (in->imag)
+  {
+    a->imag = mxMalloc(bytes);
+    std::memcpy(a->imag, in->imag, bytes);
+  }
+  for (auto &c : a->cells)
+    if (c)
+      c = mxDuplicateArray(c);
+  for (auto &p : a->properties)
+    p.second = mxDuplicateArray(p.second);
+  return a;
+}
+
+inline mxClassID mxGetClassID(const mxArray *a) { return a->id; }
+inline const char *mxGetClassName(const mxArray *a)
+{
+  static const char *names[] = {"unknown", "cell", "struct", "logical", "char", "void", "double", "single", "int8",
+                                "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "function_handle"};
+  return a->id == mxOBJECT_CLASS ? a->classname.c_str() : names[a->id];
+}
+inline bool mxIsClass(const mxArray *a, const char *name) { return std::strcmp(mxGetClassName(a), name) == 0; }
+inline bool mxIsChar(const mxArray *a) { return a->id == mxCHAR_CLASS; }
+inline bool mxIsCell(const mxArray *a) { return a->id == mxCELL_CLASS; }
+inline bool mxIsStruct(const mxArray *a) { return a->id == mxSTRUCT_CLASS; }
+inline bool mxIsLogical(const mxArray *a) { return a->id == mxLOGICAL_CLASS; }
+inline bool mxIsDouble(const mxArray *a) { return a->id == mxDOUBLE_CLASS; }
+inline bool mxIsSingle(const mxArray *a) { return a->id == mxSINGLE_CLASS; }
+inline bool mxIsUint64(const mxArray *a) { return a->id == mxUINT64_CLASS; }
+inline bool mxIsNumeric(const mxArray *a) { return a->id >= mxDOUBLE_CLASS && a->id <= mxUINT64_CLASS; }
+inline bool mxIsComplex(const mxArray *a) { return a->complex; }
+inline bool mxIsSparse(const mxArray *) { return false; }
+inline bool mxIsEmpty(const mxArray *a) { return mexstub::numel(a) == 0; }
+inline bool mxIsValidVariableName(const char *name) // keywords are not checked
+{
+  std::size_t n = std::strlen(name);
+  if (!n || n > 63 || !std::isalpha((unsigned char)name[0]))
+    return false;
+  for (std::size_t i = 1; i < n; ++i)
+    if (!std::isalnum((unsigned char)name[i]) && name[i] != '_')
+      return false;
+  return true;
+}
+inline bool mxIsScalar(const mxArray *a) { return mexstub::numel(a) == 1; }
+inline size_t mxGetNumberOfElements(const mxArray *a) { return mexstub::numel(a); }
+inline mwSize mxGetNumberOfDimensions(const mxArray *a) { return a->dims.size(); }
+inline const mwSize *mxGetDimensions(const mxArray *a) { return a->dims.data(); }
+inline size_t mxGetM(const mxArray *a) { return a->dims[0]; }
+inline size_t mxGetN(const mxArray *a)
+{
+  size_t n = 1;
+  for (size_t i = 1; i < a->dims.size(); ++i)
+    n *= a->dims[i];
+  return n;
+}
+inline size_t mxGetElementSize(const mxArray *a) { return mexstub::elsize(a->id); }
+inline int mxSetDimensions(mxArray *a, const mwSize *dims, mwSize ndim)
+{
+  a->dims.assign(dims, dims + ndim);
+  return 0;
+}
+inline void mxSetM(mxArray *a, mwSize m) { a->dims[0] = m; }
+inline void mxSetN(mxArray *a, mwSize n) { a->dims.resize(2), a->dims[1] = n; }
+inline void *mxGetData(const mxArray *a) { return a->data; }
+inline void mxSetData(mxArray *a, void *d) { a->data = d; }
+inline void *mxGetImagData(const mxArray *a) { return a->imag; }
+inline double *mxGetPr(const mxArray *a) { return (double *)a->data; }
+inline mxChar *mxGetChars(const mxArray *a) { return (mxChar *)a->data; }
+inline mxLogical *mxGetLogicals(const mxArray *a) { return (mxLogical *)a->data; }
+inline double mxGetScalar(const mxArray *a)
+{
+  if (!a->data || mexstub::numel(a) == 0)
+    return 0.0;
+  switch (a->id)
+  {
+  case mxDOUBLE_CLASS: return *(double *)a->data;
+  case mxSINGLE_CLASS: return *(float *)a->data;
+  case mxLOGICAL_CLASS: return *(mxLogical *)a->data;
+  case mxCHAR_CLASS: return *(mxChar *)a->data;
+  case mxINT8_CLASS: return *(int8_t *)a->data;
+  case mxUINT8_CLASS: return *(uint8_t *)a->data;
+  case mxINT16_CLASS: return *(int16_t *)a->data;
+  case mxUINT16_CLASS: return *(uint16_t *)a->data;
+  case mxINT32_CLASS: return *(int32_t *)a->data;
+  case mxUINT32_CLASS: return *(uint32_t *)a->data;
+  case mxINT64_CLASS: return (double)*(int64_t *)a->data;
+  case mxUINT64_CLASS: return (double)*(uint64_t *)a->data;
+  default: return 0.0;
+  }
+}
+inline int mxGetString(const mxArray *a, char *buf, mwSize buflen)
+{
+  if (a->id != mxCHAR_CLASS || buflen == 0)
+    return 1;
+  size_t n = mexstub::numel(a);
+  size_t m = std::min<size_t>(n, buflen - 1);
+  for (size_t i = 0; i < m; ++i)
+    buf[i] = (char)((mxChar *)a->data)[i];
+  buf[m] = '\0';
+  return m < n ? 1 : 0;
+}
+inline mxArray *mxGetCell(const mxArray *a, mwIndex i) { return a->cells[i]; }
+inline void mxSetCell(mxArray *a, mwIndex i, mxArray *v)
+{
+  a->cells[i] = v;
+}
+inline int mxGetNumberOfFields(const mxArray *a) { return (int)a->fields.size(); }
+inline const char *mxGetFieldNameByNumber(const mxArray *a, int n) { return a->fields[n].c_str(); }
+inline int mxGetFieldNumber(const mxArray *a, const char *name)
+{
+  for (size_t i = 0; i < a->fields.size(); ++i)
+    if (a->fields[i] == name)
+      return (int)i;
+  return -1;
+}
+inline mxArray *mxGetFieldByNumber(const mxArray *a, mwIndex i, int n) { return a->cells[i * a->fields.size() + n]; }
+inline void mxSetFieldByNumber(mxArray *a, mwIndex i, int n, mxArray *v) { a->cells[i * a->fields.size() + n] = v; }
+inline int mxAddField(mxArray *a, const char *name)
+{
+  if (!name[0] || !isalpha((unsigned char)name[0]) || mxGetFieldNumber(a, name) >= 0)
+    return -1;
+  for (const char *c = name; *c; ++c)
+    if (!isalnum((unsigned char)*c) && *c != '_')
+      return -1;
+  a->fields.push_back(name);
+  a->cells.push_back(nullptr); // scalar structs only
+  return (int)a->fields.size() - 1;
+}
+inline mxArray *mxGetField(const mxArray *a, mwIndex i, const char *name)
+{
+  int n = mxGetFieldNumber(a, name);
+  return n < 0 ? nullptr : mxGetFieldByNumber(a, i, n);
+}
+inline void mxSetField(mxArray *a, mwIndex i, const char *name, mxArray *v)
+{
+  int n = mxGetFieldNumber(a, name);
+  if (n >= 0)
+    mxSetFieldByNumber(a, i, n, v);
+}
+inline mxArray *mxGetProperty(const mxArray *a, mwIndex k, const char *name)
+{
+  if (!a->objelems.empty())
+    a = a->objelems[k];
+  auto it = a->properties.find(name);
+  if (it == a->properties.end())
+    return nullptr;
+  mxArray *value = mxDuplicateArray(it->second);
+  mexstub::temporaries().push_back(value);
+  return value;
+}
+inline void mxSetProperty(mxArray *a, mwIndex, const char *name, const mxArray *v)
+{
+  auto it = a->properties.find(name);
+  if (it != a->properties.end())
+  {
+    mxDestroyArray(it->second);
+    it->second = mxDuplicateArray(v);
+  }
+}
+inline int mexCallMATLAB(int nlhs, mxArray *plhs[], int nrhs, mxArray *prhs[], const char *name)
+{
+  if (!mexstub::call_matlab())
+    throw mexstub::mex_error("stub:mexCallMATLAB", "no MATLAB function registered");
+  return mexstub::call_matlab()(nlhs, plhs, nrhs, prhs, name);
+}
+inline mxArray *mexCallMATLABWithTrap(int nlhs, mxArray *plhs[], int nrhs, mxArray *prhs[], const char *name)
+{
+  try
+  {
+    mexCallMATLAB(nlhs, plhs, nrhs, prhs, name);
+    return nullptr;
+  }
+  catch (mexstub::mex_error &e) // returned as an MException object
+  {
+    mxArray *error = mxCreateStubObject("MException", {"identifier", "message"});
+    mxArray *id = mxCreateString(e.id.c_str()), *message = mxCreateString(e.what());
+    mxSetProperty(error, 0, "identifier", id);
+    mxSetProperty(error, 0, "message", message);
+    mxDestroyArray(id);
+    mxDestroyArray(message);
+    return error;
+  }
+}
+
+namespace mexstub
+{
+/** Release the temporaries of the MEX call (call after each mexFunction() call) */
+inline void end_call()
+{
+  std::vector<mxArray *> arrays;
+  arrays.swap(temporaries());
+  for (mxArray *a : arrays)
+    mxDestroyArray(a);
+}
+} // namespace mexstub
@@ -0,0 +1,156 @@
+/** \file mexutils_microbench.cpp
+ * Standalone microbenchmark of the mexutils hot paths (no MATLAB required)
+ *
+ * Built against the stub mex.h in this folder, which implements the MEX API on the host
+ * heap. The numbers therefore measure the mexutils code (dispatch, handle validation,
+ * string conversion, element checks, marshalling, serialization) plus the cost of the stub, not of
+ * MATLAB itself; use mexutils_benchmark.m for the end-to-end numbers.
+ *
+ *    mexutils_microbench [n]   (n: repetitions of the fast benchmarks, default 1000000)
+ */
+
+#include "mex.h"
+#include "../mexBench.h"
+#include "mexElementOps.h"
+#include "mexPropertyTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexObjectHandler<mexBench>(nlhs, plhs, nrhs, prhs);
+}
+
+namespace
+{
+/**
+ * \brief Call mexFunction() as MATLAB does, releasing the outputs and temporaries
+ */
+void call(int nlhs, std::initializer_list<const mxArray *> args)
+{
+  mxArray *plhs[4] = {NULL, NULL, NULL, NULL};
+  std::vector<const mxArray *> prhs(args);
+  mexFunction(nlhs, plhs, (int)prhs.size(), prhs.data());
+  mexstub::end_call();
+  for (int i = 0; i < nlhs; ++i)
+    mxDestroyArray(plhs[i]);
+}
+
+/**
+ * \brief Time \p reps calls of \p fcn and print the time per call (and bandwidth if \p bytes > 0)
+ */
+template <class Fcn>
+void bench(const char *name, std::size_t reps, std::size_t bytes, Fcn fcn)
+{
+  typedef std::chrono::steady_clock clock;
+
+  fcn(); // warm up
+  clock::time_point t0 = clock::now();
+  for (std::size_t k = 0; k < reps; ++k)
+    fcn();
+  double secs = std::chrono::duration<double>(clock::now() - t0).count() / reps;
+
+  if (bytes)
+    std::printf("%-32s %12.3f us %10.1f MB/s\n", name, secs * 1e6, bytes / secs / (1 << 20));
+  else
+    std::printf("%-32s %12.3f us\n", name, secs * 1e6);
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  std::size_t n = argc > 1 ? (std::size_t)std::atol(argv[1]) : 1000000;
+  std::size_t n_large = n / 1000 ? n / 1000 : 1;
+
+  try
+  {
+    mxArray *obj = mxCreateStubObject("mexBench", {"backend"});
+    call(0, {obj});
+    const mxArray *backend = obj->properties["backend"];
+
+    mxArray *noop = mxCreateString("noop");
+    mxArray *del = mxCreateString("delete");
+    mxArray *get = mxCreateString("get");
+    mxArray *set = mxCreateString("set");
+    mxArray *scalar_name = mxCreateString("Scalar");
+    mxArray *large_name = mxCreateString("Large");
+    mxArray *scalar = mxCreateDoubleScalar(1.0);
+    mxArray *large = mxCreateDoubleMatrix(1000000, 1, mxREAL); // 8 MB payload
+    std::size_t large_bytes = 8 * mxGetNumberOfElements(large);
+    mxArray *short_str = mxCreateString("VarA");
+    mxArray *long_str = mxCreateString(std::string(1000, 'a').c_str());
+
+    // object lifetime
+    bench("mexObjectHandle create/destroy", n, 0, [] {
+      mxArray *h = mexObjectHandle<int>::create(0);
+      mexObjectHandle<int>::_destroy(h);
+      mxDestroyArray(h);
+    });
+    bench("mexfcn create/delete", n / 10, 0, [&] {
+      mxArray *tmp = mxCreateStubObject("mexBench", {"backend"});
+      call(0, {tmp});
+      call(0, {tmp, del});
+      mxDestroyArray(tmp);
+    });
+
+    // call round-trip
+    bench("noop (fast path)", n, 0, [&] { call(0, {backend, obj, noop}); });
+    bench("noop (property lookup)", n, 0, [&] { call(0, {obj, noop}); });
+    bench("noop (static)", n, 0, [&] { call(0, {noop}); });
+
+    // marshalling
+    bench("get scalar", n, 0, [&] { call(1, {backend, obj, get, scalar_name}); });
+    bench("set scalar", n, 0, [&] { call(0, {backend, obj, set, scalar_name, scalar}); });
+    bench("set large", n_large, large_bytes, [&] { call(0, {backend, obj, set, large_name, large}); });
+    bench("get large", n_large, large_bytes, [&] { call(1, {backend, obj, get, large_name}); });
+
+    // string conversion
+    bench("mexGetString (4 chars)", n, 0, [&] { std::string s = mexGetString(short_str); });
+    bench("mexGetString (1000 chars)", n, 0, [&] { std::string s = mexGetString(long_str); });
+    bench("mexString<> (4 chars)", n, 0, [&] { mexString<> s(short_str); });
+
+    // element checks and conversions (vectorized, see mexElementOps.h)
+    const double *large_data = (const double *)mxGetData(large);
+    std::size_t large_numel = mxGetNumberOfElements(large);
+    std::vector<float> large_single(large_numel);
+    std::vector<int32_t> large_int32(large_numel);
+    bench("mexAllFinite (large)", n_large, large_bytes, [&] {
+      if (!mexAllFinite(large_data, large_numel))
+        std::abort();
+    });
+    bench("mexElementsFit (large, int32)", n_large, large_bytes, [&] { // the property layer's int32 check
+      *(volatile double *)mxGetData(large) = 0.0; // keep the scan in the timed loop
+      if (!mexElementsFit(large, (const int32_t *)nullptr))
+        std::abort();
+    });
+    bench("mexConvertCopy (large, single)", n_large, large_bytes, [&] { mexConvertCopy(large_data, large_numel, large_single.data()); });
+    bench("mexConvertCopy (large, int32)", n_large, large_bytes, [&] { mexConvertCopy(large_data, large_numel, large_int32.data()); });
+
+    // serialization
+    mexBench &bench_obj = mexObjectHandle<mexBench>::getObject(backend);
+    mxArray *blob = mexSerialize(bench_obj);
+    bench("save", n_large, large_bytes, [&] { mxDestroyArray(mexSerialize(bench_obj)); });
+    bench("load", n_large, large_bytes, [&] { mexDeserialize(blob, bench_obj); });
+    std::string file = "mexutils_microbench.mexobj";
+    bench("saveToFile", n_large / 10 ? n_large / 10 : 1, large_bytes, [&] { mexSerializeToFile(bench_obj, file); });
+    bench("loadFromFile", n_large / 10 ? n_large / 10 : 1, large_bytes, [&] { mexDeserializeFromFile(file, bench_obj); });
+    std::remove(file.c_str());
+
+    call(0, {obj, del});
+  }
+  catch (mexstub::mex_error &e)
+  {
+    std::fprintf(stderr, "%s: %s\n", e.id.c_str(), e.what());
+    return 1;
+  }
+  catch (std::exception &e)
+  {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
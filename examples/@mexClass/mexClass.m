@@ -21,32 +21,75 @@ classdef mexClass < mexcpp.BaseClass
       
       %% Train - an example class method call
       function varargout = train(obj, varargin)
-         [varargout{1:nargout}] = obj.mexfcn(obj, 'train', varargin{:});
+         [varargout{1:nargout}] = obj.mexfcn(obj.backend, obj, 'train', varargin{:});
+      end
+      
+      %% TrainAsync - run train job in the background
+      function token = trainAsync(obj)
+         % returns a job token immediately; use obj.wait(token) to get the score
+         token = obj.mexfcn(obj.backend, obj, 'start', 'train');
+      end
+      
+      %% Wait - wait for a background job and get its result
+      function varargout = wait(obj, token, varargin)
+         [varargout{1:nargout}] = obj.mexfcn(obj.backend, obj, 'wait', token, varargin{:});
+      end
+      
+      %% Score - an example broadcast action (obj may be an object array)
+      function s = score(obj)
+         if isscalar(obj)
+            s = obj.mexfcn(obj.backend, obj, 'score');
+         else % all the objects in one MEX call, computed in parallel
+            s = reshape(cell2mat(obj.mexfcn('broadcast', obj, 'score')), size(obj));
+         end
+      end
+      
+      %% SaveToFile/LoadFromFile - checkpoint the C++ object state to a file
+      function saveToFile(obj, filename)
+         obj.mexfcn(obj.backend, obj, 'saveToFile', filename);
+      end
+      function loadFromFile(obj, filename)
+         obj.mexfcn(obj.backend, obj, 'loadFromFile', filename);
+      end
+      
+      %% SaveDelta/LoadDelta - incremental checkpoint of the properties set since the last save
+      function delta = saveDelta(obj)
+         delta = obj.mexfcn(obj.backend, obj, 'saveDelta');
+      end
+      function loadDelta(obj, delta)
+         % apply after loading the preceding save and deltas
+         obj.mexfcn(obj.backend, obj, 'load', delta);
+      end
+      
+      %% Minimize - minimize a MATLAB function from C++ with batched calls
+      function [x, fval] = minimize(obj, fcn, x0)
+         % fcn(X) returns the 1-by-k costs of the k points given as the columns of X
+         [x, fval] = obj.mexfcn(obj.backend, obj, 'minimize', fcn, x0);
       end
       
       %% Test - another example class method call
       function varargout = test(obj, varargin)
-         [varargout{1:nargout}] = obj.mexfcn(obj, 'test', varargin{:});
+         [varargout{1:nargout}] = obj.mexfcn(obj.backend, obj, 'test', varargin{:});
       end
       
       function val = get.VarA(obj)
-         val = obj.mexfcn(obj,'get','VarA');
+         val = obj.mexfcn(obj.backend,obj,'get','VarA');
       end
       function val = get.VarB(obj)
-         val = obj.mexfcn(obj,'get','VarB');
+         val = obj.mexfcn(obj.backend,obj,'get','VarB');
       end
       function val = get.VarC(obj)
-         val = obj.mexfcn(obj,'get','VarC');
+         val = obj.mexfcn(obj.backend,obj,'get','VarC');
       end
       
       function set.VarA(obj,val)
-         obj.mexfcn(obj,'set','VarA',val);
+         obj.mexfcn(obj.backend,obj,'set','VarA',val);
       end
       function set.VarB(obj,val)
-         obj.mexfcn(obj,'set','VarB',val);
+         obj.mexfcn(obj.backend,obj,'set','VarB',val);
       end
       function set.VarC(obj,val)
-         obj.mexfcn(obj,'set','VarC',val);
+         obj.mexfcn(obj.backend,obj,'set','VarC',val);
       end
    end
    
@@ -1,8 +1,15 @@
 #include "mex.h"
 #include "mexObjectHandler.h"
+#include "mexPropertyTable.h"
+#include "mexSerializer.h"
+#include "mexFileArchive.h"
+#include "mexCowPtr.h"
 
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
 
 class mexClass;
 
@@ -12,184 +19,231 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 }
 
 // The class that we are interfacing to
-class mexClass : public mexSetGetClass
+class mexClass : public mexPropertyClass<mexClass>
 {
 public:
-  mexClass(const mxArray *mxObj, int nrhs, const mxArray *prhs[]) : VarA(1), VarB({1.0f, 2.0f, 3.0f}), VarC("StringVar")
+  mexClass(const mxArray *mxObj, int nrhs, const mxArray *prhs[]) : VarA(1), VarB(mexVector<double>({1.0, 2.0, 3.0})), VarC("StringVar")
   {}
 
   static std::string get_classname() { return "mexClass_demo"; }; // must match the Matlab classname
 
-  static bool static_handler(std::string command, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  // recycling of deleted objects: up to 8 are kept and reset() in place of the constructor
+  static const std::size_t object_pool_size = 8;
+  void reset(const mxArray *mxObj, int nrhs, const mxArray *prhs[])
   {
-    if (command=="static_fcn")
-      mexClass::static_fcn(nlhs,plhs,nrhs,prhs);
-    else
-      return false;
-    return true;
+    VarA = 1;
+    VarB.reset(mexVector<double>({1.0, 2.0, 3.0}));
+    VarC = "StringVar";
+    reset_saved_state(); // never saved, as a new object
+    save_cache.clear();
   }
 
-  virtual bool action_handler(const mxArray *mxObj, const std::string &command, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  // properties: set/get/save/load of VarA, VarB, and VarC without hand-written conversions
+  static const mexPropertyTable<mexClass> &property_table()
   {
-    // try the base class action (set, get, save, load) first, returns true if action has been performed
-    if (mexSetGetClass::action_handler(mxObj, command, nlhs, plhs, nrhs, prhs))
-      return true;
+    static const mexPropertyTable<mexClass> table({mexProp("VarA", &mexClass::VarA, [](int val) { return val >= -10 && val <= 10; },
+                                                           "VarA must be a scalar integer between -10 and 10."),
+                                                   mexProp("VarB", &mexClass::VarB, mexFiniteValues(), "VarB must not contain NaN or Inf."), // replaced, not copied even if shared with a clone
+                                                   mexProp("VarC", &mexClass::VarC)});
+    return table;
+  }
 
-    if (command == "train")
-    {
-      // validate the arguments
-      if (nlhs != 0 || nrhs != 0)
-        throw mexRuntimeError(get_classname() + ":train:invalidArguments", "Train command takes no additional input argument and produces no output argument.");
+  // static actions, dispatched in constant time by mexObjectHandler
+  static const mexStaticActionTable &static_action_table()
+  {
+    static const mexStaticActionTable table({{"static_fcn", &mexClass::static_fcn}});
+    return table;
+  }
 
-      // run the action
-      train();
-    }
-    else if (command == "test")
-    {
-      int id;
+  // object actions: the base class actions (set, get, save, load) + mexClass actions
+  static const mexActionTable<mexClass> &action_table()
+  {
+    static const mexActionTable<mexClass> table(mexSetGetClass::action_table(),
+                                                {{"train", &mexClass::train_action},
+                                                 {"test", &mexClass::test_action},
+                                                 {"minimize", &mexClass::minimize_action}});
+    return table;
+  }
 
-      // validate the arguments
-      if (nlhs != 0 || nrhs != 1)
-        throw mexRuntimeError(get_classname() + ":test:invalidArguments", "Test command takes one additional input argument and produces no output argument.");
+  // broadcast actions: score = mexfcn(obj,'score') or scores = mexfcn('broadcast',objs,'score')
+  static const mexBroadcastTable<mexClass> &broadcast_table()
+  {
+    static const mexBroadcastTable<mexClass> table({{"score", &mexClass::score_task}});
+    return table;
+  }
 
-      try
-      {
-        if (!(mxIsNumeric(prhs[0]) && mxIsScalar(prhs[0])) || mxIsComplex(prhs[0]))
-          throw 0;
-        double val = mxGetScalar(prhs[0]);
-        id = (int)val;
-        if (id != val)
-          throw 0;
-      }
-      catch (...)
-      {
-        throw mexRuntimeError(get_classname() + ":test:invalidArguments", "ID input must be an integer.");
-      }
+  mexBroadcastTask score_task(int nrhs, const mxArray *prhs[])
+  {
+    // validate the arguments (MATLAB thread)
+    if (nrhs != 0)
+      throw mexRuntimeError(get_classname() + ":score:invalidArguments", "Score command takes no additional input argument.");
+
+    // compute in parallel with the other objects (worker thread), then output (MATLAB thread)
+    auto score = std::make_shared<double>(0.0);
+    return {[this, score]() { *score = VarA * std::accumulate(VarB->begin(), VarB->end(), 0.0); },
+            [score]() { return mxCreateDoubleScalar(*score); }};
+  }
 
-      // run the action
-      test(id);
-    }
-    else
-      return false;
-    return true;
+  void train_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    // validate the arguments
+    if (nlhs != 0 || nrhs != 0)
+      throw mexRuntimeError(get_classname() + ":train:invalidArguments", "Train command takes no additional input argument and produces no output argument.");
+
+    // run the action
+    train();
   }
 
-protected:
-  void set_prop(const mxArray *mxObj, const std::string name, const mxArray *value)
+  void test_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
-    if (name == "VarA") // integer between -10 and 10
+    int id;
+
+    // validate the arguments
+    if (nlhs != 0 || nrhs != 1)
+      throw mexRuntimeError(get_classname() + ":test:invalidArguments", "Test command takes one additional input argument and produces no output argument.");
+
+    try
     {
-      try
-      {
-        if (!(mxIsNumeric(value) && mxIsScalar(value)) || mxIsComplex(value))
-          throw 0;
-        double val = mxGetScalar(value);
-        int temp = (int)val;
-        if (temp != val || temp < -10 || temp > 10)
-          throw 0;
-        VarA = temp;
-      }
-      catch (...)
-      {
-        throw mexRuntimeError(get_classname() + ":invalidPropertyValue", "VarA must be a scalar integer between -10 and 10.");
-      }
+      if (!(mxIsNumeric(prhs[0]) && mxIsScalar(prhs[0])) || mxIsComplex(prhs[0]))
+        throw 0;
+      double val = mxGetScalar(prhs[0]);
+      id = (int)val;
+      if (id != val)
+        throw 0;
     }
-    else if (name == "VarB")
+    catch (...)
     {
-      try
-      {
-        if (!mxIsDouble(value) || mxIsComplex(value))
-          throw 0;
-        if (mxIsEmpty(value))
-        {
-          VarB.clear();
-        }
-        else
-        {
-          mwSize ndims = mxGetNumberOfDimensions(value);
-          const mwSize *dims = mxGetDimensions(value);
-          if (ndims > 2 || (dims[0] > 1 && dims[1] > 1))
-            throw 0;
-          mwSize dim = dims[0] == 1 ? dims[1] : dims[0];
-          double *d_val = mxGetPr(value);
-          VarB.resize(dim);
-          std::copy_n(d_val, dim, VarB.begin());
-        }
-      }
-      catch (...)
-      {
-        throw mexRuntimeError(get_classname() + ":invalidPropertyValue", "VarB must be a vector of (real) doubles.");
-      }
+      throw mexRuntimeError(get_classname() + ":test:invalidArguments", "ID input must be an integer.");
     }
-    else if (name == "VarC")
+
+    // run the action
+    test(id);
+  }
+
+  void minimize_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    // validate the arguments
+    if (nlhs > 2 || nrhs != 2 || !mxIsDouble(prhs[1]) || mxIsComplex(prhs[1]) || mxIsEmpty(prhs[1]))
+      throw mexRuntimeError(get_classname() + ":minimize:invalidArguments", "Minimize command takes a function and an initial point and produces up to two output arguments.");
+    std::size_t d = mxGetNumberOfElements(prhs[1]);
+    std::vector<double> x(mxGetPr(prhs[1]), mxGetPr(prhs[1]) + d);
+
+    // pattern search: the 2*d candidates of an iteration are evaluated by a single MATLAB call, f = fcn(X)
+    mexMatlabCallback cost(prhs[0], {d}, {1}, 2 * d);
+    std::vector<double> points(2 * d * d), values(2 * d);
+    double fval;
+    cost.evaluate(1, {x.data()}, {&fval});
+    double step = 1.0;
+    for (int iter = 0; iter < 1000 && step > 1e-6; ++iter)
     {
-      if (mxGetM(value) != 1)
-        throw mexRuntimeError(get_classname() + ":invalidPropertyValue", "VarC does not support multi-row string.");
-      try
+      for (std::size_t k = 0; k < 2 * d; ++k)
       {
-        VarC = mexGetString(value);
+        std::copy(x.begin(), x.end(), points.begin() + k * d);
+        points[k * d + k / 2] += k % 2 ? -step : step;
       }
-      catch (...)
+      cost.evaluate(2 * d, {points.data()}, {values.data()});
+      std::size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+      if (values[best] < fval)
       {
-        throw mexRuntimeError(get_classname() + ":invalidPropertyValue", "VarC must be a character string.");
+        fval = values[best];
+        std::copy(points.begin() + best * d, points.begin() + (best + 1) * d, x.begin());
       }
+      else
+        step /= 2;
     }
-    else
-    {
-      throw mexRuntimeError(get_classname() + ":invalidPropertyName", std::string("Unknown property name:") + name);
-    }
+
+    plhs[0] = mxCreateDoubleMatrix(d, 1, mxREAL);
+    std::copy(x.begin(), x.end(), mxGetPr(plhs[0]));
+    if (nlhs > 1)
+      plhs[1] = mxCreateDoubleScalar(fval);
   }
 
-  mxArray *get_prop(const mxArray *mxObj, const std::string name)
+protected:
+  // background jobs: token = mexfcn(obj,'start','train'), then score = mexfcn(obj,'wait',token)
+  std::unique_ptr<mexAsyncJob> start_job(const mxArray *mxObj, const std::string &name, int nrhs, const mxArray *prhs[])
   {
-    mxArray *rval;
-    if (name == "VarA") // integer between -10 and 10
-    {
-      rval = mxCreateDoubleScalar((double)VarA);
-    }
-    else if (name == "VarB")
-    {
-      rval = mxCreateDoubleMatrix(VarB.size(), 1, mxREAL);
-      std::copy(VarB.begin(), VarB.end(), mxGetPr(rval));
-    }
-    else if (name == "VarC")
-    {
-      rval = mxCreateString(VarC.c_str());
-    }
-    else
-    {
-      throw mexRuntimeError(get_classname() + ":invalidPropertyName", std::string("Unknown property name:") + name);
-    }
-    return rval;
+    if (name != "train")
+      return nullptr;
+    if (nrhs != 0)
+      throw mexRuntimeError(get_classname() + ":start:invalidArguments", "Train job takes no additional input argument.");
+
+    // share what the job needs: if the object is modified while the job is running, it gets its own copy
+    mexCowPtr<mexVector<double>> data = VarB;
+    auto score = std::make_shared<double>(0.0);
+    return mexMakeAsyncJob([data, score](const std::atomic<bool> &cancelled) { *score = train(data, cancelled); },
+                           [score]() { return mxCreateDoubleScalar(*score); });
   }
 
   mxArray *save_prop(const mxArray *mxObj)
   {
-    // save as MATLAB struct (not most efficient/compact, but easiest)
-    const int nfields = 3;
-    const char *fieldnames[3] = {"A", "B", "C"};
-    mxArray *plhs = mxCreateStructMatrix(1, 1, nfields, fieldnames);
-    mxSetField(plhs, 0, "A", get_prop(mxObj, "VarA"));
-    mxSetField(plhs, 0, "B", get_prop(mxObj, "VarB"));
-    mxSetField(plhs, 0, "C", get_prop(mxObj, "VarC"));
-    return plhs;
+    // save as a compact binary blob (a single uint8 mxArray, see mexSerializer.h) instead of a property struct
+    return save_segments(false);
+  }
+
+  mxArray *save_delta_prop(const mxArray *mxObj)
+  {
+    // only the properties set since the last save (their segments are reused from the cache otherwise)
+    return save_segments(true);
   }
 
   void load_prop(const mxArray *mxObj, const mxArray *value)
   {
     // no error check as only mexClass_demo class would call save/load ops
-    set_prop(mxObj,"VarA",mxGetField(value,0,"A"));
-    set_prop(mxObj,"VarB",mxGetField(value,0,"B"));
-    set_prop(mxObj,"VarC",mxGetField(value,0,"C"));
+    save_cache.clear(); // the loaded properties count as saved, so the cached segments must go
+    if (!(mexSerialHeaderOf(value).flags & mexSerialHeader::segmented))
+    {
+      mexDeserialize(value, *this); // saved before segmented saves
+      return;
+    }
+    mexSegmentReader(value).segment("VarA", VarA).segment("VarB", VarB).segment("VarC", VarC); // a delta may lack any
+  }
+
+  void save_to_file(const mxArray *mxObj, const std::string &path)
+  {
+    // streamed to the file in chunks, no in-memory copy of the object state
+    mexSerializeToFile(*this, path, 1);
   }
 
+  void load_from_file(const mxArray *mxObj, const std::string &path)
+  {
+    // read in place from the memory-mapped file (the loadFromFile action marks the state dirty)
+    mexDeserializeFromFile(path, *this);
+  }
+
+public:
+  // fields to be saved/loaded
+  template <class Archive>
+  void serialize(Archive &ar) { ar(VarA, VarB, VarC); }
+
 private:
   // mexClass variables and functions
   int VarA;
-  std::vector<double> VarB;
+  mexCowPtr<mexVector<double>> VarB; // shared among clones until modified
   std::string VarC;
+  mexSerialCache save_cache{1}; // serialized VarA, VarB, and VarC, reused while unchanged (not copied to clones)
+
+  mxArray *save_segments(bool delta)
+  {
+    save_cache.segment("VarA", modified_generation("VarA"), is_dirty("VarA"), VarA)
+        .segment("VarB", modified_generation("VarB"), is_dirty("VarB"), VarB)
+        .segment("VarC", modified_generation("VarC"), is_dirty("VarC"), VarC);
+    return save_cache.save(delta);
+  }
 
   void train() { mexPrintf("Executing train()\n"); }
+  static double train(const mexCowPtr<mexVector<double>> &data, const std::atomic<bool> &cancelled) // no MATLAB API on worker thread
+  {
+    double score = 0.0;
+    for (int iter = 0; iter < 100 && !cancelled; ++iter)
+    {
+      for (auto x : *data)
+        score += x * x;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (iter % 25 == 24)
+        mexPostPrintf("train job: %d%% done\n", iter + 1); // printed by the MATLAB thread
+    }
+    return score;
+  }
   void test(int id) { mexPrintf("Executing test(%d)\n", id); }
   static void static_fcn(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) { mexPrintf("Executing static function\n"); }
 };
@@ -0,0 +1,36 @@
+%mexDataClass Example MATLAB class wrapper to a C++ class on the MATLAB Data API
+%   The backend (mexDataClass_mexfcn.cpp) is a C++ MEX function built on
+%   mexDataObjectHandler. Data is kept by the C++ object without a copy:
+%   setting it moves the input array into the object, and getting it shares
+%   the array with MATLAB until either side modifies it.
+classdef mexDataClass < mexcpp.BaseClass
+   properties (Dependent,NonCopyable,Transient)
+      Data
+   end
+   methods (Access = protected, Static, Hidden)
+      varargout = mexfcn(varargin)
+   end
+   methods (Static)
+      function n = count()
+         n = mexDataClass.mexfcn("count");
+      end
+   end
+   methods
+      %% Constructor - Create a new C++ class instance
+      function obj = mexDataClass(varargin)
+         obj = obj@mexcpp.BaseClass(varargin{:});
+      end
+      
+      %% Total - sum of Data, computed by the C++ object
+      function s = total(obj)
+         s = obj.mexfcn(obj.backend, obj, "total");
+      end
+      
+      function val = get.Data(obj)
+         val = obj.mexfcn(obj.backend, obj, "get");
+      end
+      function set.Data(obj,val)
+         obj.mexfcn(obj.backend, obj, "set", val);
+      end
+   end
+end
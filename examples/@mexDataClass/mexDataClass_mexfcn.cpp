@@ -0,0 +1,92 @@
+#include "mexDataObjectHandler.h"
+#include <mexAdapter.hpp> // defines the MEX entry points, only in one source file
+
+#include <numeric>
+
+// The class that we are interfacing to
+class mexDataClass
+{
+public:
+  mexDataClass(const matlab::data::Array &mxObj, matlab::mex::ArgumentList inputs)
+  {
+    if (inputs.size() > 1)
+      throw mexRuntimeError("invalidArguments", "Constructor takes up to one argument (data).");
+    if (!inputs.empty())
+      set_data(std::move(inputs[0]));
+    ++count_m;
+  }
+  mexDataClass(const mexDataClass &other) : data_m(other.data_m) { ++count_m; } // shares the data
+  ~mexDataClass() { --count_m; }
+
+  static std::string get_classname() { return "mexDataClass"; }; // must match the Matlab classname
+
+  // object actions
+  static const mexDataActionTable<mexDataClass> &action_table()
+  {
+    static const mexDataActionTable<mexDataClass> table({{"set", &mexDataClass::set_action},
+                                                          {"get", &mexDataClass::get_action},
+                                                          {"total", &mexDataClass::total_action}});
+    return table;
+  }
+
+  // static actions
+  static const mexDataStaticActionTable &static_action_table()
+  {
+    static const mexDataStaticActionTable table({{"count", &mexDataClass::count_action}});
+    return table;
+  }
+
+  bool action_handler(const matlab::data::Array &mxObj, const std::string &action, matlab::mex::ArgumentList outputs,
+                      matlab::mex::ArgumentList inputs)
+  {
+    return false; // all actions are in the table
+  }
+
+  void set_action(const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (outputs.size() != 0 || inputs.size() != 1)
+      throw mexRuntimeError("set:invalidArguments", "Set command takes one additional input argument and produces no output argument.");
+    set_data(std::move(inputs[0])); // no copy
+  }
+
+  void get_action(const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (outputs.size() > 1 || inputs.size() != 0)
+      throw mexRuntimeError("get:invalidArguments", "Get command takes no additional input argument and produces one output argument.");
+    outputs[0] = data_m; // shared with MATLAB until modified
+  }
+
+  void total_action(const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (outputs.size() > 1 || inputs.size() != 0)
+      throw mexRuntimeError("total:invalidArguments", "Total command takes no additional input argument and produces one output argument.");
+    const matlab::data::TypedArray<double> data(data_m);
+    matlab::data::ArrayFactory factory;
+    outputs[0] = factory.createScalar(std::accumulate(data.begin(), data.end(), 0.0));
+  }
+
+  static void count_action(matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (outputs.size() > 1 || inputs.size() != 0)
+      throw mexRuntimeError("count:invalidArguments", "Count command takes no additional input argument and produces one output argument.");
+    matlab::data::ArrayFactory factory;
+    outputs[0] = factory.createScalar((double)count_m);
+  }
+
+private:
+  matlab::data::TypedArray<double> data_m = matlab::data::ArrayFactory().createArray<double>({0, 0});
+  static int count_m; // number of live objects
+
+  void set_data(matlab::data::Array &&value)
+  {
+    if (value.getType() != matlab::data::ArrayType::DOUBLE)
+      throw mexRuntimeError("invalidData", "Data must be a real double array.");
+    data_m = std::move(value);
+  }
+};
+
+int mexDataClass::count_m = 0;
+
+class MexFunction : public mexDataObjectHandler<mexDataClass>
+{
+};
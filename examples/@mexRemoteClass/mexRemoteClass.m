@@ -0,0 +1,39 @@
+%mexRemoteClass Example MATLAB class wrapper to a C++ class run in a helper process
+%   The backend (mexRemoteClass_mexfcn.cpp) is a proxy that forwards every
+%   action to the C++ objects in the helper process mexRemoteClass_server,
+%   so that a crash or the memory use of the objects does not affect MATLAB.
+classdef mexRemoteClass < mexcpp.BaseClass
+   methods (Access = protected, Static, Hidden)
+      varargout = mexfcn(varargin)
+   end
+   methods (Static)
+      function id = serverPid()
+         id = mexRemoteClass.mexfcn('pid');
+      end
+      function crash()
+         % aborts the helper process: the objects fail with remote:serverDied
+         mexRemoteClass.mexfcn('crash');
+      end
+   end
+   methods
+      %% Constructor - Create a new C++ class instance in the helper process
+      function obj = mexRemoteClass(varargin)
+         obj = obj@mexcpp.BaseClass(varargin{:});
+      end
+      
+      %% Add - append the elements of a double array (returns without waiting)
+      function add(obj, x)
+         obj.mexfcn(obj.backend, obj, 'add', x);
+      end
+      
+      %% Total - scaled sum of the elements added so far
+      function s = total(obj)
+         s = obj.mexfcn(obj.backend, obj, 'total');
+      end
+      
+      %% Scaled - scaled elements added so far
+      function y = scaled(obj)
+         y = obj.mexfcn(obj.backend, obj, 'scaled');
+      end
+   end
+end
@@ -0,0 +1,23 @@
+#include "mex.h"
+#include "mexObjectHandler.h"
+#include "mexRemoteBackend.h"
+
+class mexRemoteClass;
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  mexObjectHandler<mexRemoteClass>(nlhs, plhs, nrhs, prhs);
+}
+
+// Proxy to the C++ objects in the helper process (see mexRemoteClass_server.cpp)
+class mexRemoteClass : public mexRemoteProxy<mexRemoteClass>
+{
+public:
+  using mexRemoteProxy<mexRemoteClass>::mexRemoteProxy;
+
+  static std::string get_classname() { return "mexRemoteClass"; }; // must match the Matlab classname
+  static std::string remote_server() { return mexRemoteModulePath("mexRemoteClass_server"); } // installed next to mexfcn
+
+  // add() returns nothing: MATLAB does not wait for it, its errors are reported by the next call with outputs
+  static const bool remote_post_actions = true;
+};
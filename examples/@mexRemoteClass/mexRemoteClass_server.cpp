@@ -0,0 +1,72 @@
+#define MEXUTILS_REMOTE_SERVER // no MATLAB in the helper process
+#include "mexRemoteBackend.h"
+
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+// The class that we are interfacing to, run in the helper process
+class mexRemoteClass
+{
+public:
+  mexRemoteClass(const mexRemoteArgs &args) : scale(1.0)
+  {
+    if (args.size() > 1)
+      throw mexRuntimeError("invalidArguments", "Constructor takes up to one argument (scale).");
+    if (!args.empty())
+      scale = args[0].scalar();
+  }
+
+  // object actions
+  static const mexRemoteActionTable<mexRemoteClass> &remote_action_table()
+  {
+    static const mexRemoteActionTable<mexRemoteClass> table({{"add", &mexRemoteClass::add_action},
+                                                              {"total", &mexRemoteClass::total_action},
+                                                              {"scaled", &mexRemoteClass::scaled_action}});
+    return table;
+  }
+
+  // static actions
+  static const mexRemoteStaticActionTable &remote_static_action_table()
+  {
+    static const mexRemoteStaticActionTable table({{"pid", &mexRemoteClass::pid_action},
+                                                   {"crash", &mexRemoteClass::crash_action}});
+    return table;
+  }
+
+  void add_action(mexRemoteResults &out, const mexRemoteArgs &in)
+  {
+    if (in.size() != 1 || !in[0].is<double>())
+      throw mexRuntimeError("add:invalidArguments", "Add command takes one double array.");
+    const double *x = in[0].data<double>(); // read in place from the shared-memory request
+    data.insert(data.end(), x, x + in[0].numel());
+  }
+
+  void total_action(mexRemoteResults &out, const mexRemoteArgs &in)
+  {
+    if (!in.empty())
+      throw mexRuntimeError("total:invalidArguments", "Total command takes no additional input argument.");
+    out.scalar(scale * std::accumulate(data.begin(), data.end(), 0.0));
+  }
+
+  void scaled_action(mexRemoteResults &out, const mexRemoteArgs &in)
+  {
+    if (!in.empty())
+      throw mexRuntimeError("scaled:invalidArguments", "Scaled command takes no additional input argument.");
+    double *y = out.create<double>(data.size(), 1); // written in place to the shared-memory response
+    for (std::size_t i = 0; i < data.size(); ++i)
+      y[i] = scale * data[i];
+  }
+
+  static void pid_action(mexRemoteResults &out, const mexRemoteArgs &in) { out.scalar((double)getpid()); }
+  static void crash_action(mexRemoteResults &out, const mexRemoteArgs &in) { std::abort(); } // MATLAB keeps running
+
+private:
+  double scale;
+  std::vector<double> data;
+};
+
+int main(int argc, char *argv[])
+{
+  return mexRemoteServe<mexRemoteClass>(argc, argv);
+}
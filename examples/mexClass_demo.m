@@ -15,6 +15,8 @@ end
 mexClass_demo.static_fcn()
 
 obj.train();
+token = obj.trainAsync(); % returns immediately
+score = obj.wait(token)
 try
    obj.test();
 catch ME
@@ -22,6 +24,37 @@ catch ME
    obj.test(5);
 end
 
+% the C++ optimizer calls the cost function once per iteration, with all its candidate points
+[x, fval] = obj.minimize(@(X) sum((X - [1; 2]).^2, 1), [0; 0])
+
+obj2 = copy(obj); % clones the C++ object, VarB shared until modified
+obj2.VarB = 1:5;
+disp([numel(obj.VarB) numel(obj2.VarB)])
+clear obj2
+
+obj.saveToFile('testdata.mexobj'); % streamed to the file
+obj.loadFromFile('testdata.mexobj'); % memory-mapped
+
+% a file checkpoint is not a save: later saves and deltas still include the changes before it
+B = saveobj(obj);
+obj.VarA = 5;
+obj.saveToFile('testdata.mexobj');
+B = saveobj(obj);
+obj2 = mexClass_demo;
+obj2.loadDelta(B.mexdata);
+assert(obj2.VarA == 5)
+
+B = saveobj(obj);
+obj.VarA = 4;
+obj.saveToFile('testdata.mexobj');
+delta = obj.saveDelta();
+obj2 = mexClass_demo;
+obj2.loadDelta(B.mexdata);
+obj2.loadDelta(delta);
+assert(obj2.VarA == 4)
+clear obj2
+delete testdata.mexobj
+
 save testdata obj
 clear
 load testdata
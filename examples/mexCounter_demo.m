@@ -5,7 +5,7 @@
 
 clear all
 
-% create 2 mexCounter objects. counters are uint64 scalars, each representing the address of
+% create 2 mexCounter objects. counters are uint64 scalars, each representing the handle id of
 % where the mexCounter state is stored.
 counter1 = mexCounter();
 counter2 = mexCounter();
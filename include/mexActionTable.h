@@ -0,0 +1,340 @@
+/** \file mexActionTable.h
+ * C++ header file containing constant-time action dispatch tables for mexObjectHandler
+ */
+
+#pragma once
+
+// the C API (mxArray) parts are left out for the MATLAB Data API (see mexDataObjectHandler.h) and
+// for the helper processes without MATLAB (see mexRemoteBackend.h)
+#if !defined(MEXUTILS_DATA_API) && !defined(MEXUTILS_REMOTE_SERVER)
+#include <mex.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Constant-time lookup table of named actions
+ *
+ * mexDispatchTable maps action names to function values (typically member function
+ * pointers). It is meant to be built once per class (e.g., as a function-local static)
+ * and then queried on every MEX call. The table is a perfect hash: the hash seed and
+ * table size are chosen at construction so that no two names share a bucket. A lookup
+ * is therefore a single hash of the name followed by a single name comparison.
+ *
+ * Names may be looked up directly from a MATLAB char mxArray. Its mxChar buffer is
+ * hashed and compared in place, so no std::string is created on the dispatch path.
+ * (With MEXUTILS_DATA_API, names are looked up from char16_t buffers instead.)
+ *
+ * If the same name is registered more than once, the last registration wins. This
+ * lets a derived class table override actions inherited from its base class table.
+ *
+ * \tparam Fcn Type of the function value stored per action. Must be default
+ *             constructible to a "null" value and testable in boolean context.
+ */
+template <typename Fcn>
+class mexDispatchTable
+{
+  template <typename OtherFcn>
+  friend class mexDispatchTable;
+
+public:
+  typedef Fcn function_type;
+  typedef std::pair<const char *, Fcn> entry_type;
+
+  /**
+   * \brief Build a table from a list of (name, function) pairs
+   *
+   * \param[in] actions List of action names and their functions
+   */
+  mexDispatchTable(std::initializer_list<entry_type> actions)
+  {
+    add(actions);
+    build();
+  }
+
+  /**
+   * \brief Build a table from a range of (name, function) pairs
+   *
+   * \param[in] first Iterator to the first pair (with `first` convertible to `const char *`)
+   * \param[in] last  Iterator past the last pair
+   */
+  template <typename InputIt>
+  mexDispatchTable(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+      insert(first->first, first->second);
+    build();
+  }
+
+  /**
+   * \brief Build a table extending another table
+   *
+   * All entries of \p base are copied then \p actions are added. Base entries must be
+   * implicitly convertible to Fcn (e.g., base class member function pointers to
+   * derived class member function pointers).
+   *
+   * \param[in] base    Table to inherit entries from
+   * \param[in] actions Additional (or overriding) action names and their functions
+   */
+  template <typename BaseFcn>
+  mexDispatchTable(const mexDispatchTable<BaseFcn> &base, std::initializer_list<entry_type> actions)
+  {
+    entries_m.reserve(base.entries_m.size() + actions.size());
+    for (auto &e : base.entries_m)
+      insert(e.name.c_str(), e.fcn);
+    add(actions);
+    build();
+  }
+
+#if !defined(MEXUTILS_DATA_API) && !defined(MEXUTILS_REMOTE_SERVER)
+  /**
+   * \brief Look up an action by a MATLAB char array
+   *
+   * \param[in] name mxArray containing the action name
+   * \returns the registered function or a null function if \p name is not a char
+   *          array or is not registered.
+   */
+  Fcn find(const mxArray *name) const
+  {
+    if (!name || !mxIsChar(name))
+      return Fcn();
+    return find(mxGetChars(name), mxGetNumberOfElements(name));
+  }
+#endif
+
+  /**
+   * \brief Look up an action by a C++ string
+   *
+   * \param[in] name Action name
+   * \returns the registered function or a null function if not registered
+   */
+  Fcn find(const std::string &name) const { return find(name.data(), name.size()); }
+
+  /**
+   * \brief Look up an action by a character buffer (char or mxChar)
+   *
+   * \param[in] name Pointer to the first character of the action name
+   * \param[in] len  Number of characters in the action name
+   * \returns the registered function or a null function if not registered
+   */
+  template <typename CharT>
+  Fcn find(const CharT *name, std::size_t len) const
+  {
+    uint32_t idx = slots_m[hash(seed_m, name, len) & mask_m];
+    if (!idx)
+      return Fcn();
+    const entry &e = entries_m[idx - 1];
+    return match(e.name, name, len) ? e.fcn : Fcn();
+  }
+
+  /**
+   * \brief Number of registered actions
+   */
+  std::size_t size() const { return entries_m.size(); }
+
+  /**
+   * \brief Name of the i-th registered action (in registration order)
+   */
+  const std::string &name(std::size_t i) const { return entries_m[i].name; }
+
+private:
+  struct entry
+  {
+    std::string name;
+    Fcn fcn;
+  };
+
+  std::vector<entry> entries_m;  // registered actions
+  std::vector<uint32_t> slots_m; // bucket -> entry index + 1 (0 if empty)
+  uint32_t seed_m;               // hash seed yielding a collision-free table
+  std::size_t mask_m;            // bucket count - 1 (bucket count is a power of 2)
+
+  void add(std::initializer_list<entry_type> actions)
+  {
+    for (auto &a : actions)
+      insert(a.first, a.second);
+  }
+
+  void insert(const char *name, Fcn fcn)
+  {
+    for (auto &e : entries_m)
+      if (e.name == name)
+      {
+        e.fcn = fcn;
+        return;
+      }
+    entries_m.push_back({name, fcn});
+  }
+
+  /**
+   * \brief Search for a hash seed and table size without bucket collisions
+   */
+  void build()
+  {
+    std::size_t nbuckets = 4;
+    while (nbuckets < 2 * entries_m.size())
+      nbuckets <<= 1;
+
+    for (;; nbuckets <<= 1)
+    {
+      mask_m = nbuckets - 1;
+      for (seed_m = 0; seed_m < 64; ++seed_m)
+      {
+        slots_m.assign(nbuckets, 0);
+        bool collided = false;
+        for (std::size_t i = 0; i < entries_m.size() && !collided; ++i)
+        {
+          uint32_t &slot = slots_m[hash(seed_m, entries_m[i].name.data(), entries_m[i].name.size()) & mask_m];
+          collided = slot != 0;
+          slot = (uint32_t)(i + 1);
+        }
+        if (!collided)
+          return;
+      }
+    }
+  }
+
+  /**
+   * \brief Seeded FNV-1a hash over character code units followed by a 32-bit finalizer
+   */
+  template <typename CharT>
+  static uint32_t hash(uint32_t seed, const CharT *str, std::size_t len)
+  {
+    typedef typename std::make_unsigned<CharT>::type uchar_t;
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      h ^= (uint32_t)(uchar_t)str[i];
+      h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h;
+  }
+
+  template <typename CharT>
+  static bool match(const std::string &ref, const CharT *str, std::size_t len)
+  {
+    typedef typename std::make_unsigned<CharT>::type uchar_t;
+    if (ref.size() != len)
+      return false;
+    for (std::size_t i = 0; i < len; ++i)
+      if ((uint32_t)(unsigned char)ref[i] != (uint32_t)(uchar_t)str[i])
+        return false;
+    return true;
+  }
+};
+
+#if !defined(MEXUTILS_DATA_API) && !defined(MEXUTILS_REMOTE_SERVER)
+/**
+ * \brief Dispatch table type for object actions of mexClass
+ *
+ * Action member functions share the argument list of action_handler() sans the action name:
+ *
+ *    void mexClass::my_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+ */
+template <class mexClass>
+using mexActionTable = mexDispatchTable<void (mexClass::*)(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])>;
+
+/**
+ * \brief Dispatch table type for static actions
+ *
+ * Static action functions share the argument list of static_handler() sans the action name:
+ *
+ *    static void mexClass::my_static_action(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+ */
+typedef mexDispatchTable<void (*)(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])> mexStaticActionTable;
+
+/**
+ * \brief Action split into its parallelizable C++ part and its MATLAB part
+ *
+ * compute() performs the pure C++ part of the action and may run on a worker thread
+ * (it must not call MATLAB API functions). result() is called on the MATLAB thread
+ * after compute() and returns the output of the action (or NULL if none). Either may
+ * be left empty.
+ */
+struct mexBroadcastTask
+{
+  std::function<void()> compute;
+  std::function<mxArray *()> result;
+};
+
+/**
+ * \brief Dispatch table type for broadcast actions
+ *
+ * A broadcast action function validates the arguments on the MATLAB thread and returns the
+ * task performing the action on the object:
+ *
+ *    mexBroadcastTask mexClass::my_broadcast_action(int nrhs, const mxArray *prhs[]);
+ */
+template <class mexClass>
+using mexBroadcastTable = mexDispatchTable<mexBroadcastTask (mexClass::*)(int nrhs, const mxArray *prhs[])>;
+#endif
+
+/**
+ * \brief Class of the member functions in the dispatch table type returned by a table getter
+ *
+ * void if the table does not hold member function pointers.
+ */
+template <class Table>
+struct mexDispatchTableClass
+{
+  typedef void type;
+};
+template <class R, class C, class... Args>
+struct mexDispatchTableClass<const mexDispatchTable<R (C::*)(Args...)> &>
+{
+  typedef C type;
+};
+
+/**
+ * \brief Type traits to detect the optional dispatch interface of a mexObjectHandler class
+ *
+ * mexHasActionTable only detects an `action_table()` of the actions of mexClass itself: a table
+ * inherited from a base class (e.g., mexSetGetClass::action_table()) is ignored, so that the
+ * base class actions are reached through `action_handler()` and its overrides.
+ */
+template <class mexClass, class = void>
+struct mexHasActionTable : std::false_type
+{
+};
+template <class mexClass>
+struct mexHasActionTable<mexClass, typename std::enable_if<std::is_same<typename mexDispatchTableClass<decltype(mexClass::action_table())>::type, mexClass>::value>::type>
+    : std::true_type
+{
+};
+
+template <class mexClass, class = void>
+struct mexHasStaticActionTable : std::false_type
+{
+};
+template <class mexClass>
+struct mexHasStaticActionTable<mexClass, decltype((void)mexClass::static_action_table())> : std::true_type
+{
+};
+
+template <class mexClass, class = void>
+struct mexHasStaticHandler : std::false_type
+{
+};
+template <class mexClass>
+struct mexHasStaticHandler<mexClass, decltype((void)&mexClass::static_handler)> : std::true_type
+{
+};
+
+template <class mexClass, class = void>
+struct mexHasBroadcastTable : std::false_type
+{
+};
+template <class mexClass>
+struct mexHasBroadcastTable<mexClass, decltype((void)mexClass::broadcast_table())> : std::true_type
+{
+};
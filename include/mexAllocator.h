@@ -1,13 +1,21 @@
 #pragma once
 
-// CUSTOM STL allocator using the Intel MKL memory management functions
+// CUSTOM STL allocators using the MATLAB memory management functions
 #include <memory>
 #include <mex.h>
 
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
 /**
  * \brief Allocator to use MATLAB memory manager
  *
- * A custom C++ Allocator to use MATLAB memory manager.
+ * A custom C++ Allocator to use MATLAB memory manager. All allocated memory is
+ * made persistent so that it survives across MEX calls (e.g., as a part of an
+ * object wrapped by mexObjectHandle).
  *
  * \note DO NOT USE THIS ALLOCATOR BEYOND SIMPLE DATA TYPES!!
  *       In general, the use of C-based memory management functions should
@@ -20,38 +28,209 @@
  *       library which must dynamically allocate memory but also releases the
  *       allocated memory to the user, which is under a specific memory
  * management regime (i.e., MATLAB) to avoid copying.
+ *
+ * \tparam T        Element type
+ * \tparam ZeroFill True to zero-fill allocated memory (mxCalloc). By default, memory
+ *                  is left uninitialized (mxMalloc) as containers initialize their
+ *                  elements anyway.
  */
-#include <type_traits>
-template <typename T> struct mexAllocator
+template <typename T, bool ZeroFill = false> struct mexAllocator
 {
-  template <typename U> friend struct mexAllocator;
+  template <typename U, bool Z> friend struct mexAllocator;
   using value_type = T;
   using pointer = T *;
   using propagate_on_container_copy_assignment = std::true_type;
   using propagate_on_container_move_assignment = std::true_type;
   using propagate_on_container_swap = std::true_type;
-  template <typename U> mexAllocator() {}
+  template <typename U> struct rebind
+  {
+    typedef mexAllocator<U, ZeroFill> other;
+  };
+  mexAllocator() {}
+  template <typename U> mexAllocator(const mexAllocator<U, ZeroFill> &) {}
   pointer allocate(std::size_t n)
   {
-    pointer p = NULL;
-    if (!hint)
+    pointer p = reinterpret_cast<pointer>(ZeroFill ? mxCalloc(n, sizeof(T)) : mxMalloc(n * sizeof(T)));
+    if (!p)
+      throw std::bad_alloc();
+    mexMakeMemoryPersistent(p);
+    return p;
+  }
+  /**
+   * \brief Resize a block allocated by this allocator with mxRealloc
+   *
+   * The MATLAB memory manager may grow or shrink the block in place. The first
+   * min(old_n, new_n) elements are preserved (bitwise), so this function is only
+   * suitable for trivially copyable types. Added elements are zero-filled if ZeroFill.
+   *
+   * \param[in] p     Block to be resized (may be NULL)
+   * \param[in] old_n Current number of elements in the block
+   * \param[in] new_n New number of elements
+   * \returns the resized block
+   */
+  pointer reallocate(pointer p, std::size_t old_n, std::size_t new_n)
+  {
+    if (!p)
+      return allocate(new_n);
+    pointer q = reinterpret_cast<pointer>(mxRealloc(p, new_n * sizeof(T)));
+    if (!q)
+      throw std::bad_alloc();
+    mexMakeMemoryPersistent(q); // reallocated memory may not retain persistency
+    if (ZeroFill && new_n > old_n)
+      std::memset(q + old_n, 0, (new_n - old_n) * sizeof(T));
+    return q;
+  }
+  void deallocate(pointer p, std::size_t n) { mxFree(p); }
+  template <typename U> bool operator==(mexAllocator<U, ZeroFill> const &rhs) const { return true; }
+  template <typename U> bool operator!=(mexAllocator<U, ZeroFill> const &rhs) const { return false; }
+};
+
+/**
+ * \brief Memory pool for many small allocations in persistent MATLAB memory
+ *
+ * mexPoolResource carves small blocks out of large chunks of persistent memory
+ * obtained from the MATLAB memory manager. Freed blocks are kept in per-size free
+ * lists and reused, and the chunks are only returned to MATLAB when the pool is
+ * released or destroyed. Hence, node-based containers (std::list, std::map, graphs, etc.)
+ * make a handful of MATLAB allocations instead of one per node, and their nodes do not
+ * fragment MATLAB's heap. Memory is never zero-filled.
+ *
+ * Allocations larger than max_block_size (or over-aligned) are forwarded to mxMalloc.
+ *
+ * Intended usage: a wrapped C++ class (see mexObjectHandle) owns a pool and passes it to
+ * the \ref mexPoolAllocator of its containers. Declare the pool before the containers so
+ * that it outlives them.
+ *
+ *    mexPoolResource pool;
+ *    std::map<int, double, std::less<int>, mexPoolAllocator<std::pair<const int, double>>> nodes{&pool};
+ *
+ * \note Not thread-safe. Use a pool per thread if containers are modified concurrently.
+ */
+class mexPoolResource
+{
+public:
+  static const std::size_t alignment = alignof(std::max_align_t); // block alignment & size granularity
+  static const std::size_t max_block_size = 512;                  // largest pooled block
+
+  /**
+   * \param[in] chunk_size Size of the chunks requested from MATLAB in bytes
+   */
+  explicit mexPoolResource(std::size_t chunk_size = 64 * 1024)
+      : chunk_size_m(chunk_size < max_block_size ? max_block_size : chunk_size), cur_m(NULL), end_m(NULL)
+  {
+    std::memset(free_m, 0, sizeof(free_m));
+  }
+  ~mexPoolResource() { release(); }
+
+  mexPoolResource(const mexPoolResource &) = delete;
+  mexPoolResource &operator=(const mexPoolResource &) = delete;
+
+  void *allocate(std::size_t bytes, std::size_t align = alignment)
+  {
+    if (bytes > max_block_size || align > alignment)
+      return allocate_large(bytes);
+
+    std::size_t c = size_class(bytes);
+    if (free_m[c]) // reuse freed block
     {
-      p = reinterpret_cast<pointer>(mxCalloc(n, sizeof(T)));
-      mexMakeMemoryPersistent(p);
+      void *p = free_m[c];
+      free_m[c] = *reinterpret_cast<void **>(p);
+      return p;
     }
-    else
+
+    std::size_t size = (c + 1) * alignment;
+    if ((std::size_t)(end_m - cur_m) < size)
+      new_chunk();
+    void *p = cur_m;
+    cur_m += size;
+    return p;
+  }
+
+  void deallocate(void *p, std::size_t bytes, std::size_t align = alignment)
+  {
+    if (!p)
+      return;
+    if (bytes > max_block_size || align > alignment)
     {
-      p = reinterpret_cast<pointer>(mxRealloc((void *)hint, n * sizeof(T)));
+      mxFree(p);
+      return;
     }
+    std::size_t c = size_class(bytes);
+    *reinterpret_cast<void **>(p) = free_m[c];
+    free_m[c] = p;
+  }
+
+  /**
+   * \brief Return all chunks to MATLAB
+   *
+   * All blocks allocated from the pool (except the large ones) become invalid.
+   */
+  void release()
+  {
+    for (auto chunk : chunks_m)
+      mxFree(chunk);
+    chunks_m.clear();
+    std::memset(free_m, 0, sizeof(free_m));
+    cur_m = end_m = NULL;
+  }
+
+  /**
+   * \brief Total size of the chunks held by the pool in bytes
+   */
+  std::size_t capacity() const { return chunks_m.size() * chunk_size_m; }
+
+private:
+  static const std::size_t num_classes = max_block_size / alignment;
+
+  std::size_t chunk_size_m;    // size of a chunk
+  std::vector<void *> chunks_m; // chunks obtained from MATLAB
+  void *free_m[num_classes];   // free list head per size class
+  char *cur_m;                 // next unused byte in the current chunk
+  char *end_m;                 // end of the current chunk
+
+  static std::size_t size_class(std::size_t bytes) { return bytes ? (bytes - 1) / alignment : 0; }
+
+  void new_chunk()
+  {
+    chunks_m.reserve(chunks_m.size() + 1); // so push_back cannot throw after allocation
+    char *chunk = static_cast<char *>(allocate_large(chunk_size_m));
+    chunks_m.push_back(chunk);
+    cur_m = chunk;
+    end_m = chunk + chunk_size_m;
+  }
+
+  static void *allocate_large(std::size_t bytes)
+  {
+    void *p = mxMalloc(bytes);
+    if (!p)
+      throw std::bad_alloc();
+    mexMakeMemoryPersistent(p);
     return p;
   }
-  void deallocate(pointer p, std::size_t n) { mxFree(p); }
-  // template <typename U> bool operator==(ArenaAllocator<U> const &rhs) const
-  // {
-  //   return arena == rhs.arena;
-  // }
-  // template <typename U> bool operator!=(ArenaAllocator<U> const &rhs) const
-  // {
-  //   return arena != rhs.arena;
-  // }
+};
+
+/**
+ * \brief Allocator drawing from a mexPoolResource
+ *
+ * A stateful allocator referring to a \ref mexPoolResource. Suitable for node-based
+ * containers of any element type. Two allocators compare equal if they share the pool.
+ */
+template <typename T> struct mexPoolAllocator
+{
+  template <typename U> friend struct mexPoolAllocator;
+  using value_type = T;
+  using pointer = T *;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  mexPoolAllocator(mexPoolResource *pool) : pool_m(pool) {}
+  template <typename U> mexPoolAllocator(const mexPoolAllocator<U> &other) : pool_m(other.pool_m) {}
+  pointer allocate(std::size_t n) { return static_cast<pointer>(pool_m->allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(pointer p, std::size_t n) { pool_m->deallocate(p, n * sizeof(T), alignof(T)); }
+  mexPoolResource *resource() const { return pool_m; }
+  template <typename U> bool operator==(mexPoolAllocator<U> const &rhs) const { return pool_m == rhs.pool_m; }
+  template <typename U> bool operator!=(mexPoolAllocator<U> const &rhs) const { return pool_m != rhs.pool_m; }
+
+private:
+  mexPoolResource *pool_m;
 };
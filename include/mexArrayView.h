@@ -0,0 +1,220 @@
+/** \file mexArrayView.h
+ * C++ header file containing typed non-owning views of numeric mxArrays
+ */
+
+#pragma once
+
+#include "mexClassId.h"      // mxClassID of element type
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+
+#include <mex.h>
+
+#include <complex>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+
+/**
+ * \brief MATLAB storage traits of a C++ element type
+ *
+ * class_id is the MATLAB class of the element and is_complex indicates std::complex<>
+ * elements. Complex elements are only supported with the interleaved complex API
+ * (MX_HAS_INTERLEAVED_COMPLEX), in which MATLAB stores complex data as std::complex<T>.
+ */
+template <typename T>
+struct mexElementTraits
+{
+  static const mxClassID class_id = mexClassId<T>::value;
+  static const bool is_complex = false;
+};
+template <typename T>
+struct mexElementTraits<const T> : mexElementTraits<T>
+{
+};
+template <typename T>
+struct mexElementTraits<std::complex<T>>
+{
+  static const mxClassID class_id = mexClassId<T>::value;
+  static const bool is_complex = true;
+};
+
+/**
+ * \brief Typed data pointer of an mxArray
+ *
+ * mexTypedData<T>::get(array) returns the data of \p array as T elements. With the
+ * interleaved complex API (MX_HAS_INTERLEAVED_COMPLEX), it calls the matching typed
+ * accessor (mxGetDoubles(), mxGetComplexDoubles(), etc.), so complex data is accessed in
+ * place as std::complex<T> without splitting it into separate real and imaginary arrays.
+ * Otherwise (and for mxLogical and mxChar), it casts mxGetData(). The array must match T.
+ */
+template <typename T>
+struct mexTypedData
+{
+  static T *get(const mxArray *array) { return static_cast<T *>(mxGetData(array)); }
+};
+template <typename T>
+struct mexTypedData<const T>
+{
+  static const T *get(const mxArray *array) { return mexTypedData<T>::get(array); }
+};
+
+#ifdef MX_HAS_INTERLEAVED_COMPLEX
+#define MEXTYPEDDATA_SPECIALIZATION(TYPE, FCN)                                              \
+  template <>                                                                               \
+  struct mexTypedData<TYPE>                                                                 \
+  {                                                                                         \
+    static TYPE *get(const mxArray *array) { return reinterpret_cast<TYPE *>(FCN(array)); } \
+  };
+
+MEXTYPEDDATA_SPECIALIZATION(double, mxGetDoubles)
+MEXTYPEDDATA_SPECIALIZATION(float, mxGetSingles)
+MEXTYPEDDATA_SPECIALIZATION(int8_t, mxGetInt8s)
+MEXTYPEDDATA_SPECIALIZATION(uint8_t, mxGetUint8s)
+MEXTYPEDDATA_SPECIALIZATION(int16_t, mxGetInt16s)
+MEXTYPEDDATA_SPECIALIZATION(uint16_t, mxGetUint16s)
+MEXTYPEDDATA_SPECIALIZATION(int32_t, mxGetInt32s)
+MEXTYPEDDATA_SPECIALIZATION(uint32_t, mxGetUint32s)
+MEXTYPEDDATA_SPECIALIZATION(int64_t, mxGetInt64s)
+MEXTYPEDDATA_SPECIALIZATION(uint64_t, mxGetUint64s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<double>, mxGetComplexDoubles)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<float>, mxGetComplexSingles)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<int8_t>, mxGetComplexInt8s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<uint8_t>, mxGetComplexUint8s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<int16_t>, mxGetComplexInt16s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<uint16_t>, mxGetComplexUint16s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<int32_t>, mxGetComplexInt32s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<uint32_t>, mxGetComplexUint32s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<int64_t>, mxGetComplexInt64s)
+MEXTYPEDDATA_SPECIALIZATION(std::complex<uint64_t>, mxGetComplexUint64s)
+
+#undef MEXTYPEDDATA_SPECIALIZATION
+#endif
+
+/**
+ * \brief Typed non-owning view of a numeric, logical, or char mxArray
+ *
+ * mexArrayView gives typed access to the data of an mxArray in place, i.e., without copying
+ * it to a C++ container. The element type T fixes the expected MATLAB class at compile time,
+ * and the constructor checks the given mxArray against it (class, complexity, and not sparse)
+ * once. Afterwards, the element access is a plain pointer access.
+ *
+ * Use a const element type for read-only views of input arguments:
+ *
+ *    mexArrayView<const double> x(prhs[0]); // throws if prhs[0] is not a real full double array
+ *    double sum = std::accumulate(x.begin(), x.end(), 0.0);
+ *
+ * A mutable view (non-const T) requires a non-const mxArray (e.g., a newly created output).
+ *
+ * Elements are in MATLAB's column-major order. stride(k) returns the linear distance between
+ * consecutive elements along dimension k.
+ *
+ * The view is valid only as long as the viewed mxArray is alive and unmodified.
+ *
+ * \tparam T Element type (possibly const): double, float, intN_t, uintN_t, mxLogical, mxChar,
+ *           or std::complex<> of a numeric type (interleaved complex API only).
+ */
+template <typename T>
+class mexArrayView
+{
+  typedef mexElementTraits<T> traits;
+
+public:
+  typedef T element_type;
+  typedef typename std::remove_const<T>::type value_type;
+  typedef T *iterator;
+  typedef std::size_t size_type;
+
+  /**
+   * \brief Construct a read-only view (T must be const)
+   *
+   * \throws mexRuntimeError if \p array does not match the element type
+   */
+  explicit mexArrayView(const mxArray *array)
+  {
+    static_assert(std::is_const<T>::value, "Use a const element type to view a const mxArray.");
+    init(array);
+  }
+
+  /**
+   * \brief Construct a view
+   *
+   * \throws mexRuntimeError if \p array does not match the element type
+   */
+  explicit mexArrayView(mxArray *array) { init(array); }
+
+  /**
+   * \brief Check if mxArray can be viewed with this element type
+   */
+  static bool is_compatible(const mxArray *array)
+  {
+    return array && mxGetClassID(array) == traits::class_id && mxIsComplex(array) == traits::is_complex &&
+           !mxIsSparse(array);
+  }
+
+  T *data() const { return data_m; }
+  size_type size() const { return numel_m; }
+  bool empty() const { return numel_m == 0; }
+  bool is_scalar() const { return numel_m == 1; }
+  bool is_vector() const { return ndims_m == 2 && (dims_m[0] == 1 || dims_m[1] == 1); }
+
+  mwSize ndims() const { return ndims_m; }
+  const mwSize *dims() const { return dims_m; }
+  mwSize dim(mwSize k) const { return k < ndims_m ? dims_m[k] : 1; } // trailing singleton dimensions
+  mwSize rows() const { return dims_m[0]; }
+  mwSize cols() const { return numel_m / (dims_m[0] ? dims_m[0] : 1); }
+
+  /**
+   * \brief Linear distance between consecutive elements along dimension k
+   */
+  size_type stride(mwSize k) const
+  {
+    size_type s = 1;
+    for (mwSize i = 0; i < k && i < ndims_m; ++i)
+      s *= dims_m[i];
+    return s;
+  }
+
+  iterator begin() const { return data_m; }
+  iterator end() const { return data_m + numel_m; }
+
+  T &operator[](size_type i) const { return data_m[i]; }
+  T &operator()(mwIndex i) const { return data_m[i]; }
+  T &operator()(mwIndex i, mwIndex j) const { return data_m[i + dims_m[0] * j]; }
+  T &operator()(mwIndex i, mwIndex j, mwIndex k) const { return data_m[i + dims_m[0] * (j + dim(1) * k)]; }
+
+  /**
+   * \brief Access element by N-D subscripts (zero-based)
+   */
+  T &at(std::initializer_list<mwIndex> subs) const
+  {
+    size_type idx = 0, s = 1;
+    mwSize k = 0;
+    for (auto i : subs)
+    {
+      idx += i * s;
+      s *= dim(k++);
+    }
+    return data_m[idx];
+  }
+
+private:
+  T *data_m;
+  size_type numel_m;
+  mwSize ndims_m;
+  const mwSize *dims_m;
+
+  void init(const mxArray *array)
+  {
+#ifndef MX_HAS_INTERLEAVED_COMPLEX
+    static_assert(!traits::is_complex, "Complex views require the interleaved complex API (MX_HAS_INTERLEAVED_COMPLEX).");
+#endif
+    if (!is_compatible(array))
+      throw mexRuntimeError("invalidArrayType", std::string("Array must be a ") +
+                                                    (traits::is_complex ? "complex " : "real ") +
+                                                    mexClassIdName(traits::class_id) + " full array.");
+    data_m = mexTypedData<T>::get(array);
+    numel_m = mxGetNumberOfElements(array);
+    ndims_m = mxGetNumberOfDimensions(array);
+    dims_m = mxGetDimensions(array);
+  }
+};
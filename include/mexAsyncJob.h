@@ -0,0 +1,349 @@
+/** \file mexAsyncJob.h
+ * C++ header file containing the background job support of mexSetGetClass
+ */
+
+#pragma once
+
+#include "mexMatlabQueue.h"  // to run deferred MATLAB API calls while waiting
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+#include "mexThreadPool.h"   // to run the jobs on the module's worker threads
+
+#include <mex.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * \brief Unit of C++ work to run in the background
+ *
+ * A job is split into two parts so that MATLAB API is only used from the MATLAB thread:
+ *
+ * * run() performs the C++ work on a worker thread. It must NOT call any mx or mex
+ *   function. It should check \p cancelled periodically and return early once set.
+ *   An exception thrown from run() fails the job with its message.
+ * * result() marshals the outcome to an mxArray. It is called on the MATLAB thread
+ *   once run() has completed successfully.
+ *
+ * The job object is destroyed on the MATLAB thread after its result is collected or
+ * it is cancelled.
+ */
+class mexAsyncJob
+{
+public:
+  virtual ~mexAsyncJob() {}
+
+  /**
+   * \brief Perform the work (worker thread)
+   *
+   * \param[in] cancelled Set when the job is requested to be cancelled
+   */
+  virtual void run(const std::atomic<bool> &cancelled) = 0;
+
+  /**
+   * \brief Convert the outcome of run() to an mxArray (MATLAB thread)
+   *
+   * \returns the result or NULL if the job produces none
+   */
+  virtual mxArray *result() { return NULL; }
+};
+
+/**
+ * \brief mexAsyncJob defined by a pair of function objects
+ *
+ * See mexMakeAsyncJob().
+ */
+template <class Work, class Result>
+class mexFunctionJob : public mexAsyncJob
+{
+public:
+  mexFunctionJob(Work work, Result result) : work_m(std::move(work)), result_m(std::move(result)) {}
+  void run(const std::atomic<bool> &cancelled) { work_m(cancelled); }
+  mxArray *result() { return result_m(); }
+
+private:
+  Work work_m;
+  Result result_m;
+};
+
+/**
+ * \brief Create a job from a pair of function objects
+ *
+ *    auto job = mexMakeAsyncJob([this](const std::atomic<bool> &cancelled) { train(cancelled); },
+ *                               [this]() { return mxCreateDoubleScalar(score); });
+ *
+ * \param[in] work   Callable as `void(const std::atomic<bool> &cancelled)`, run on a worker thread
+ * \param[in] result Callable as `mxArray *()`, run on the MATLAB thread
+ */
+template <class Work, class Result>
+std::unique_ptr<mexAsyncJob> mexMakeAsyncJob(Work work, Result result)
+{
+  return std::unique_ptr<mexAsyncJob>(new mexFunctionJob<Work, Result>(std::move(work), std::move(result)));
+}
+
+/**
+ * \brief Table of background jobs of an object
+ *
+ * mexJobTable runs the jobs on the module's \ref mexThreadPool and identifies each by a
+ * uint64 token given to MATLAB. The table itself is only accessed from the MATLAB thread;
+ * workers only update the state of their own jobs. Note that a running job occupies a
+ * worker thread until it returns.
+ *
+ * The destructor cancels all outstanding jobs and waits for them. An object owning a
+ * table whose jobs access the object must call cancel_all() before any data used by the
+ * jobs is destroyed (mexSetGetClass::cancel_jobs() is called by mexObjectHandle before
+ * destruction for this reason).
+ */
+class mexJobTable
+{
+public:
+  enum status
+  {
+    running,   // job is still running
+    done,      // job completed successfully
+    failed,    // job threw an exception
+    cancelled, // job returned after cancellation was requested
+  };
+
+  mexJobTable() : next_m(1) {}
+  ~mexJobTable() { cancel_all(); }
+
+  mexJobTable(const mexJobTable &) = delete;
+  mexJobTable &operator=(const mexJobTable &) = delete;
+
+  /**
+   * \brief Queue a job on the thread pool
+   *
+   * \returns the token of the job
+   */
+  uint64_t start(std::unique_ptr<mexAsyncJob> job)
+  {
+    uint64_t token = next_m++;
+    auto it = jobs_m.emplace(token, std::make_shared<entry>(std::move(job))).first;
+    entry *ptr = it->second.get();
+    try
+    {
+      mexThreadPool::instance().submit([this, ptr]() { execute(*ptr); });
+    }
+    catch (...)
+    {
+      jobs_m.erase(it);
+      throw;
+    }
+    return token;
+  }
+
+  /**
+   * \brief Current status of a job
+   *
+   * \throws mexRuntimeError if token is invalid
+   */
+  status poll(uint64_t token) const
+  {
+    entry &e = get(token);
+    std::lock_guard<std::mutex> lock(mutex_m);
+    return e.state;
+  }
+
+  /**
+   * \brief Wait for a job to finish
+   *
+   * While waiting, the operations deferred to the MATLAB thread (see mexMatlabQueue) are
+   * run periodically, so the job may print progress or wait on mexPostCall().
+   *
+   * The deferred operations may call back into the MEX function and collect or cancel the
+   * job meanwhile; the job is then waited for as usual.
+   *
+   * \param[in] token   Job token
+   * \param[in] timeout Maximum wait in seconds (negative to wait indefinitely)
+   * \returns true if the job has finished
+   * \throws mexRuntimeError if token is invalid
+   */
+  bool wait(uint64_t token, double timeout = -1.0)
+  {
+    std::shared_ptr<entry> e = find(token); // kept alive even if removed from the table meanwhile
+    return wait(*e, timeout);
+  }
+
+  /**
+   * \brief Collect the result of a finished job and remove it from the table
+   *
+   * Blocks until the job finishes. The job is removed from the table first, so its token is
+   * invalid for the calls made by the deferred operations run while waiting.
+   *
+   * \returns the result of the job (may be NULL)
+   * \throws mexRuntimeError if token is invalid, or the job failed or was cancelled
+   */
+  mxArray *collect(uint64_t token)
+  {
+    std::shared_ptr<entry> e = take(token);
+    wait(*e);
+
+    if (e->state == failed)
+      throw mexRuntimeError("async:jobFailed", e->error);
+    if (e->state == cancelled)
+      throw mexRuntimeError("async:jobCancelled", "Job has been cancelled.");
+    return e->job->result();
+  }
+
+  /**
+   * \brief Cancel a job and remove it from the table
+   *
+   * Blocks until the job returns from mexAsyncJob::run().
+   *
+   * \throws mexRuntimeError if token is invalid
+   */
+  void cancel(uint64_t token)
+  {
+    std::shared_ptr<entry> e = take(token);
+    e->cancel = true;
+    wait(*e);
+  }
+
+  /**
+   * \brief Cancel all jobs and wait for them
+   */
+  void cancel_all()
+  {
+    while (!jobs_m.empty()) // jobs started by the deferred operations run while waiting
+    {
+      std::map<uint64_t, std::shared_ptr<entry>> jobs;
+      jobs.swap(jobs_m);
+      for (auto &job : jobs)
+        job.second->cancel = true;
+      for (auto &job : jobs)
+        wait(*job.second);
+    }
+  }
+
+  /**
+   * \brief Number of jobs in the table (running or not collected)
+   */
+  std::size_t size() const { return jobs_m.size(); }
+
+  /**
+   * \brief Name of job status
+   */
+  static const char *status_name(status s)
+  {
+    switch (s)
+    {
+    case running:
+      return "running";
+    case done:
+      return "done";
+    case failed:
+      return "failed";
+    default:
+      return "cancelled";
+    }
+  }
+
+private:
+  struct entry
+  {
+    entry(std::unique_ptr<mexAsyncJob> j) : job(std::move(j)), cancel(false), state(running) {}
+    std::unique_ptr<mexAsyncJob> job;
+    std::atomic<bool> cancel; // cancellation request
+    status state;             // guarded by mutex_m
+    std::string error;        // error message of failed job
+  };
+
+  std::map<uint64_t, std::shared_ptr<entry>> jobs_m; // jobs by their tokens (shared with the waiting calls)
+  mutable std::mutex mutex_m;                         // guards entry::state & entry::error
+  std::condition_variable cv_m;                       // signaled when a job finishes
+  uint64_t next_m;                                    // next token
+
+  const std::shared_ptr<entry> &find(uint64_t token) const
+  {
+    auto it = jobs_m.find(token);
+    if (it == jobs_m.end())
+      throw mexRuntimeError("async:invalidJob", "Job token is invalid or the job has already been collected.");
+    return it->second;
+  }
+  entry &get(uint64_t token) const { return *find(token); }
+
+  // remove a job from the table
+  std::shared_ptr<entry> take(uint64_t token)
+  {
+    std::shared_ptr<entry> e = find(token);
+    jobs_m.erase(token);
+    return e;
+  }
+
+  // wait for a job, draining the MATLAB queue (see wait(uint64_t, double))
+  bool wait(entry &e, double timeout = -1.0)
+  {
+    typedef std::chrono::steady_clock clock;
+    const clock::duration slice = std::chrono::milliseconds(10); // drain interval
+    clock::time_point deadline = timeout < 0.0 ? clock::time_point::max() : clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(timeout));
+
+    std::unique_lock<std::mutex> lock(mutex_m);
+    auto finished = [&e]() { return e.state != running; };
+    for (;;)
+    {
+      lock.unlock();
+      mexMatlabQueue::instance().drain();
+      lock.lock();
+
+      clock::time_point now = clock::now();
+      if (finished() || now >= deadline)
+        break;
+      cv_m.wait_until(lock, deadline - now > slice ? now + slice : deadline, finished);
+    }
+    bool done = finished();
+    lock.unlock();
+    mexMatlabQueue::instance().drain(); // the job's last posts
+    return done;
+  }
+
+  // worker thread body
+  void execute(entry &e)
+  {
+    status state = done;
+    std::string error;
+    try
+    {
+      e.job->run(e.cancel);
+    }
+    catch (std::exception &ex)
+    {
+      state = failed;
+      error = ex.what();
+    }
+    catch (...)
+    {
+      state = failed;
+      error = "Job failed with unknown exception.";
+    }
+    if (e.cancel)
+      state = cancelled;
+
+    std::lock_guard<std::mutex> lock(mutex_m);
+    e.state = state;
+    e.error = std::move(error);
+    cv_m.notify_all();
+  }
+};
+
+/**
+ * \brief Type trait to check if a class owns background jobs to be cancelled before destruction
+ *
+ * True if T has `void cancel_jobs()` member function.
+ */
+template <class T, class = void>
+struct mexHasAsyncJobs : std::false_type
+{
+};
+template <class T>
+struct mexHasAsyncJobs<T, decltype((void)std::declval<T &>().cancel_jobs())> : std::true_type
+{
+};
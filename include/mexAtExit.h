@@ -0,0 +1,68 @@
+/** \file mexAtExit.h
+ * C++ header file containing the registry of exit handlers of a MEX module
+ */
+
+#pragma once
+
+#include <mex.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Exit handlers of the MEX module
+ *
+ * mexAtExit() accepts a single function per MEX module. mexExitHandlers takes it for the
+ * whole module and runs any number of registered handlers, in the reverse order of their
+ * registration, when MATLAB clears the MEX function. Use mexOnExit() rather than
+ * mexAtExit() to release module-wide resources (the thread pool and the object pools of
+ * the mexutils headers are released this way).
+ *
+ * \note All member functions must be called from the MATLAB thread.
+ */
+class mexExitHandlers
+{
+public:
+  /**
+   * \brief Exit handlers of the MEX module
+   */
+  static mexExitHandlers &instance()
+  {
+    static mexExitHandlers handlers;
+    return handlers;
+  }
+
+  /**
+   * \brief Register an exit handler
+   */
+  void add(std::function<void()> fcn) { handlers_m.push_back(std::move(fcn)); }
+
+  /**
+   * \brief Run and unregister all exit handlers (registered with mexAtExit())
+   */
+  static void run()
+  {
+    std::vector<std::function<void()>> &handlers = instance().handlers_m;
+    while (!handlers.empty())
+    {
+      std::function<void()> fcn = std::move(handlers.back());
+      handlers.pop_back();
+      fcn();
+    }
+  }
+
+private:
+  std::vector<std::function<void()>> handlers_m;
+
+  mexExitHandlers() { mexAtExit(&mexExitHandlers::run); }
+  mexExitHandlers(const mexExitHandlers &) = delete;
+  mexExitHandlers &operator=(const mexExitHandlers &) = delete;
+};
+
+/**
+ * \brief Register a function to be run when MATLAB clears the MEX function
+ *
+ * \param[in] fcn Callable as `void()`
+ */
+inline void mexOnExit(std::function<void()> fcn) { mexExitHandlers::instance().add(std::move(fcn)); }
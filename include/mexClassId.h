@@ -0,0 +1,109 @@
+/** \file mexClassId.h
+ * C++ header file mapping C++ element types to MATLAB class IDs
+ */
+
+#pragma once
+
+#include <mex.h>
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * \brief Compile-time MATLAB class ID of a C++ element type
+ *
+ * mexClassId<T>::value is the mxClassID of an mxArray whose elements are of type T.
+ * It is only defined for the types with a matching MATLAB numeric, logical, or char class.
+ * cv-qualifiers are ignored.
+ */
+template <typename T, typename Enable = void>
+struct mexClassId
+{
+};
+
+template <typename T>
+struct mexClassId<const T, void> : mexClassId<T>
+{
+};
+
+#define MEXCLASSID_SPECIALIZATION(TYPE, ID) \
+  template <>                               \
+  struct mexClassId<TYPE, void>             \
+  {                                         \
+    static const mxClassID value = ID;      \
+  };
+
+MEXCLASSID_SPECIALIZATION(double, mxDOUBLE_CLASS)
+MEXCLASSID_SPECIALIZATION(float, mxSINGLE_CLASS)
+MEXCLASSID_SPECIALIZATION(int8_t, mxINT8_CLASS)
+MEXCLASSID_SPECIALIZATION(uint8_t, mxUINT8_CLASS)
+MEXCLASSID_SPECIALIZATION(int16_t, mxINT16_CLASS)
+MEXCLASSID_SPECIALIZATION(uint16_t, mxUINT16_CLASS)
+MEXCLASSID_SPECIALIZATION(int32_t, mxINT32_CLASS)
+MEXCLASSID_SPECIALIZATION(uint32_t, mxUINT32_CLASS)
+MEXCLASSID_SPECIALIZATION(int64_t, mxINT64_CLASS)
+MEXCLASSID_SPECIALIZATION(uint64_t, mxUINT64_CLASS)
+MEXCLASSID_SPECIALIZATION(mxLogical, mxLOGICAL_CLASS)
+
+#undef MEXCLASSID_SPECIALIZATION
+
+// mxChar is char16_t in recent releases but uint16_t (i.e., uint16 class) in some
+template <typename T>
+struct mexClassId<T, typename std::enable_if<std::is_same<T, mxChar>::value && !std::is_same<T, uint16_t>::value>::type>
+{
+  static const mxClassID value = mxCHAR_CLASS;
+};
+
+/**
+ * \brief Type trait to check if mexClassId<T> is defined
+ */
+template <typename T, typename = void>
+struct mexHasClassId : std::false_type
+{
+};
+template <typename T>
+struct mexHasClassId<T, decltype((void)mexClassId<T>::value)> : std::true_type
+{
+};
+
+/**
+ * \brief Name of a MATLAB class ID (for error messages)
+ */
+inline const char *mexClassIdName(mxClassID id)
+{
+  switch (id)
+  {
+  case mxCELL_CLASS:
+    return "cell";
+  case mxSTRUCT_CLASS:
+    return "struct";
+  case mxLOGICAL_CLASS:
+    return "logical";
+  case mxCHAR_CLASS:
+    return "char";
+  case mxDOUBLE_CLASS:
+    return "double";
+  case mxSINGLE_CLASS:
+    return "single";
+  case mxINT8_CLASS:
+    return "int8";
+  case mxUINT8_CLASS:
+    return "uint8";
+  case mxINT16_CLASS:
+    return "int16";
+  case mxUINT16_CLASS:
+    return "uint16";
+  case mxINT32_CLASS:
+    return "int32";
+  case mxUINT32_CLASS:
+    return "uint32";
+  case mxINT64_CLASS:
+    return "int64";
+  case mxUINT64_CLASS:
+    return "uint64";
+  case mxFUNCTION_CLASS:
+    return "function_handle";
+  default:
+    return "unknown";
+  }
+}
@@ -0,0 +1,87 @@
+/** \file mexCowPtr.h
+ * C++ header file containing the copy-on-write pointer for large members of clonable wrapped objects
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+/**
+ * \brief Copy-on-write holder of a value
+ *
+ * Copying a mexCowPtr shares the held value instead of copying it. The value is copied
+ * only when write() is called while it is shared, so cloning an object (see the `clone`
+ * action of mexObjectHandler) costs O(1) per mexCowPtr member, and each clone pays for
+ * a copy of a member only when it first modifies it:
+ *
+ *    mexCowPtr<std::vector<double>> weights;
+ *    double w = (*weights)[0];   // read: shared
+ *    weights.write()[0] = 1.0;   // write: copied first if shared with another object
+ *    weights.reset(std::move(v)); // replace: never copies
+ *
+ * \note The sharing itself is thread-safe, but write() and reset() must not be called
+ *       while another thread (e.g., a background job) reads the value of this object.
+ *
+ * \tparam T Copy-constructible value type
+ */
+template <class T>
+class mexCowPtr
+{
+public:
+  typedef T element_type;
+
+  mexCowPtr() : ptr_m(std::make_shared<T>()) {}
+  explicit mexCowPtr(T value) : ptr_m(std::make_shared<T>(std::move(value))) {}
+
+  /**
+   * \brief Read access
+   */
+  const T &get() const { return *ptr_m; }
+  const T &operator*() const { return *ptr_m; }
+  const T *operator->() const { return ptr_m.get(); }
+
+  /**
+   * \brief Write access, copying the value first if it is shared
+   */
+  T &write()
+  {
+    if (ptr_m.use_count() > 1)
+      ptr_m = std::make_shared<T>(*ptr_m);
+    return *ptr_m;
+  }
+
+  /**
+   * \brief Replace the value without copying the current one
+   */
+  void reset(T value) { ptr_m = std::make_shared<T>(std::move(value)); }
+
+  /**
+   * \brief True if no other mexCowPtr shares the value
+   */
+  bool unique() const { return ptr_m.use_count() == 1; }
+
+  /**
+   * \brief Serialize the held value (see mexSerializer.h)
+   *
+   * A value shared with other objects is not copied on loading: the data are loaded into a
+   * new value (T must be default constructible).
+   */
+  template <class Archive>
+  void serialize(Archive &ar)
+  {
+    if (Archive::loading && unique())
+      ar(*ptr_m); // load in place
+    else if (Archive::loading)
+    {
+      T value;
+      ar(value);
+      reset(std::move(value));
+    }
+    else
+      ar(const_cast<T &>(*ptr_m)); // saving archives only read
+  }
+
+private:
+  std::shared_ptr<T> ptr_m; // never null
+};
@@ -0,0 +1,500 @@
+/** \file mexDataObjectHandler.h
+ * C++ header file to wrap C++ class with MATLAB class on the MATLAB Data API (C++ MEX API)
+ */
+
+#pragma once
+
+// leave out the C API (mxArray) parts of the shared headers: the two APIs may not be mixed
+#ifndef MEXUTILS_DATA_API
+#define MEXUTILS_DATA_API
+#endif
+
+#include "mexActionTable.h"    // for constant-time action dispatch
+#include "mexHandleRegistry.h" // for validation of object handles
+#include "mexRuntimeError.h"   // for mexRuntimeError runtime exception class
+
+#include <mex.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Dispatch table type for object actions of mexClass on the Data API
+ *
+ * Action member functions share the argument list of action_handler() sans the action name:
+ *
+ *    void mexClass::my_action(const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs);
+ */
+template <class mexClass>
+using mexDataActionTable = mexDispatchTable<void (mexClass::*)(const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs,
+                                                               matlab::mex::ArgumentList inputs)>;
+
+/**
+ * \brief Dispatch table type for static actions on the Data API
+ *
+ * Static action functions share the argument list of static_handler() sans the action name:
+ *
+ *    static void mexClass::my_static_action(matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs);
+ */
+typedef mexDispatchTable<void (*)(matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)> mexDataStaticActionTable;
+
+/**
+ * \brief MATLAB engine of the running MEX function
+ *
+ * Set by mexDataObjectHandler on construction, so that the wrapped classes may call MATLAB
+ * (e.g., `mexDataEngine()->feval(u"disp", ...)`) without access to matlab::mex::Function.
+ */
+inline std::shared_ptr<matlab::engine::MATLABEngine> &mexDataEngine()
+{
+  static std::shared_ptr<matlab::engine::MATLABEngine> engine;
+  return engine;
+}
+
+/**
+ * \brief Arguments following the first \p offset arguments of a MEX argument list
+ *
+ * The returned list refers to the same arrays, i.e., no array is copied.
+ */
+inline matlab::mex::ArgumentList mexDataArgumentsFrom(matlab::mex::ArgumentList args, std::size_t offset)
+{
+  return matlab::mex::ArgumentList(args.begin() + offset, args.end(), args.size() - offset);
+}
+
+/**
+ * \brief Get the characters of an action name (char row vector or string scalar)
+ *
+ * \param[in]  array MATLAB array
+ * \param[out] name  UTF-16 characters of the name
+ * \returns false if \p array is not a char array or a (non-missing) string scalar
+ */
+inline bool mexDataGetName(const matlab::data::Array &array, std::u16string &name)
+{
+  switch (array.getType())
+  {
+  case matlab::data::ArrayType::CHAR:
+  {
+    const matlab::data::CharArray chars(array);
+    name = chars.toUTF16();
+    return true;
+  }
+  case matlab::data::ArrayType::MATLAB_STRING:
+  {
+    if (array.getNumberOfElements() != 1)
+      return false;
+    const matlab::data::StringArray strings(array);
+    const matlab::data::MATLABString str = strings[0];
+    if (!str.has_value())
+      return false;
+    name = *str;
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+/**
+ * \brief MATLAB C++ MEX function to wrap C++ class with MATLAB class (Data API)
+ *
+ * mexDataObjectHandler is the counterpart of mexObjectHandler() on the MATLAB Data API. A
+ * C++ MEX function is a class named `MexFunction` deriving from matlab::mex::Function, so
+ * the whole MEX source file is:
+ *
+ *    #include "mexDataObjectHandler.h"
+ *    #include <mexAdapter.hpp>
+ *
+ *    class MexFunction : public mexDataObjectHandler<myClass>
+ *    {
+ *    };
+ *
+ * The MATLAB signatures are those of mexObjectHandler(), including the fast path:
+ *
+ * * mexfcn(obj,varargin)                      - Create a new C++ class instance and store it as a
+ *                                               `backend` MATLAB class property.
+ * * mexfcn(obj,'delete')                      - Destruct the C++ class instance.
+ * * mexfcn(obj,'action',varargin)             - Perform an action
+ * * mexfcn(obj.backend,obj,'action',varargin) - Perform an action (fast path, no property lookup)
+ * * mexfcn('action',varargin)                 - Perform a static action
+ * * backend = mexfcn(obj,'clone')             - Copy-construct the C++ object (if copy-constructible)
+ *
+ * Action names may be char vectors or string scalars. The other reserved actions of
+ * mexObjectHandler() (batch, broadcast, background jobs, etc.) are C API only.
+ *
+ * Unlike mxArray, matlab::data::Array is reference-counted with copy-on-write: copying an
+ * array only shares its data, and the data are copied only when one of the sharing arrays is
+ * modified. The argument lists are passed to the actions as such, so large arguments reach the
+ * C++ object without a copy. An action may keep an input by moving it into a member
+ * (`data = std::move(inputs[0]);`) and return a member by assigning it to an output
+ * (`outputs[0] = data;`), which shares the data with MATLAB until either side modifies it.
+ * Also, the `backend` property is read by reference, not deep-copied as by mxGetProperty().
+ *
+ * The template class `mexClass` must provide the member functions:
+ *
+ * * static std::string get_classname();
+ * * bool action_handler(const matlab::data::Array &mxObj, const std::string &action,
+ *                       matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs);
+ * * static bool static_handler(const std::string &action, matlab::mex::ArgumentList outputs,
+ *                              matlab::mex::ArgumentList inputs);
+ *
+ * and the constructor:
+ *
+ *    constructor(const matlab::data::Array &mxObj, matlab::mex::ArgumentList inputs);
+ *
+ * where inputs are the `varargin` inputs of the create-new mexFunction call. Like for
+ * mexObjectHandler(), it may define the dispatch tables `action_table()` (of type
+ * mexDataActionTable) and `static_action_table()` (of type mexDataStaticActionTable), in which
+ * case static_handler() becomes optional.
+ *
+ * An action may call MATLAB (e.g., with `mexDataEngine()->feval()`), which may in turn call the
+ * MEX function again. As with mexObjectHandler(), `delete` of an object with an action in
+ * progress invalidates its handle at once but destructs the object only when the action returns.
+ *
+ * Errors are reported to MATLAB with the ids of mexObjectHandler() (see mexClassErrorIds).
+ * Errors raised by MATLAB itself (matlab::engine::MATLABException, e.g., from a feval() in an
+ * action) are passed on unchanged.
+ *
+ * \note The C API headers (mexObjectHandler.h, etc.) must not be included in the same MEX
+ *       function. This header defines MEXUTILS_DATA_API, which leaves the mxArray parts out of
+ *       the shared headers (mexActionTable.h).
+ */
+template <class mexClass>
+class mexDataObjectHandler : public matlab::mex::Function
+{
+public:
+  mexDataObjectHandler() : engine_m(getEngine()), class_name_m(mexClass::get_classname())
+  {
+    mexDataEngine() = engine_m;
+    prefix_m[call] = prefix_m[create] = class_name_m + ":";
+    prefix_m[object] = class_name_m + ":mex:";
+    prefix_m[statics] = class_name_m + ":mex:static:";
+  }
+
+  void operator()(matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs) override
+  {
+    scope where = call; // stage of the call, selects the error id prefix
+    try
+    {
+      if (inputs.empty())
+        throw mexRuntimeError("mex:invalidInput", "Needs at least one input argument.");
+
+      switch (inputs[0].getType())
+      {
+      case matlab::data::ArrayType::UINT64: // fast-path action: mexfcn(obj.backend, obj, 'action', varargin)
+        if (inputs.size() < 3 || !mexDataGetName(inputs[2], action_m))
+          throw mexRuntimeError("missingAction", "Third argument (action) is not a string.");
+        check_backend(inputs[1], inputs[0]);
+        where = object;
+        object_action(inputs[1], inputs[0], outputs, mexDataArgumentsFrom(inputs, 3));
+        break;
+
+      case matlab::data::ArrayType::HANDLE_OBJECT_REF:
+      case matlab::data::ArrayType::VALUE_OBJECT:
+      {
+        matlab::data::Array backend;
+        try
+        {
+          backend = engine_m->getProperty(inputs[0], u"backend");
+        }
+        catch (const matlab::engine::MATLABException &)
+        {
+          throw mexRuntimeError("unsupportedClass", "MATLAB class must have backend'' property.");
+        }
+
+        if (backend.isEmpty())
+        {
+          // no backend object, create a new
+          if (outputs.size() > 1)
+            throw mexRuntimeError("tooManyOutputArguments", "Only one argument is returned for object construction.");
+          where = create;
+          construct(inputs[0], mexDataArgumentsFrom(inputs, 1));
+        }
+        else if (inputs.size() < 2 || !mexDataGetName(inputs[1], action_m))
+        {
+          throw mexRuntimeError("missingAction", "Second argument (action) is not a string.");
+        }
+        else
+        {
+          where = object;
+          object_action(inputs[0], backend, outputs, mexDataArgumentsFrom(inputs, 2));
+        }
+        break;
+      }
+
+      default: // static action
+        where = statics;
+        if (!mexDataGetName(inputs[0], action_m))
+          throw mexRuntimeError("functionUndefined", "Static action name not given.");
+        static_action(outputs, mexDataArgumentsFrom(inputs, 1));
+      }
+    }
+    catch (const mexRuntimeError &e)
+    {
+      report(where, e.id(), e.what());
+    }
+    catch (const matlab::engine::MATLABException &)
+    {
+      throw; // reported by MATLAB with its own id
+    }
+    catch (const std::exception &e)
+    {
+      if (where == object)
+        report(call, "failedAction", e.what()); // name:failedAction, as mexClassErrorIds::report_exception()
+      else
+        report(where, "", e.what());
+    }
+  }
+
+private:
+  enum scope
+  {
+    call,    // validation of the mexFunction arguments
+    create,  // construction of the C++ object
+    object,  // object action
+    statics, // static action
+  };
+
+  std::shared_ptr<matlab::engine::MATLABEngine> engine_m;
+  matlab::data::ArrayFactory factory_m;
+  std::string class_name_m; // MATLAB class name
+  std::string prefix_m[4];  // error id prefix of each scope
+  std::u16string action_m;  // name of the current action (capacity reused over calls)
+
+  /**
+   * \brief Wrapped object, as registered in mexHandleRegistry
+   */
+  struct holder
+  {
+    std::unique_ptr<mexClass> obj;
+    unsigned busy = 0;    // number of actions in progress on obj
+    bool deleted = false; // deleted while busy: destructed when the last action returns
+  };
+
+  /**
+   * \brief Scope of an action, defers the destruction of the object to its end
+   */
+  class action_scope
+  {
+  public:
+    explicit action_scope(holder &h) : holder_m(h) { ++holder_m.busy; }
+    ~action_scope()
+    {
+      if (!--holder_m.busy && holder_m.deleted)
+        destroy(&holder_m);
+    }
+    action_scope(const action_scope &) = delete;
+    action_scope &operator=(const action_scope &) = delete;
+
+  private:
+    holder &holder_m;
+  };
+
+  /**
+   * \brief Instantiate the wrapped class and store its handle in the `backend` property
+   */
+  void construct(const matlab::data::Array &mxObj, matlab::mex::ArgumentList inputs)
+  {
+    std::unique_ptr<holder> obj(new holder);
+    obj->obj.reset(new mexClass(mxObj, inputs));
+    mexHandleRegistry &registry = mexHandleRegistry::instance();
+    uint64_t id = registry.add(obj.get(), &mexTypeTag<mexClass>::id);
+    try
+    {
+      matlab::data::Array target(mxObj); // refers to the same handle object
+      engine_m->setProperty(target, u"backend", factory_m.createScalar<uint64_t>(id));
+    }
+    catch (...)
+    {
+      registry.remove(id, &mexTypeTag<mexClass>::id);
+      throw;
+    }
+    obj.release();
+
+    // lock MEX function only after successful object creation
+    mexLock();
+  }
+
+  /**
+   * \brief Make sure the MATLAB object of a fast-path call owns the given backend
+   *
+   * Debug builds check that `mxObj.backend == backend` for every action. Release builds only
+   * check the class of `mxObj` for `delete`, which clears its backend property.
+   *
+   * \throws mexRuntimeError if mxObj is not the MATLAB object of backend
+   */
+  void check_backend(const matlab::data::Array &mxObj, const matlab::data::Array &backend)
+  {
+#ifndef NDEBUG
+    if (!is_class_object(mxObj))
+      throw mexRuntimeError("invalidBackend", "Second argument must be the MATLAB object of the given backend.");
+    matlab::data::Array owned = engine_m->getProperty(mxObj, u"backend");
+    if (owned.getType() != matlab::data::ArrayType::UINT64 || owned.getNumberOfElements() != 1 ||
+        backend.getNumberOfElements() != 1 || handle_id(owned) != handle_id(backend))
+      throw mexRuntimeError("invalidBackend", "First argument does not match the backend property of the MATLAB object.");
+#else
+    // delete clears the backend property of the MATLAB object, so it must be one
+    if (action_m == u"delete" && !is_class_object(mxObj))
+      throw mexRuntimeError("invalidBackend", "Second argument must be the MATLAB object of the given backend.");
+#endif
+  }
+
+  /**
+   * \brief Check if an array is an object of the MATLAB class
+   */
+  bool is_class_object(const matlab::data::Array &mxObj)
+  {
+    matlab::data::ArrayType type = mxObj.getType();
+    if (type != matlab::data::ArrayType::HANDLE_OBJECT_REF && type != matlab::data::ArrayType::VALUE_OBJECT)
+      return false;
+    const matlab::data::TypedArray<bool> isa =
+        engine_m->feval(u"isa", std::vector<matlab::data::Array>({mxObj, factory_m.createCharArray(class_name_m)}));
+    return isa[0];
+  }
+
+  /**
+   * \brief Run an object action (including `delete` and `clone`)
+   */
+  void object_action(const matlab::data::Array &mxObj, const matlab::data::Array &backend, matlab::mex::ArgumentList outputs,
+                     matlab::mex::ArgumentList inputs)
+  {
+    uint64_t id = handle_id(backend);
+    holder &h = get_holder(id);
+
+    if (action_m == u"delete")
+    {
+      // the handle is invalidated at once, the object is destructed once its actions return
+      mexHandleRegistry::instance().remove(id, &mexTypeTag<mexClass>::id);
+      if (h.busy)
+        h.deleted = true;
+      else
+        destroy(&h);
+
+      // clear the backend property so the stale handle is never reused
+      matlab::data::Array target(mxObj);
+      engine_m->setProperty(target, u"backend", factory_m.createArray<uint64_t>({0, 0}));
+    }
+    else
+    {
+      action_scope scope(h); // a delete during the action is deferred
+      mexClass &obj = *h.obj;
+      if (action_m == u"clone")
+        clone(std::is_copy_constructible<mexClass>(), obj, outputs, inputs);
+      else if (!from_table(mexHasActionTable<mexClass>(), obj, mxObj, outputs, inputs) &&
+               !obj.action_handler(mxObj, matlab::engine::convertUTF16StringToUTF8String(action_m), outputs, inputs))
+        throw mexRuntimeError("unknownAction", "Unknown action: " + matlab::engine::convertUTF16StringToUTF8String(action_m));
+    }
+  }
+
+  /**
+   * \brief Run a static action
+   */
+  void static_action(matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (!from_table(mexHasStaticActionTable<mexClass>(), outputs, inputs) &&
+        !from_handler(mexHasStaticHandler<mexClass>(), outputs, inputs))
+      throw mexRuntimeError("unknownFunction", "Unknown static action: " + matlab::engine::convertUTF16StringToUTF8String(action_m));
+  }
+
+  bool from_table(std::false_type, mexClass &, const matlab::data::Array &, matlab::mex::ArgumentList, matlab::mex::ArgumentList) { return false; }
+  bool from_table(std::true_type, mexClass &obj, const matlab::data::Array &mxObj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    auto fcn = mexClass::action_table().find(action_m.data(), action_m.size());
+    if (!fcn)
+      return false;
+    (obj.*fcn)(mxObj, outputs, inputs);
+    return true;
+  }
+
+  bool from_table(std::false_type, matlab::mex::ArgumentList, matlab::mex::ArgumentList) { return false; }
+  bool from_table(std::true_type, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    auto fcn = mexClass::static_action_table().find(action_m.data(), action_m.size());
+    if (!fcn)
+      return false;
+    fcn(outputs, inputs);
+    return true;
+  }
+
+  bool from_handler(std::false_type, matlab::mex::ArgumentList, matlab::mex::ArgumentList) { return false; }
+  bool from_handler(std::true_type, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    return mexClass::static_handler(matlab::engine::convertUTF16StringToUTF8String(action_m), outputs, inputs);
+  }
+
+  void clone(std::false_type, mexClass &, matlab::mex::ArgumentList, matlab::mex::ArgumentList)
+  {
+    throw mexRuntimeError("clone:notSupported", "C++ class is not copy-constructible.");
+  }
+  void clone(std::true_type, mexClass &obj, matlab::mex::ArgumentList outputs, matlab::mex::ArgumentList inputs)
+  {
+    if (outputs.size() != 1 || !inputs.empty())
+      throw mexRuntimeError("clone:invalidArguments", "Clone action takes no argument and returns the new backend.");
+    std::unique_ptr<holder> copy(new holder);
+    copy->obj.reset(new mexClass(obj));
+    outputs[0] = factory_m.createScalar<uint64_t>(mexHandleRegistry::instance().add(copy.get(), &mexTypeTag<mexClass>::id));
+    copy.release();
+    mexLock();
+  }
+
+  /**
+   * \brief Get handle id from a MATLAB array
+   *
+   * \throws mexRuntimeError if the array is not a uint64 scalar
+   */
+  static uint64_t handle_id(const matlab::data::Array &backend)
+  {
+    if (backend.getType() != matlab::data::ArrayType::UINT64 || backend.getNumberOfElements() != 1)
+      throw mexRuntimeError("invalidMexObjectHandle", "Input must be a real uint64 scalar.");
+    const matlab::data::TypedArray<uint64_t> handle(backend);
+    return handle[0];
+  }
+
+  /**
+   * \brief Get the wrapped class object of a handle id
+   *
+   * \throws mexRuntimeError if id is not a live handle of mexClass
+   */
+  static holder &get_holder(uint64_t id)
+  {
+    void *ptr = mexHandleRegistry::instance().get(id, &mexTypeTag<mexClass>::id);
+    if (!ptr)
+      throw mexRuntimeError("invalidMexObjectHandle", "Handle is either invalid, already destroyed, or not wrapping the intended C++ object.");
+    return *static_cast<holder *>(ptr);
+  }
+
+  /**
+   * \brief Destruct a wrapped object whose handle is already removed from the registry
+   */
+  static void destroy(holder *h)
+  {
+    delete h;
+    mexUnlock();
+  }
+
+  /**
+   * \brief Report an error to MATLAB with its id prefixed as by mexClassErrorIds
+   */
+  void report(scope where, const char *id, const char *message)
+  {
+    static const char *const defaults[] = {"failedCall", "failedConstruction", "failedAction", "executionFailed"};
+    if (!*id)
+      id = defaults[where];
+
+    std::string full;
+    if (std::strncmp(id, class_name_m.c_str(), class_name_m.size()) || id[class_name_m.size()] != ':') // not qualified yet
+      full = prefix_m[where];
+    full += id;
+    std::replace(full.begin(), full.end(), '.', ':');
+
+    // throws matlab::engine::MATLABException, which MATLAB reports as the error of the call
+    engine_m->feval(u"error", 0,
+                    std::vector<matlab::data::Array>({factory_m.createCharArray(full), factory_m.createCharArray("%s"),
+                                                      factory_m.createCharArray(message)}));
+  }
+};
@@ -0,0 +1,615 @@
+/** \file mexElementOps.h
+ * C++ header file containing vectorized element-wise checks and conversions of numeric arrays
+ */
+
+#pragma once
+
+#include "mexArrayView.h" // for the overloads on array views
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// instruction set, selected at compile time (define MEXUTILS_NO_SIMD for the scalar code only)
+#ifndef MEXUTILS_NO_SIMD
+#if defined(__AVX2__)
+#define MEXUTILS_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MEXUTILS_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define MEXUTILS_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/**
+ * \brief Kernels of mexElementOps.h
+ *
+ * Each public function has a scalar implementation for any element type, written so that it
+ * does not branch per element, and vectorized overloads for the common types of the
+ * instruction set selected at compile time: AVX2 (e.g., `-mavx2`, CMake option
+ * MatlabMexutils_EnableAvx2), SSE2 (any x86-64 build), or NEON (AArch64). The checks scan the
+ * array in blocks, so that a failing array is rejected without reading it to the end.
+ */
+namespace mexElementOps
+{
+static const std::size_t block = 4096; // elements checked between early exits
+
+template <typename T>
+bool all_finite(const T *x, std::size_t n, std::false_type) { return true; } // integral
+template <typename T>
+bool all_finite(const T *x, std::size_t n, std::true_type)
+{
+  for (std::size_t i = 0; i < n;)
+  {
+    bool ok = true;
+    for (std::size_t end = i + block < n ? i + block : n; i < end; ++i)
+      ok &= x[i] - x[i] == 0; // NaN for NaN and Inf
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool any_nan(const T *x, std::size_t n, std::false_type) { return false; }
+template <typename T>
+bool any_nan(const T *x, std::size_t n, std::true_type)
+{
+  for (std::size_t i = 0; i < n;)
+  {
+    bool nan = false;
+    for (std::size_t end = i + block < n ? i + block : n; i < end; ++i)
+      nan |= x[i] != x[i];
+    if (nan)
+      return true;
+  }
+  return false;
+}
+
+template <typename T>
+bool all_in_range(const T *x, std::size_t n, T lo, T hi)
+{
+  for (std::size_t i = 0; i < n;)
+  {
+    bool ok = true;
+    for (std::size_t end = i + block < n ? i + block : n; i < end; ++i)
+      ok &= (x[i] >= lo) & (x[i] <= hi); // false for NaN
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+template <typename T>
+bool all_integers(const T *x, std::size_t n, T lo, T hi)
+{
+  for (std::size_t i = 0; i < n;)
+  {
+    bool ok = true;
+    for (std::size_t end = i + block < n ? i + block : n; i < end; ++i)
+      ok &= (x[i] >= lo) & (x[i] <= hi) & (std::trunc(x[i]) == x[i]);
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+template <typename S, typename D>
+void convert(const S *src, std::size_t n, D *dst, std::false_type)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    dst[i] = static_cast<D>(src[i]);
+}
+template <typename S, typename D>
+void convert(const S *src, std::size_t n, D *dst, std::true_type) // same type
+{
+  if (n)
+    std::memcpy(dst, src, n * sizeof(S));
+}
+
+#if defined(MEXUTILS_SIMD_AVX2)
+inline bool all_finite(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m256d bad = _mm256_setzero_pd();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m256d v = _mm256_loadu_pd(x + i);
+      bad = _mm256_or_pd(bad, _mm256_cmp_pd(_mm256_sub_pd(v, v), _mm256_setzero_pd(), _CMP_NEQ_UQ));
+    }
+    if (_mm256_movemask_pd(bad))
+      return false;
+  }
+  return all_finite<double>(x + i, n - i, std::true_type());
+}
+inline bool all_finite(const float *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 8 <= n;)
+  {
+    __m256 bad = _mm256_setzero_ps();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)7; i < end; i += 8)
+    {
+      __m256 v = _mm256_loadu_ps(x + i);
+      bad = _mm256_or_ps(bad, _mm256_cmp_ps(_mm256_sub_ps(v, v), _mm256_setzero_ps(), _CMP_NEQ_UQ));
+    }
+    if (_mm256_movemask_ps(bad))
+      return false;
+  }
+  return all_finite<float>(x + i, n - i, std::true_type());
+}
+inline bool any_nan(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m256d nan = _mm256_setzero_pd();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m256d v = _mm256_loadu_pd(x + i);
+      nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+    }
+    if (_mm256_movemask_pd(nan))
+      return true;
+  }
+  return any_nan<double>(x + i, n - i, std::true_type());
+}
+inline bool any_nan(const float *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 8 <= n;)
+  {
+    __m256 nan = _mm256_setzero_ps();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)7; i < end; i += 8)
+    {
+      __m256 v = _mm256_loadu_ps(x + i);
+      nan = _mm256_or_ps(nan, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+    }
+    if (_mm256_movemask_ps(nan))
+      return true;
+  }
+  return any_nan<float>(x + i, n - i, std::true_type());
+}
+inline bool all_in_range(const double *x, std::size_t n, double lo, double hi)
+{
+  const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m256d ok = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m256d v = _mm256_loadu_pd(x + i);
+      ok = _mm256_and_pd(ok, _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ), _mm256_cmp_pd(v, vhi, _CMP_LE_OQ)));
+    }
+    if (_mm256_movemask_pd(ok) != 0xF)
+      return false;
+  }
+  return all_in_range<double>(x + i, n - i, lo, hi);
+}
+inline bool all_in_range(const float *x, std::size_t n, float lo, float hi)
+{
+  const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+  std::size_t i = 0;
+  for (; i + 8 <= n;)
+  {
+    __m256 ok = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)7; i < end; i += 8)
+    {
+      __m256 v = _mm256_loadu_ps(x + i);
+      ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LE_OQ)));
+    }
+    if (_mm256_movemask_ps(ok) != 0xFF)
+      return false;
+  }
+  return all_in_range<float>(x + i, n - i, lo, hi);
+}
+inline bool all_integers(const double *x, std::size_t n, double lo, double hi)
+{
+  const __m256d vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m256d ok = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m256d v = _mm256_loadu_pd(x + i);
+      __m256d whole = _mm256_cmp_pd(_mm256_round_pd(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), v, _CMP_EQ_OQ);
+      ok = _mm256_and_pd(ok, _mm256_and_pd(whole, _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ), _mm256_cmp_pd(v, vhi, _CMP_LE_OQ))));
+    }
+    if (_mm256_movemask_pd(ok) != 0xF)
+      return false;
+  }
+  return all_integers<double>(x + i, n - i, lo, hi);
+}
+inline bool all_integers(const float *x, std::size_t n, float lo, float hi)
+{
+  const __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+  std::size_t i = 0;
+  for (; i + 8 <= n;)
+  {
+    __m256 ok = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)7; i < end; i += 8)
+    {
+      __m256 v = _mm256_loadu_ps(x + i);
+      __m256 whole = _mm256_cmp_ps(_mm256_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), v, _CMP_EQ_OQ);
+      ok = _mm256_and_ps(ok, _mm256_and_ps(whole, _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LE_OQ))));
+    }
+    if (_mm256_movemask_ps(ok) != 0xFF)
+      return false;
+  }
+  return all_integers<float>(x + i, n - i, lo, hi);
+}
+inline void convert(const double *src, std::size_t n, float *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+  convert<double, float>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const float *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+  convert<float, double>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const double *src, std::size_t n, int32_t *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvttpd_epi32(_mm256_loadu_pd(src + i)));
+  convert<double, int32_t>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const int32_t *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(src + i))));
+  convert<int32_t, double>(src + i, n - i, dst + i, std::false_type());
+}
+#elif defined(MEXUTILS_SIMD_SSE2)
+inline bool all_finite(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    __m128d bad = _mm_setzero_pd();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      __m128d v = _mm_loadu_pd(x + i);
+      bad = _mm_or_pd(bad, _mm_cmpneq_pd(_mm_sub_pd(v, v), _mm_setzero_pd()));
+    }
+    if (_mm_movemask_pd(bad))
+      return false;
+  }
+  return all_finite<double>(x + i, n - i, std::true_type());
+}
+inline bool all_finite(const float *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m128 bad = _mm_setzero_ps();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m128 v = _mm_loadu_ps(x + i);
+      bad = _mm_or_ps(bad, _mm_cmpneq_ps(_mm_sub_ps(v, v), _mm_setzero_ps()));
+    }
+    if (_mm_movemask_ps(bad))
+      return false;
+  }
+  return all_finite<float>(x + i, n - i, std::true_type());
+}
+inline bool any_nan(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    __m128d nan = _mm_setzero_pd();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      __m128d v = _mm_loadu_pd(x + i);
+      nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+    }
+    if (_mm_movemask_pd(nan))
+      return true;
+  }
+  return any_nan<double>(x + i, n - i, std::true_type());
+}
+inline bool any_nan(const float *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m128 nan = _mm_setzero_ps();
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m128 v = _mm_loadu_ps(x + i);
+      nan = _mm_or_ps(nan, _mm_cmpunord_ps(v, v));
+    }
+    if (_mm_movemask_ps(nan))
+      return true;
+  }
+  return any_nan<float>(x + i, n - i, std::true_type());
+}
+inline bool all_in_range(const double *x, std::size_t n, double lo, double hi)
+{
+  const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    __m128d ok = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      __m128d v = _mm_loadu_pd(x + i);
+      ok = _mm_and_pd(ok, _mm_and_pd(_mm_cmpge_pd(v, vlo), _mm_cmple_pd(v, vhi)));
+    }
+    if (_mm_movemask_pd(ok) != 0x3)
+      return false;
+  }
+  return all_in_range<double>(x + i, n - i, lo, hi);
+}
+inline bool all_in_range(const float *x, std::size_t n, float lo, float hi)
+{
+  const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+  std::size_t i = 0;
+  for (; i + 4 <= n;)
+  {
+    __m128 ok = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)3; i < end; i += 4)
+    {
+      __m128 v = _mm_loadu_ps(x + i);
+      ok = _mm_and_ps(ok, _mm_and_ps(_mm_cmpge_ps(v, vlo), _mm_cmple_ps(v, vhi)));
+    }
+    if (_mm_movemask_ps(ok) != 0xF)
+      return false;
+  }
+  return all_in_range<float>(x + i, n - i, lo, hi);
+}
+inline bool all_integers(const double *x, std::size_t n, double lo, double hi)
+{
+  // the integers in [lo, hi] are those in [ceil(lo), floor(hi)] (e.g., hi = nextafter(2^31, 0) for int32)
+  lo = std::ceil(lo);
+  hi = std::floor(hi);
+  if (!(lo >= -2147483648.0 && hi <= 2147483647.0)) // SSE2 truncates to int32 only
+    return all_integers<double>(x, n, lo, hi);
+  const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    __m128d ok = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      __m128d v = _mm_loadu_pd(x + i);
+      __m128d whole = _mm_cmpeq_pd(_mm_cvtepi32_pd(_mm_cvttpd_epi32(v)), v); // out-of-range values fail the range check
+      ok = _mm_and_pd(ok, _mm_and_pd(whole, _mm_and_pd(_mm_cmpge_pd(v, vlo), _mm_cmple_pd(v, vhi))));
+    }
+    if (_mm_movemask_pd(ok) != 0x3)
+      return false;
+  }
+  return all_integers<double>(x + i, n - i, lo, hi);
+}
+inline void convert(const double *src, std::size_t n, float *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(src + i)), _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2))));
+  convert<double, float>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const float *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 v = _mm_loadu_ps(src + i);
+    _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+    _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+  convert<float, double>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const double *src, std::size_t n, int32_t *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_loadu_pd(src + i)), _mm_cvttpd_epi32(_mm_loadu_pd(src + i + 2))));
+  convert<double, int32_t>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const int32_t *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_pd(dst + i, _mm_cvtepi32_pd(v));
+    _mm_storeu_pd(dst + i + 2, _mm_cvtepi32_pd(_mm_unpackhi_epi64(v, v)));
+  }
+  convert<int32_t, double>(src + i, n - i, dst + i, std::false_type());
+}
+#elif defined(MEXUTILS_SIMD_NEON)
+inline bool all_finite(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    uint64x2_t ok = vdupq_n_u64(~0ull);
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      float64x2_t v = vld1q_f64(x + i);
+      ok = vandq_u64(ok, vceqq_f64(vsubq_f64(v, v), vdupq_n_f64(0.0)));
+    }
+    if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ull)
+      return false;
+  }
+  return all_finite<double>(x + i, n - i, std::true_type());
+}
+inline bool any_nan(const double *x, std::size_t n, std::true_type)
+{
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    uint64x2_t ok = vdupq_n_u64(~0ull);
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      float64x2_t v = vld1q_f64(x + i);
+      ok = vandq_u64(ok, vceqq_f64(v, v));
+    }
+    if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ull)
+      return true;
+  }
+  return any_nan<double>(x + i, n - i, std::true_type());
+}
+inline bool all_in_range(const double *x, std::size_t n, double lo, double hi)
+{
+  const float64x2_t vlo = vdupq_n_f64(lo), vhi = vdupq_n_f64(hi);
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    uint64x2_t ok = vdupq_n_u64(~0ull);
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      float64x2_t v = vld1q_f64(x + i);
+      ok = vandq_u64(ok, vandq_u64(vcgeq_f64(v, vlo), vcleq_f64(v, vhi)));
+    }
+    if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ull)
+      return false;
+  }
+  return all_in_range<double>(x + i, n - i, lo, hi);
+}
+inline bool all_integers(const double *x, std::size_t n, double lo, double hi)
+{
+  const float64x2_t vlo = vdupq_n_f64(lo), vhi = vdupq_n_f64(hi);
+  std::size_t i = 0;
+  for (; i + 2 <= n;)
+  {
+    uint64x2_t ok = vdupq_n_u64(~0ull);
+    for (std::size_t end = i + block <= n ? i + block : n & ~(std::size_t)1; i < end; i += 2)
+    {
+      float64x2_t v = vld1q_f64(x + i);
+      ok = vandq_u64(ok, vandq_u64(vceqq_f64(vrndq_f64(v), v), vandq_u64(vcgeq_f64(v, vlo), vcleq_f64(v, vhi))));
+    }
+    if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ull)
+      return false;
+  }
+  return all_integers<double>(x + i, n - i, lo, hi);
+}
+inline void convert(const double *src, std::size_t n, float *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_f32(dst + i, vcombine_f32(vcvt_f32_f64(vld1q_f64(src + i)), vcvt_f32_f64(vld1q_f64(src + i + 2))));
+  convert<double, float>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const float *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    float32x4_t v = vld1q_f32(src + i);
+    vst1q_f64(dst + i, vcvt_f64_f32(vget_low_f32(v)));
+    vst1q_f64(dst + i + 2, vcvt_high_f64_f32(v));
+  }
+  convert<float, double>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const double *src, std::size_t n, int32_t *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    vst1q_s32(dst + i, vcombine_s32(vmovn_s64(vcvtq_s64_f64(vld1q_f64(src + i))), vmovn_s64(vcvtq_s64_f64(vld1q_f64(src + i + 2)))));
+  convert<double, int32_t>(src + i, n - i, dst + i, std::false_type());
+}
+inline void convert(const int32_t *src, std::size_t n, double *dst, std::false_type)
+{
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    int32x4_t v = vld1q_s32(src + i);
+    vst1q_f64(dst + i, vcvtq_f64_s64(vmovl_s32(vget_low_s32(v))));
+    vst1q_f64(dst + i + 2, vcvtq_f64_s64(vmovl_high_s32(v)));
+  }
+  convert<int32_t, double>(src + i, n - i, dst + i, std::false_type());
+}
+#endif
+} // namespace mexElementOps
+
+/**
+ * \brief Check that no element is NaN or Inf (always true for integral types)
+ */
+template <typename T>
+bool mexAllFinite(const T *x, std::size_t n)
+{
+  static_assert(std::is_arithmetic<T>::value, "mexAllFinite() checks real elements.");
+  return mexElementOps::all_finite(x, n, std::is_floating_point<T>());
+}
+
+/**
+ * \brief Check if any element is NaN (always false for integral types)
+ */
+template <typename T>
+bool mexAnyNaN(const T *x, std::size_t n)
+{
+  static_assert(std::is_arithmetic<T>::value, "mexAnyNaN() checks real elements.");
+  return mexElementOps::any_nan(x, n, std::is_floating_point<T>());
+}
+
+/**
+ * \brief Check that every element is within [lo, hi] (NaN is not)
+ */
+template <typename T>
+bool mexAllInRange(const T *x, std::size_t n, typename std::remove_const<T>::type lo, typename std::remove_const<T>::type hi)
+{
+  return mexElementOps::all_in_range(x, n, lo, hi);
+}
+
+/**
+ * \brief Check that every element of a floating-point array is an integer within [lo, hi]
+ *
+ * E.g., `mexAllIntegers(x, n, -10.0, 10.0)`, or the range of int32_t to validate a double
+ * array to be converted to int32_t.
+ */
+template <typename T>
+bool mexAllIntegers(const T *x, std::size_t n, T lo, T hi)
+{
+  static_assert(std::is_floating_point<T>::value, "mexAllIntegers() checks floating-point elements.");
+  return mexElementOps::all_integers(x, n, lo, hi);
+}
+
+/**
+ * \brief Copy elements with static_cast to another arithmetic type
+ *
+ * Vectorized for double to and from float and int32_t. Floating-point values converted to an
+ * integral type must be within its range (check first with mexAllIntegers() or mexAllInRange()).
+ */
+template <typename S, typename D>
+void mexConvertCopy(const S *src, std::size_t n, D *dst)
+{
+  mexElementOps::convert(src, n, dst, std::is_same<S, D>());
+}
+
+/**
+ * \brief Overloads on array views (e.g., of the input arguments, without a copy)
+ */
+template <typename T>
+bool mexAllFinite(const mexArrayView<T> &x) { return mexAllFinite(x.data(), x.size()); }
+template <typename T>
+bool mexAnyNaN(const mexArrayView<T> &x) { return mexAnyNaN(x.data(), x.size()); }
+template <typename T>
+bool mexAllInRange(const mexArrayView<T> &x, typename std::remove_const<T>::type lo, typename std::remove_const<T>::type hi)
+{
+  return mexAllInRange(x.data(), x.size(), lo, hi);
+}
+template <typename T>
+bool mexAllIntegers(const mexArrayView<T> &x, typename std::remove_const<T>::type lo, typename std::remove_const<T>::type hi)
+{
+  return mexAllIntegers(x.data(), x.size(), lo, hi);
+}
+template <typename S, typename D>
+void mexConvertCopy(const mexArrayView<S> &src, D *dst) { mexConvertCopy(src.data(), src.size(), dst); }
@@ -0,0 +1,268 @@
+/** \file mexFileArchive.h
+ * C++ header file containing the chunked saving of serialized objects to files and their memory-mapped loading
+ */
+
+#pragma once
+
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+#include "mexSerializer.h"   // for mexArchive and the serialized data format
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \brief Archive to write the payload to a file through a fixed-size buffer
+ *
+ * Memory use is bounded by the buffer, regardless of the object size. A field larger than
+ * the buffer (e.g., a large mexVector) is written directly from its own memory.
+ */
+class mexFileWriteArchive : public mexArchive<mexFileWriteArchive>
+{
+public:
+  static const bool loading = false;
+
+  /**
+   * \param[in] version Class version being saved
+   * \param[in] file    File open for binary writing
+   * \param[in] chunk   Buffer size in bytes
+   */
+  mexFileWriteArchive(uint32_t version, std::FILE *file, std::size_t chunk = 1 << 20)
+      : mexArchive<mexFileWriteArchive>(version), file_m(file), buffer_m(chunk), used_m(0) {}
+
+  void raw(const void *data, std::size_t bytes)
+  {
+    if (used_m + bytes > buffer_m.size())
+    {
+      flush();
+      if (bytes >= buffer_m.size())
+      {
+        write(data, bytes);
+        return;
+      }
+    }
+    std::memcpy(buffer_m.data() + used_m, data, bytes);
+    used_m += bytes;
+  }
+  void expect(uint64_t) {}
+
+  /**
+   * \brief Write the buffered data to the file
+   */
+  void flush()
+  {
+    write(buffer_m.data(), used_m);
+    used_m = 0;
+  }
+
+private:
+  std::FILE *file_m;
+  std::vector<char> buffer_m;
+  std::size_t used_m;
+
+  void write(const void *data, std::size_t bytes)
+  {
+    if (bytes && std::fwrite(data, 1, bytes, file_m) != bytes)
+      throw mexRuntimeError("saveToFile:writeFailed", "Failed to write the serialized data to the file.");
+  }
+};
+
+/**
+ * \brief Read-only memory mapping of a whole file
+ *
+ * The pages are loaded on demand by the operating system and may be evicted again under
+ * memory pressure, so reading a large file through the mapping does not need a buffer of
+ * the file size.
+ */
+class mexMappedFile
+{
+public:
+  /**
+   * \brief Map a file
+   *
+   * \throws mexRuntimeError if the file cannot be opened or mapped
+   */
+  explicit mexMappedFile(const std::string &path) : data_m(NULL), size_m(0)
+  {
+#ifdef _WIN32
+    map_m = NULL;
+    file_m = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_m == INVALID_HANDLE_VALUE)
+      throw mexRuntimeError("loadFromFile:openFailed", "Failed to open " + path + ".");
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_m, &size))
+    {
+      close();
+      throw mexRuntimeError("loadFromFile:openFailed", "Failed to get the size of " + path + ".");
+    }
+    size_m = (uint64_t)size.QuadPart;
+    if (size_m)
+    {
+      map_m = CreateFileMappingA(file_m, NULL, PAGE_READONLY, 0, 0, NULL);
+      data_m = map_m ? MapViewOfFile(map_m, FILE_MAP_READ, 0, 0, 0) : NULL;
+      if (!data_m)
+      {
+        close();
+        throw mexRuntimeError("loadFromFile:mapFailed", "Failed to memory-map " + path + ".");
+      }
+    }
+#else
+    fd_m = ::open(path.c_str(), O_RDONLY);
+    if (fd_m < 0)
+      throw mexRuntimeError("loadFromFile:openFailed", "Failed to open " + path + ".");
+    struct stat st;
+    if (::fstat(fd_m, &st))
+    {
+      close();
+      throw mexRuntimeError("loadFromFile:openFailed", "Failed to get the size of " + path + ".");
+    }
+    size_m = (uint64_t)st.st_size;
+    if (size_m)
+    {
+      void *data = ::mmap(NULL, (std::size_t)size_m, PROT_READ, MAP_PRIVATE, fd_m, 0);
+      if (data == MAP_FAILED)
+      {
+        close();
+        throw mexRuntimeError("loadFromFile:mapFailed", "Failed to memory-map " + path + ".");
+      }
+      data_m = data;
+      ::madvise(data_m, (std::size_t)size_m, MADV_SEQUENTIAL); // read ahead, drop behind
+    }
+#endif
+  }
+
+  ~mexMappedFile() { close(); }
+
+  mexMappedFile(const mexMappedFile &) = delete;
+  mexMappedFile &operator=(const mexMappedFile &) = delete;
+
+  /**
+   * \brief Mapped file contents (NULL if the file is empty)
+   */
+  const void *data() const { return data_m; }
+
+  /**
+   * \brief File size in bytes
+   */
+  uint64_t size() const { return size_m; }
+
+private:
+  void *data_m;
+  uint64_t size_m;
+#ifdef _WIN32
+  HANDLE file_m;
+  HANDLE map_m;
+#else
+  int fd_m;
+#endif
+
+  void close()
+  {
+#ifdef _WIN32
+    if (data_m)
+      UnmapViewOfFile(data_m);
+    if (map_m)
+      CloseHandle(map_m);
+    if (file_m != INVALID_HANDLE_VALUE)
+      CloseHandle(file_m);
+    map_m = NULL;
+    file_m = INVALID_HANDLE_VALUE;
+#else
+    if (data_m)
+      ::munmap(data_m, (std::size_t)size_m);
+    if (fd_m >= 0)
+      ::close(fd_m);
+    fd_m = -1;
+#endif
+    data_m = NULL;
+  }
+};
+
+/**
+ * \brief Serialize an object to a file
+ *
+ * The file has the same format as the blob of mexSerialize() (uncompressed), but the
+ * payload is streamed through a buffer of \p chunk bytes, so no copy of the whole object
+ * state is made in memory. The data is first written to `path + ".part"`, which replaces
+ * \p path only once completely written, so a failed save leaves an existing file intact.
+ *
+ * \param[in] obj     Object with `template <class Archive> void serialize(Archive &)`
+ * \param[in] path    File path
+ * \param[in] version Class version to be stored (available as `ar.version()` on loading)
+ * \param[in] chunk   Write buffer size in bytes
+ *
+ * \throws mexRuntimeError if the file cannot be written
+ */
+template <class T>
+void mexSerializeToFile(T &obj, const std::string &path, uint32_t version = 0, std::size_t chunk = 1 << 20)
+{
+  mexSizeArchive sizer(version);
+  obj.serialize(sizer);
+  mexSerialHeader header = {{'M', 'X', 'S', 'B'}, mexSerialHeader::plain_format, 0, version, 0x01020304, sizer.size()};
+
+  std::string part = path + ".part";
+  std::FILE *file = std::fopen(part.c_str(), "wb");
+  if (!file)
+    throw mexRuntimeError("saveToFile:openFailed", "Failed to open " + part + " for writing.");
+  try
+  {
+    mexFileWriteArchive writer(version, file, chunk);
+    writer.raw(&header, sizeof(header));
+    obj.serialize(writer);
+    writer.flush();
+  }
+  catch (...)
+  {
+    std::fclose(file);
+    std::remove(part.c_str());
+    throw;
+  }
+  if (std::fclose(file))
+  {
+    std::remove(part.c_str());
+    throw mexRuntimeError("saveToFile:writeFailed", "Failed to write the serialized data to " + part + ".");
+  }
+
+#ifdef _WIN32
+  bool replaced = MoveFileExA(part.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  bool replaced = std::rename(part.c_str(), path.c_str()) == 0;
+#endif
+  if (!replaced)
+  {
+    std::remove(part.c_str());
+    throw mexRuntimeError("saveToFile:writeFailed", "Failed to replace " + path + ".");
+  }
+}
+
+/**
+ * \brief Deserialize an object from a file created by mexSerializeToFile() (or a saved mexSerialize() blob)
+ *
+ * The file is memory-mapped and read in place.
+ *
+ * \param[in]    path File path
+ * \param[inout] obj  Object with `template <class Archive> void serialize(Archive &)`
+ * \returns the class version stored in the file
+ *
+ * \throws mexRuntimeError if the file cannot be read or its contents are invalid
+ */
+template <class T>
+uint32_t mexDeserializeFromFile(const std::string &path, T &obj)
+{
+  mexMappedFile file(path);
+  return mexDeserialize(file.data(), file.size(), obj);
+}
@@ -3,9 +3,133 @@
 #include "mexRuntimeError.h"
 
 #include <mex.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
-std::string mexGetString(const mxArray *array)
+/**
+ * \brief Check if mxArray is a string convertible by mexGetString()
+ *
+ * \param[in] array mxArray to be checked
+ * \returns true if \p array is a char array or a scalar cell containing a char array
+ */
+inline bool mexIsString(const mxArray *array)
+{
+  if (mxIsCell(array) && mxIsScalar(array))
+    array = mxGetCell(array, 0);
+  return array && mxIsChar(array);
+}
+
+/**
+ * \brief Convert char/cellstr mxArray to a caller-provided string
+ *
+ * Same as mexGetString(const mxArray *) except that the characters are written to
+ * \p str, reusing its capacity. No heap allocation takes place if \p str already has
+ * sufficient capacity.
+ *
+ * \param[in]  array mxArray containing a char array or a scalar cellstr
+ * \param[out] str   String to receive the converted characters
+ *
+ * \throws mexRuntimeError if \p array is not a string
+ */
+inline void mexGetString(const mxArray *array, std::string &str)
+{
+  // convert a scalar cell-string
+  if (mxIsCell(array) && mxIsScalar(array))
+    array = mxGetCell(array, 0);
+  if (!array || !mxIsChar(array))
+    throw mexRuntimeError("notString", "Failed to convert MATLAB string.");
+
+  // fast path: direct copy of ASCII characters
+  mwSize len = mxGetNumberOfElements(array);
+  const mxChar *chars = mxGetChars(array);
+  str.resize(len);
+  for (mwSize i = 0; i < len; ++i)
+  {
+    if (chars[i] > 127) // non-ASCII, let mxGetString to transcode
+    {
+      str.resize(len * MB_CUR_MAX + 1); // worst case of the multibyte encoding
+      if (mxGetString(array, &str.front(), str.size()) != 0)
+        throw mexRuntimeError("stringConversionFailed", "Failed to convert MATLAB string to a multibyte string.");
+      str.resize(std::strlen(str.c_str())); // remove the trailing NULL character
+      return;
+    }
+    str[i] = (char)chars[i];
+  }
+}
+
+/**
+ * \brief Try to convert a char mxArray to a caller-provided character buffer
+ *
+ * Same as mexGetString(const mxArray *, char *, mwSize) except that \p array must be a char
+ * array and a too small buffer is reported by returning false instead of throwing.
+ *
+ * \param[in]  array   mxArray containing a char array
+ * \param[out] buf     Buffer to receive the converted characters
+ * \param[in]  bufsize Size of \p buf in bytes, including the terminating null character
+ * \param[out] len     Length of the converted string
+ * \returns false if \p buf is too small
+ */
+inline bool mexTryGetString(const mxArray *array, char *buf, mwSize bufsize, mwSize &len)
+{
+  len = mxGetNumberOfElements(array);
+  if (len >= bufsize)
+    return false;
+
+  const mxChar *chars = mxGetChars(array);
+  for (mwSize i = 0; i < len; ++i)
+  {
+    if (chars[i] > 127) // non-ASCII, let mxGetString to transcode (fails only if buf is too small)
+    {
+      if (mxGetString(array, buf, bufsize) != 0)
+        return false;
+      len = (mwSize)std::strlen(buf);
+      return true;
+    }
+    buf[i] = (char)chars[i];
+  }
+  buf[len] = '\0';
+  return true;
+}
+
+/**
+ * \brief Convert char/cellstr mxArray to a caller-provided character buffer
+ *
+ * Writes the null-terminated string to \p buf. Intended to be used with a stack buffer
+ * to convert short strings (e.g., names) without any heap allocation. Note that a non-ASCII
+ * character may take more than one byte (up to MB_CUR_MAX).
+ *
+ * \param[in]  array   mxArray containing a char array or a scalar cellstr
+ * \param[out] buf     Buffer to receive the converted characters
+ * \param[in]  bufsize Size of \p buf in bytes, including the terminating null character
+ * \returns the length of the converted string
+ *
+ * \throws mexRuntimeError if \p array is not a string or \p buf is too small
+ */
+inline mwSize mexGetString(const mxArray *array, char *buf, mwSize bufsize)
+{
+  // convert a scalar cell-string
+  if (mxIsCell(array) && mxIsScalar(array))
+    array = mxGetCell(array, 0);
+  if (!array || !mxIsChar(array))
+    throw mexRuntimeError("notString", "Failed to convert MATLAB string.");
+
+  mwSize len;
+  if (!mexTryGetString(array, buf, bufsize, len))
+    throw mexRuntimeError("stringTooLong", "MATLAB string does not fit in the buffer.");
+  return len;
+}
+
+/**
+ * \brief Convert char/cellstr mxArray to std::string
+ *
+ * \param[in] array mxArray containing a char array or a scalar cellstr
+ * \returns the converted string
+ *
+ * \throws mexRuntimeError if \p array is not a string
+ */
+inline std::string mexGetString(const mxArray *array)
 {
   // ideally use std::codecvt but VSC++ does not support this particular template specialization as of 2017
   // mxChar *str_utf16 = mxGetChars(array);
@@ -13,15 +137,127 @@ std::string mexGetString(const mxArray *array)
   //   throw 0;
   // std::string str = std::wstring_convert<std::codecvt_utf8_utf16<mxChar>, mxChar>{}.to_bytes(str_utf16);
 
-  // convert a scalar cell-string 
-  if (mxIsCell(array) && mxIsScalar(array))
-    return mexGetString(mxGetCell(array, 0));
-
-  mwSize len = mxGetNumberOfElements(array);
   std::string str;
-  str.resize(len + 1);
-  if (mxGetString(array, &str.front(), str.size()) != 0)
-    throw mexRuntimeError("notString", "Failed to convert MATLAB string.");
-  str.resize(len); // remove the trailing NULL character
+  mexGetString(array, str);
   return str;
 }
+
+/**
+ * \brief Small-buffer string converted from a MATLAB string
+ *
+ * mexString holds the converted string in an internal N-byte buffer, so strings shorter
+ * than N bytes (in their multibyte form) are obtained without any heap allocation. Longer
+ * strings fall back to a heap-allocated std::string.
+ *
+ *    mexString<> name(prhs[0]);
+ *    if (name == "VarA")
+ *      ...
+ */
+template <std::size_t N = 64>
+class mexString
+{
+public:
+  /**
+   * \brief Convert char/cellstr mxArray
+   *
+   * \throws mexRuntimeError if \p array is not a string
+   */
+  explicit mexString(const mxArray *array)
+  {
+    const mxArray *chars = (mxIsCell(array) && mxIsScalar(array)) ? mxGetCell(array, 0) : array;
+    mwSize len;
+    if (chars && mxIsChar(chars) && mexTryGetString(chars, buf_m, N, len))
+    {
+      len_m = len;
+      str_m = buf_m;
+    }
+    else // long (in multibyte form) or not a string
+    {
+      mexGetString(array, heap_m);
+      len_m = heap_m.size();
+      str_m = heap_m.c_str();
+    }
+  }
+
+  mexString(const mexString &) = delete;
+  mexString &operator=(const mexString &) = delete;
+
+  const char *c_str() const { return str_m; }
+  const char *data() const { return str_m; }
+  std::size_t size() const { return len_m; }
+  bool empty() const { return len_m == 0; }
+  std::string str() const { return std::string(str_m, len_m); }
+
+  bool operator==(const char *other) const { return std::strcmp(str_m, other) == 0; }
+  bool operator!=(const char *other) const { return !(*this == other); }
+  bool operator==(const std::string &other) const { return other.size() == len_m && other.compare(0, len_m, str_m, len_m) == 0; }
+  bool operator!=(const std::string &other) const { return !(*this == other); }
+
+private:
+  char buf_m[N];       // small buffer
+  std::string heap_m;  // fallback for long strings
+  const char *str_m;   // points to either buf_m or heap_m
+  std::size_t len_m;   // string length
+};
+
+/**
+ * \brief std::string converted from a MATLAB string, backed by a thread-local buffer
+ *
+ * mexBorrowedString borrows a thread-local std::string during its lifetime so that its
+ * capacity is reused across calls. It is intended for the dispatch path where a
+ * `const std::string &` must be passed to an existing interface (e.g., action_handler()).
+ * Once the buffer has grown to fit, converting a string makes no heap allocation.
+ * Nested (reentrant) uses are safe: an inner instance simply gets its own buffer.
+ */
+class mexBorrowedString
+{
+public:
+  /**
+   * \brief Convert char/cellstr mxArray
+   *
+   * \throws mexRuntimeError if \p array is not a string
+   */
+  explicit mexBorrowedString(const mxArray *array)
+  {
+    str_m.swap(cache());
+    mexGetString(array, str_m);
+  }
+  ~mexBorrowedString() { cache().swap(str_m); }
+
+  mexBorrowedString(const mexBorrowedString &) = delete;
+  mexBorrowedString &operator=(const mexBorrowedString &) = delete;
+
+  const std::string &str() const { return str_m; }
+  operator const std::string &() const { return str_m; }
+
+private:
+  std::string str_m;
+
+  static std::string &cache()
+  {
+    static thread_local std::string buf;
+    return buf;
+  }
+};
+
+/**
+ * \brief Compare a MATLAB char array against a C string without conversion
+ *
+ * The mxChar buffer of \p array is compared in place against the single-byte
+ * string \p str, so no intermediate std::string is created.
+ *
+ * \param[in] array mxArray to be compared
+ * \param[in] str   Null-terminated single-byte string
+ * \returns true if \p array is a char array with the same characters as \p str
+ */
+inline bool mexIsStringEqual(const mxArray *array, const char *str)
+{
+  if (!mxIsChar(array))
+    return false;
+  const mxChar *chars = mxGetChars(array);
+  mwSize len = mxGetNumberOfElements(array);
+  for (mwSize i = 0; i < len; ++i, ++str)
+    if (*str == '\0' || chars[i] != (mxChar)(unsigned char)*str)
+      return false;
+  return *str == '\0';
+}
@@ -0,0 +1,173 @@
+/** \file mexHandleRegistry.h
+ * C++ header file containing the handle registry used by mexObjectHandle
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \brief Per-type tag with a unique address
+ *
+ * `&mexTypeTag<T>::id` uniquely identifies type T within a MEX module. It is used by
+ * mexHandleRegistry to make sure a handle is resolved only as the type it was created for.
+ */
+template <class T>
+struct mexTypeTag
+{
+  static const char id;
+};
+template <class T>
+const char mexTypeTag<T>::id = 0;
+
+/**
+ * \brief Generation-tagged slot table of live object handles
+ *
+ * mexHandleRegistry issues the uint64 handles that are given to MATLAB in place of raw
+ * C++ pointers. A handle encodes a slot index (lower 32 bits) and the generation of the
+ * slot (upper 32 bits). Each slot records the object pointer, its type tag, and its
+ * current generation. Validating a handle is a bounds check followed by a comparison
+ * of the generation and type tag. There is no system call and no pointer dereference
+ * of the user-provided value.
+ *
+ * When an object is removed, its slot generation is incremented. Every handle issued
+ * for the removed object then reliably becomes stale, even after the slot is reused.
+ * A slot whose generation is about to wrap around is retired instead of reused.
+ *
+ * Handle value 0 is never issued.
+ *
+ * \note All member functions must be called from the MATLAB thread (i.e., the thread
+ *       running mexFunction()).
+ */
+class mexHandleRegistry
+{
+public:
+  /**
+   * \brief Registry of the MEX module
+   */
+  static mexHandleRegistry &instance()
+  {
+    static mexHandleRegistry registry;
+    return registry;
+  }
+
+  /**
+   * \brief Register an object and issue its handle
+   *
+   * \param[in] ptr  Pointer to the object
+   * \param[in] type Type tag of the object (see mexTypeTag)
+   * \returns the new handle
+   */
+  uint64_t add(void *ptr, const void *type)
+  {
+    uint32_t index;
+    if (free_m.empty())
+    {
+      index = (uint32_t)slots_m.size();
+      slots_m.push_back({1, nullptr, nullptr});
+    }
+    else
+    {
+      index = free_m.back();
+      free_m.pop_back();
+    }
+
+    slot &s = slots_m[index];
+    s.ptr = ptr;
+    s.type = type;
+    ++count_m;
+    return ((uint64_t)s.generation << 32) | index;
+  }
+
+  /**
+   * \brief Resolve a handle
+   *
+   * \param[in] handle Handle issued by add()
+   * \param[in] type   Expected type tag of the object
+   * \returns the object pointer or nullptr if the handle is invalid, stale, or of another type
+   */
+  void *get(uint64_t handle, const void *type) const
+  {
+    uint32_t index = (uint32_t)handle;
+    if (index >= slots_m.size())
+      return nullptr;
+    const slot &s = slots_m[index];
+    return (s.generation == (uint32_t)(handle >> 32) && s.type == type) ? s.ptr : nullptr;
+  }
+
+  /**
+   * \brief Unregister an object
+   *
+   * \param[in] handle Handle issued by add()
+   * \param[in] type   Expected type tag of the object
+   * \returns the object pointer or nullptr if the handle is invalid, stale, or of another type
+   */
+  void *remove(uint64_t handle, const void *type)
+  {
+    void *ptr = get(handle, type);
+    if (!ptr)
+      return nullptr;
+
+    uint32_t index = (uint32_t)handle;
+    slot &s = slots_m[index];
+    s.ptr = nullptr;
+    s.type = nullptr;
+    if (++s.generation != UINT32_MAX) // retire the slot before its generation wraps
+      free_m.push_back(index);
+    --count_m;
+    return ptr;
+  }
+
+  /**
+   * \brief Number of registered objects
+   */
+  std::size_t size() const { return count_m; }
+
+  /**
+   * \brief Visit the registered objects of a type
+   *
+   * The visit scans the whole slot table, in the order of the slots. \p fcn must not add or
+   * remove objects (collect the handles first to remove them).
+   *
+   * \param[in] type Type tag of the objects
+   * \param[in] fcn  Callable as `void(uint64_t handle, void *ptr)`
+   */
+  template <class Fcn>
+  void for_each(const void *type, Fcn fcn) const
+  {
+    for (std::size_t index = 0; index < slots_m.size(); ++index)
+    {
+      const slot &s = slots_m[index];
+      if (s.ptr && s.type == type)
+        fcn(((uint64_t)s.generation << 32) | index, s.ptr);
+    }
+  }
+
+  /**
+   * \brief Handles of the registered objects of a type
+   */
+  std::vector<uint64_t> handles(const void *type) const
+  {
+    std::vector<uint64_t> list;
+    for_each(type, [&list](uint64_t handle, void *) { list.push_back(handle); });
+    return list;
+  }
+
+private:
+  struct slot
+  {
+    uint32_t generation; // incremented each time the slot is vacated
+    const void *type;    // type tag of the registered object (nullptr if vacant)
+    void *ptr;           // registered object (nullptr if vacant)
+  };
+
+  std::vector<slot> slots_m;    // slot table
+  std::vector<uint32_t> free_m; // vacant slots available for reuse
+  std::size_t count_m;          // number of registered objects
+
+  mexHandleRegistry() : count_m(0) {}
+  mexHandleRegistry(const mexHandleRegistry &) = delete;
+  mexHandleRegistry &operator=(const mexHandleRegistry &) = delete;
+};
@@ -0,0 +1,230 @@
+/** \file mexMatlabCallback.h
+ * C++ header file containing the batched calls from C++ into MATLAB functions
+ */
+
+#pragma once
+
+#include "mexGetString.h"    // to convert the MException fields to std::string
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+
+#include <mex.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Batched calls of a MATLAB function from C++ (MATLAB thread only)
+ *
+ * A MATLAB function called once per element (e.g., the cost function of an optimizer or an
+ * event listener) pays the full overhead of mexCallMATLAB() for every element. Instead,
+ * mexMatlabCallback queues the calls with push() and calls the function once per batch of
+ * up to `batch_size` calls, with vectorized arguments: each argument of a call is a real
+ * double column of a fixed number of elements, and the arguments of a batch of `k` calls are
+ * given as `rows`-by-`k` matrices. The function must return each output as a real double
+ * array of `rows*k` elements (e.g., a `1`-by-`k` row of costs), whose column `j` is the output
+ * of the j-th call:
+ *
+ *    mexMatlabCallback cost(prhs[0], {2}, {1}); // f = fcn(X) with X: 2-by-k, f: 1-by-k
+ *    for (std::size_t i = 0; i < n; ++i)
+ *      cost.push({&points[2 * i]}, {&values[i]});
+ *    cost.flush(); // values are valid from here
+ *
+ * The function is called with mexCallMATLABWithTrap(), so a MATLAB error is thrown as
+ * mexRuntimeError (id `callback:failed`) and unwinds the C++ stack normally; the calls of the
+ * failed batch are dropped. The function may call back into the same MEX function: the
+ * queue is released before MATLAB is called, so a nested push() or flush() starts a new
+ * batch. (mexObjectHandler defers the deletion of an object while one of its actions is
+ * running and rejects other reentrant actions on it, see mexObjectHandlerAction().)
+ *
+ * The function is kept as a persistent copy, so a mexMatlabCallback may outlive the MEX
+ * call that created it (e.g., a listener stored in the object). Calls still queued when it
+ * is destructed are discarded.
+ */
+class mexMatlabCallback
+{
+public:
+  /**
+   * \brief Bind a MATLAB function
+   *
+   * \param[in] fcn        Function handle or function name (char array)
+   * \param[in] in_rows    Number of elements of each input argument of a single call
+   * \param[in] out_rows   Number of elements of each output of a single call
+   * \param[in] batch_size Maximum number of calls per MATLAB call (push() flushes a full batch)
+   *
+   * \throws mexRuntimeError if \p fcn is neither a function handle nor a name
+   */
+  mexMatlabCallback(const mxArray *fcn, std::vector<std::size_t> in_rows, std::vector<std::size_t> out_rows, std::size_t batch_size = 1024)
+      : fcn_m(NULL), in_rows_m(std::move(in_rows)), out_rows_m(std::move(out_rows)), batch_size_m(batch_size ? batch_size : 1),
+        inputs_m(in_rows_m.size()), size_m(0), matlab_calls_m(0)
+  {
+    if (mxIsChar(fcn))
+      name_m = mexGetString(fcn);
+    else if (mxGetClassID(fcn) == mxFUNCTION_CLASS)
+    {
+      fcn_m = mxDuplicateArray(fcn);
+      mexMakeArrayPersistent(fcn_m);
+      name_m = "feval";
+    }
+    else
+      throw mexRuntimeError("callback:invalidFunction", "Callback must be a function handle or a function name.");
+    for (std::size_t i = 0; i < inputs_m.size(); ++i)
+      inputs_m[i].reserve(in_rows_m[i] * batch_size_m);
+    outputs_m.reserve(out_rows_m.size() * batch_size_m);
+  }
+
+  ~mexMatlabCallback()
+  {
+    if (fcn_m)
+      mxDestroyArray(fcn_m);
+  }
+
+  mexMatlabCallback(const mexMatlabCallback &) = delete;
+  mexMatlabCallback &operator=(const mexMatlabCallback &) = delete;
+
+  /**
+   * \brief Queue a call
+   *
+   * The arguments are copied. The outputs are written when the batch is run, by flush() or
+   * by a push() filling the batch, so they must stay valid until then.
+   *
+   * \param[in] args Pointer to the elements of each input argument (in_rows[i] each)
+   * \param[in] outs Destination of each output (out_rows[j] elements each)
+   */
+  void push(const double *const args[], double *const outs[])
+  {
+    for (std::size_t i = 0; i < inputs_m.size(); ++i)
+      inputs_m[i].insert(inputs_m[i].end(), args[i], args[i] + in_rows_m[i]);
+    outputs_m.insert(outputs_m.end(), outs, outs + out_rows_m.size());
+    if (++size_m == batch_size_m)
+      flush();
+  }
+  void push(std::initializer_list<const double *> args, std::initializer_list<double *> outs = {})
+  {
+    if (args.size() != in_rows_m.size() || outs.size() != out_rows_m.size())
+      throw mexRuntimeError("callback:invalidArguments", "Number of callback arguments or outputs does not match.");
+    push(args.begin(), outs.begin());
+  }
+
+  /**
+   * \brief Call \p n times with column-major arguments (in_rows[i]-by-n) and outputs (out_rows[j]-by-n)
+   *
+   * Runs in ceil(n/batch_size) MATLAB calls; the outputs are valid on return.
+   */
+  void evaluate(std::size_t n, std::initializer_list<const double *> args, std::initializer_list<double *> outs = {})
+  {
+    if (args.size() != in_rows_m.size() || outs.size() != out_rows_m.size())
+      throw mexRuntimeError("callback:invalidArguments", "Number of callback arguments or outputs does not match.");
+    std::vector<const double *> in(args);
+    std::vector<double *> out(outs);
+    for (std::size_t k = 0; k < n; ++k)
+    {
+      push(in.data(), out.data());
+      for (std::size_t i = 0; i < in.size(); ++i)
+        in[i] += in_rows_m[i];
+      for (std::size_t j = 0; j < out.size(); ++j)
+        out[j] += out_rows_m[j];
+    }
+    flush();
+  }
+
+  /**
+   * \brief Run the queued calls in a single MATLAB call
+   *
+   * \throws mexRuntimeError if the function fails or returns outputs of unexpected size or type
+   */
+  void flush()
+  {
+    if (!size_m)
+      return;
+
+    // take the batch, so that the function may queue new calls (reentrant use)
+    const std::size_t k = size_m;
+    std::vector<double *> dsts;
+    dsts.swap(outputs_m);
+    std::vector<mxArray *> prhs(fcn_m ? 1 : 0, fcn_m);
+    for (std::size_t i = 0; i < inputs_m.size(); ++i)
+    {
+      mxArray *arg = mxCreateDoubleMatrix(in_rows_m[i], k, mxREAL);
+      if (!inputs_m[i].empty())
+        std::memcpy(mxGetPr(arg), inputs_m[i].data(), inputs_m[i].size() * sizeof(double));
+      inputs_m[i].clear();
+      prhs.push_back(arg);
+    }
+    size_m = 0;
+    outputs_m.reserve(dsts.size());
+
+    // call MATLAB
+    const int nlhs = (int)out_rows_m.size();
+    std::vector<mxArray *> plhs(nlhs ? nlhs : 1, (mxArray *)NULL);
+    mxArray *error = mexCallMATLABWithTrap(nlhs, plhs.data(), (int)prhs.size(), prhs.data(), name_m.c_str());
+    ++matlab_calls_m;
+    for (std::size_t i = fcn_m ? 1 : 0; i < prhs.size(); ++i)
+      mxDestroyArray(prhs[i]);
+    if (error)
+      rethrow(error);
+
+    // scatter the outputs
+    std::string message;
+    for (int j = 0; j < nlhs && message.empty(); ++j)
+    {
+      const std::size_t rows = out_rows_m[j];
+      if (!plhs[j] || !mxIsDouble(plhs[j]) || mxIsComplex(plhs[j]) || mxIsSparse(plhs[j]) || mxGetNumberOfElements(plhs[j]) != rows * k)
+        message = "Callback output #" + std::to_string(j + 1) + " must be a real double array of " + std::to_string(rows * k) + " elements.";
+      else
+      {
+        const double *src = mxGetPr(plhs[j]);
+        for (std::size_t c = 0; c < k; ++c)
+          std::memcpy(dsts[c * nlhs + j], src + c * rows, rows * sizeof(double));
+      }
+    }
+    for (int j = 0; j < nlhs; ++j)
+      if (plhs[j])
+        mxDestroyArray(plhs[j]);
+    if (!message.empty())
+      throw mexRuntimeError("callback:invalidOutput", message);
+  }
+
+  /**
+   * \brief Number of queued calls
+   */
+  std::size_t pending() const { return size_m; }
+
+  /**
+   * \brief Number of calls into MATLAB so far
+   */
+  std::size_t matlab_calls() const { return matlab_calls_m; }
+
+private:
+  mxArray *fcn_m;                            // persistent copy of the function handle (NULL if called by name)
+  std::string name_m;                        // function name, or "feval" for a handle
+  std::vector<std::size_t> in_rows_m;        // elements of each input per call
+  std::vector<std::size_t> out_rows_m;       // elements of each output per call
+  std::size_t batch_size_m;                  // calls per MATLAB call
+  std::vector<std::vector<double>> inputs_m; // queued arguments, column-major per input
+  std::vector<double *> outputs_m;           // output destinations, out_rows_m.size() per call
+  std::size_t size_m;                        // number of queued calls
+  std::size_t matlab_calls_m;                // number of mexCallMATLABWithTrap() calls
+
+  // throw the MException returned by mexCallMATLABWithTrap()
+  static void rethrow(mxArray *error)
+  {
+    std::string id, message;
+    mxArray *field = mxGetProperty(error, 0, "identifier");
+    if (field)
+    {
+      id = mexGetString(field);
+      mxDestroyArray(field);
+    }
+    field = mxGetProperty(error, 0, "message");
+    if (field)
+    {
+      message = mexGetString(field);
+      mxDestroyArray(field);
+    }
+    mxDestroyArray(error);
+    throw mexRuntimeError("callback:failed", id.empty() ? "Callback failed: " + message : "Callback failed (" + id + "): " + message);
+  }
+};
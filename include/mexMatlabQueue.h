@@ -0,0 +1,213 @@
+/** \file mexMatlabQueue.h
+ * C++ header file containing the queue to defer MATLAB API calls from worker threads to the MATLAB thread
+ */
+
+#pragma once
+
+#include <mex.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+
+/**
+ * \brief Lock-free multi-producer single-consumer queue
+ *
+ * Node-based MPSC queue after Dmitry Vyukov. push() is wait-free (one atomic exchange)
+ * and may be called from any number of threads concurrently. pop() and empty() may
+ * only be called from a single consumer thread. An element being pushed becomes
+ * visible to the consumer once its push() completes.
+ *
+ * \tparam T Element type (must be default constructible and movable)
+ */
+template <class T>
+class mexMpscQueue
+{
+public:
+  mexMpscQueue() : head_m(new node), tail_m(head_m.load()) {}
+  ~mexMpscQueue()
+  {
+    T value;
+    while (pop(value))
+      ;
+    delete tail_m;
+  }
+
+  mexMpscQueue(const mexMpscQueue &) = delete;
+  mexMpscQueue &operator=(const mexMpscQueue &) = delete;
+
+  /**
+   * \brief Add an element (any thread)
+   */
+  void push(T value)
+  {
+    node *n = new node(std::move(value));
+    node *prev = head_m.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+  }
+
+  /**
+   * \brief Remove the oldest element (consumer thread)
+   *
+   * \returns false if no element is available
+   */
+  bool pop(T &value)
+  {
+    node *next = tail_m->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+    value = std::move(next->value);
+    delete tail_m;
+    tail_m = next; // next becomes the new stub
+    return true;
+  }
+
+  /**
+   * \brief Check if no element is available (consumer thread)
+   */
+  bool empty() const { return !tail_m->next.load(std::memory_order_acquire); }
+
+private:
+  struct node
+  {
+    node() : next(nullptr) {}
+    explicit node(T &&v) : next(nullptr), value(std::move(v)) {}
+    std::atomic<node *> next;
+    T value;
+  };
+
+  std::atomic<node *> head_m; // last pushed node (producers)
+  node *tail_m;               // stub node preceding the oldest element (consumer)
+};
+
+/**
+ * \brief Queue of deferred operations to be run on the MATLAB thread
+ *
+ * MATLAB API functions (mexPrintf, mxCreate*, etc.) may only be called from the MATLAB
+ * thread. Worker threads post the operations needing them to this queue instead (see
+ * mexPost(), mexPostPrintf(), and mexPostCall()) without taking any lock, and the
+ * MATLAB thread runs them in the posted order when it drains the queue:
+ *
+ * * on every entry to mexObjectHandler(),
+ * * on the built-in static action `mexfcn('flush')`, and
+ * * while waiting for a background job (see mexJobTable::wait()).
+ *
+ * An exception thrown by a deferred operation is reported as a MATLAB warning and does
+ * not stop the draining.
+ */
+class mexMatlabQueue
+{
+public:
+  /**
+   * \brief Queue of the MEX module
+   */
+  static mexMatlabQueue &instance()
+  {
+    static mexMatlabQueue queue;
+    return queue;
+  }
+
+  /**
+   * \brief Defer an operation to the MATLAB thread (any thread)
+   */
+  void post(std::function<void()> op) { queue_m.push(std::move(op)); }
+
+  /**
+   * \brief Run all deferred operations (MATLAB thread)
+   *
+   * \returns the number of operations run
+   */
+  std::size_t drain()
+  {
+    std::size_t n = 0;
+    std::function<void()> op;
+    while (queue_m.pop(op))
+    {
+      try
+      {
+        op();
+      }
+      catch (std::exception &e)
+      {
+        mexWarnMsgIdAndTxt("mexutils:deferredOperationFailed", "%s", e.what());
+      }
+      op = nullptr;
+      ++n;
+    }
+    return n;
+  }
+
+  /**
+   * \brief Check if no operation is pending (MATLAB thread)
+   */
+  bool empty() const { return queue_m.empty(); }
+
+private:
+  mexMpscQueue<std::function<void()>> queue_m;
+
+  mexMatlabQueue() {}
+  mexMatlabQueue(const mexMatlabQueue &) = delete;
+  mexMatlabQueue &operator=(const mexMatlabQueue &) = delete;
+};
+
+/**
+ * \brief Defer an operation to the MATLAB thread
+ *
+ * \param[in] op Callable as `void()`, run on the MATLAB thread
+ */
+inline void mexPost(std::function<void()> op) { mexMatlabQueue::instance().post(std::move(op)); }
+
+/**
+ * \brief Deferred mexPrintf() for worker threads
+ *
+ * The message is formatted on the calling thread and printed on the MATLAB thread.
+ */
+inline void mexPostPrintf(const char *fmt, ...)
+{
+  va_list args, args2;
+  va_start(args, fmt);
+  va_copy(args2, args);
+  int len = std::vsnprintf(nullptr, 0, fmt, args);
+  va_end(args);
+  if (len < 0)
+  {
+    va_end(args2);
+    return;
+  }
+  std::string msg(len + 1, '\0');
+  std::vsnprintf(&msg[0], msg.size(), fmt, args2);
+  va_end(args2);
+  msg.resize(len);
+
+  mexPost([msg]() { mexPrintf("%s", msg.c_str()); });
+}
+
+/**
+ * \brief Run a function on the MATLAB thread and get its result in the future
+ *
+ * Use it to construct MATLAB data (e.g., a persistent output mxArray) from a worker thread.
+ * The future becomes ready when the MATLAB thread drains the queue, and it holds the
+ * exception if the function throws.
+ *
+ * \note Waiting for the future in a worker blocks it until the next drain; do not wait
+ *       from a task the MATLAB thread itself waits for unless it drains while waiting
+ *       (as mexJobTable::wait() does).
+ *
+ * \param[in] fcn Callable as `R()`, run on the MATLAB thread
+ * \returns the future of the return value
+ */
+template <class Fcn>
+auto mexPostCall(Fcn fcn) -> std::future<decltype(fcn())>
+{
+  typedef decltype(fcn()) R;
+  auto task = std::make_shared<std::packaged_task<R()>>(std::move(fcn));
+  std::future<R> result = task->get_future();
+  mexPost([task]() { (*task)(); });
+  return result;
+}
@@ -4,19 +4,79 @@
 
 #pragma once
 
-#include "mexGetString.h"    // to convert char mexArray to std::string
-#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+#include "mexActionTable.h"    // for constant-time action dispatch
+#include "mexAsyncJob.h"       // for background actions
+#include "mexAtExit.h"         // to release the object pools
+#include "mexGetString.h"      // to convert char mexArray to std::string
+#include "mexHandleRegistry.h" // for validation of object handles
+#include "mexMatlabCallback.h" // for batched calls into MATLAB functions
+#include "mexMatlabQueue.h"    // for MATLAB API calls deferred by worker threads
+#include "mexRuntimeError.h"   // for mexRuntimeError runtime exception class
+#include "mexScratchArena.h"   // for per-call temporary memory
+#include "mexStats.h"          // for optional call statistics
+#include "mexThreadPool.h"     // for module-wide worker threads
+#include "mexVector.h"         // for zero-copy property export
 
 #include <mex.h>
 #include <stdint.h>
-#include <typeinfo>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#ifdef _MSC_VER
-#include <Windows.h>
-#else
-#include <sys/mman.h>
-#include <unistd.h>
-#endif
+/**
+ * \brief Type trait of the number of recycled mexObjectHandle objects of a wrapped class
+ *
+ * T::object_pool_size if T defines `static const std::size_t object_pool_size`, or 0 (no
+ * recycling) otherwise.
+ */
+template <class T, class = void>
+struct mexObjectPoolSize : std::integral_constant<std::size_t, 0>
+{
+};
+template <class T>
+struct mexObjectPoolSize<T, decltype((void)T::object_pool_size)> : std::integral_constant<std::size_t, T::object_pool_size>
+{
+};
+
+/**
+ * \brief Type trait to check if T::reset() accepts the given arguments
+ *
+ * An object created with such arguments is kept alive when destroyed and reset() by the
+ * next creation with them (see mexObjectPoolSize).
+ */
+template <class T, class = void, class... Args>
+struct mexHasResetImpl : std::false_type
+{
+};
+template <class T, class... Args>
+struct mexHasResetImpl<T, decltype((void)std::declval<T &>().reset(std::declval<Args>()...)), Args...> : std::true_type
+{
+};
+template <class T, class... Args>
+using mexHasReset = mexHasResetImpl<T, void, Args...>;
+
+/**
+ * \brief Type trait to check if the actions of a wrapped class may be reentered
+ *
+ * T::reentrant_actions if T defines `static const bool reentrant_actions`, or false
+ * otherwise. If false, mexObjectHandler rejects an action on an object while another of its
+ * actions is in progress (i.e., called back from MATLAB, see mexMatlabCallback.h).
+ */
+template <class T, class = void>
+struct mexAllowsReentrantActions : std::false_type
+{
+};
+template <class T>
+struct mexAllowsReentrantActions<T, decltype((void)T::reentrant_actions)> : std::integral_constant<bool, T::reentrant_actions>
+{
+};
 
 /**
  * \brief Underlying wrapper class to wrap C++ object by an mxArray object
@@ -29,6 +89,30 @@
  * <A HREF="https://www.mathworks.com/matlabcentral/fileexchange/38964">
  * Oliver Woodford's Matlab File Exchange entry</A>. The main change in mexObjectHandle
  * is the C++ object is stored within mexObjectHandle rather than its pointer.
+ * 
+ * The handle given to MATLAB is not a pointer but an id issued by \ref mexHandleRegistry.
+ * Validating a handle is a constant-time table lookup, and handles of destroyed objects
+ * are reliably detected as stale.
+ * 
+ * For short-lived objects (e.g., temporaries created and deleted in a MATLAB loop), the
+ * wrapped class may enable recycling by defining the number of objects to keep:
+ * 
+ *    static const std::size_t object_pool_size = 16;
+ * 
+ * Then the storage of destroyed objects is reused by the next create() calls. If the class
+ * also defines a `reset` member function taking the arguments of create() (i.e., of its
+ * constructor), destroyed objects are not even destructed: they are kept alive and reset()
+ * is called on reuse instead of the constructor. Only the objects created with arguments
+ * accepted by reset() (and their clones) are kept alive, and only such creations reuse them;
+ * the other objects are destructed as usual. reset() must leave the object as if newly
+ * constructed. Note that the objects kept alive hold on to their resources (memory, files,
+ * etc.) until reused or until MATLAB clears the MEX function. If reset() throws, the object
+ * is destructed and the exception propagates from create(). Recycled objects are given new
+ * handles.
+ * 
+ * An object is marked busy while an \ref action_scope on it exists. Destroying a busy object
+ * (e.g., deleting it from a MATLAB callback of its own action) invalidates its handle at
+ * once, but its destruction is deferred until the last action on it returns.
  */
 template <class wrappedClass>
 class mexObjectHandle
@@ -41,8 +125,8 @@ public:
    * directly to the constructor of the target class, instantiating the
    * object wrapped by the mxArray.
    * 
-   * The created mxArray encompasses a scalar uint64 value, which is a cast
-   * of the pointer to a mexObjectHandle class instance. Before the returned
+   * The created mxArray encompasses a scalar uint64 value, which is the handle
+   * id of a mexObjectHandle class instance in \ref mexHandleRegistry. Before the returned
    * mxArray is destroyed (either in MATLAB or in C++), \ref destroy() or 
    * \ref _destroy() must be called to delete the pointed mexObjectHandle object.
    * 
@@ -55,8 +139,10 @@ public:
   static mxArray *create(Args... args)
   {
     // instantiate a new object (it may throw an exception if fails) and wrap it in an mxArray
+    mexObjectHandle<wrappedClass> *ptr = acquire(mexHasReset<wrappedClass, Args...>(), args...);
     mxArray *out = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
-    *((uint64_t *)mxGetData(out)) = reinterpret_cast<uint64_t>(new mexObjectHandle<wrappedClass>(args...));
+    *((uint64_t *)mxGetData(out)) = mexHandleRegistry::instance().add(ptr, &mexTypeTag<wrappedClass>::id);
+    mexClassStats<wrappedClass>::instance().object_created(sizeof(mexObjectHandle<wrappedClass>));
 
     // lock MEX function only after successful object creation
     mexLock();
@@ -64,6 +150,29 @@ public:
     return out;
   }
 
+  /**
+   * \brief Copy the wrapped class object into a new mexObjectHandle
+   * 
+   * The wrapped class is copy-constructed directly from the object wrapped by \p in,
+   * without converting its state to mxArrays. Members held by mexCowPtr are shared until
+   * either object modifies them. Like create(), the returned mxArray must be destroyed via
+   * \ref destroy() or \ref _destroy().
+   * 
+   * \param[in] in Pointer to wrapper mxArray object
+   * \returns mxArray containing the handle to the new copy
+   * 
+   * \throws mexRuntimeError if mxArray does not own a mexObjectHandle
+   */
+  static mxArray *clone(const mxArray *in)
+  {
+    mexObjectHandle<wrappedClass> *ptr = construct(clone_tag(), *getHandle(in)); // recycled like its source
+    mxArray *out = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *((uint64_t *)mxGetData(out)) = mexHandleRegistry::instance().add(ptr, &mexTypeTag<wrappedClass>::id);
+    mexClassStats<wrappedClass>::instance().object_created(sizeof(mexObjectHandle<wrappedClass>));
+    mexLock();
+    return out;
+  }
+
   /**
    * \brief Get wrapped class object from mxArray
    * 
@@ -80,6 +189,112 @@ public:
     return mexObjectHandle<wrappedClass>::getHandle(in)->obj_m;
   }
 
+  /**
+   * \brief Get the wrapped class objects of an array of handles in one pass
+   * 
+   * For actions taking other objects of the class as arguments. \p in is either a uint64
+   * array of handles (e.g., `[objs.backend]` in MATLAB), whose elements are resolved by
+   * direct registry lookups, or an array of MATLAB objects, whose `backend` property is
+   * read once per element.
+   * 
+   * \param[in]  in  Pointer to an mxArray of handles or of MATLAB objects
+   * \param[out] out Output iterator receiving a `wrappedClass *` per element, in order
+   * \returns the output iterator past the last object
+   * 
+   * \throws mexRuntimeError if any element does not own a mexObjectHandle
+   */
+  template <class OutputIt>
+  static OutputIt getObjects(const mxArray *in, OutputIt out)
+  {
+    resolve(in, [&out](mexObjectHandle<wrappedClass> *handle) { *out = &handle->obj_m; ++out; });
+    return out;
+  }
+
+  /**
+   * \brief Get the managing mexObjectHandles of an array of handles in one pass
+   * 
+   * Same as getObjects(), but yields the `mexObjectHandle<wrappedClass> *` of each element,
+   * e.g., to hold an action_scope on every object of the array.
+   */
+  template <class OutputIt>
+  static OutputIt getHandles(const mxArray *in, OutputIt out)
+  {
+    resolve(in, [&out](mexObjectHandle<wrappedClass> *handle) { *out = handle; ++out; });
+    return out;
+  }
+
+  /**
+   * \brief Handles of all the live objects of the wrapped class
+   * 
+   * Includes the objects whose MATLAB objects are gone without deleting them (leaked), which
+   * keep the MEX function locked.
+   */
+  static std::vector<uint64_t> handles()
+  {
+    return mexHandleRegistry::instance().handles(&mexTypeTag<wrappedClass>::id);
+  }
+
+  /**
+   * \brief Destruct wrapped class instance by its handle
+   * 
+   * \param[in] id Handle of the object
+   * \returns false if the handle is invalid, already destroyed, or of another class
+   */
+  static bool destroyHandle(uint64_t id)
+  {
+    void *ptr = mexHandleRegistry::instance().remove(id, &mexTypeTag<wrappedClass>::id);
+    if (!ptr)
+      return false;
+    mexObjectHandle<wrappedClass> *handle = static_cast<mexObjectHandle<wrappedClass> *>(ptr);
+    if (handle->busy_m)
+      handle->deleted_m = true; // destructed by the last action_scope
+    else
+      finish_destroy(handle);
+    return true;
+  }
+
+  /**
+   * \brief Scope of an action on the wrapped object
+   * 
+   * Marks the object busy for its lifetime, so that a destroy requested meanwhile is
+   * deferred to the end of the outermost scope on the object.
+   * 
+   *    mexObjectHandle<myClass>::action_scope scope(backend); // throws if the handle is invalid
+   *    scope.object().run(...);
+   */
+  class action_scope
+  {
+  public:
+    explicit action_scope(const mxArray *in) : handle_m(getHandle(in)) { ++handle_m->busy_m; }
+    explicit action_scope(mexObjectHandle<wrappedClass> *handle) : handle_m(handle) { ++handle_m->busy_m; }
+    ~action_scope()
+    {
+      if (!--handle_m->busy_m && handle_m->deleted_m)
+        finish_destroy(handle_m);
+    }
+
+    action_scope(const action_scope &) = delete;
+    action_scope &operator=(const action_scope &) = delete;
+
+    /**
+     * \brief Wrapped object
+     */
+    wrappedClass &object() const { return handle_m->obj_m; }
+
+    /**
+     * \brief Check if another action_scope on the object was already active (a reentrant call)
+     */
+    bool reentered() const { return handle_m->busy_m > 1; }
+
+    /**
+     * \brief Check if the object was deleted during the scope (destructed when the scope ends)
+     */
+    bool deleted() const { return handle_m->deleted_m; }
+
+  private:
+    mexObjectHandle<wrappedClass> *handle_m;
+  };
+
   /**
  * \brief Destruct wrapped class instance (unsafe version)
  * 
@@ -91,10 +306,8 @@ public:
  */
   static void _destroy(const mxArray *in)
   {
-    delete mexObjectHandle<wrappedClass>::getHandle(in);
-
-    // allow MATLAB to release the MEX function
-    mexUnlock();
+    if (!destroyHandle(getId(in)))
+      throw mexRuntimeError("invalidMexObjectHandle", "Handle is either invalid, already destroyed, or not wrapping the intended C++ object.");
   }
 
   /**
@@ -125,17 +338,158 @@ private:
    * /param[in] args Variable arguments for the wrapped class construction
    */
   template <class... Args>
-  mexObjectHandle(Args... args) : obj_m(args...), name_m(typeid(wrappedClass).name()) {}
+  mexObjectHandle(Args... args) : obj_m(args...), busy_m(0), deleted_m(false), recyclable_m(false) {}
+
+  struct clone_tag
+  {
+  };
+  mexObjectHandle(clone_tag, const mexObjectHandle &src) : obj_m(src.obj_m), busy_m(0), deleted_m(false), recyclable_m(src.recyclable_m) {}
 
   /**
    * \brief mexObjectHandle destruction
-   * 
-   * Clears name to make sure an attempt to access after _destroy() call yields in exception
    */
-  ~mexObjectHandle() { name_m = NULL; }
+  ~mexObjectHandle() {}
 
-  const char *name_m; // points to the class
   wrappedClass obj_m; // instance of the wrapped class
+  unsigned busy_m;    // number of active action_scope objects
+  bool deleted_m;     // destroyed while busy: destruct when the last action_scope ends
+  bool recyclable_m;  // created with arguments accepted by reset(): kept alive in the pool when destroyed
+
+  // recycled handles (see mexObjectPoolSize)
+  struct pool_type
+  {
+    std::vector<void *> storage;                      // storage of destructed handles
+    std::vector<mexObjectHandle<wrappedClass> *> live; // handles of objects waiting for reset()
+
+    pool_type()
+    {
+      storage.reserve(mexObjectPoolSize<wrappedClass>::value);
+      live.reserve(mexObjectPoolSize<wrappedClass>::value);
+      if (mexObjectPoolSize<wrappedClass>::value)
+        mexOnExit([]() { pool().clear(); }); // while the MATLAB memory manager is still available
+    }
+    ~pool_type() { clear(); }
+
+    void clear()
+    {
+      for (auto handle : live)
+        handle->~mexObjectHandle();
+      for (auto handle : live)
+        ::operator delete(handle);
+      for (auto mem : storage)
+        ::operator delete(mem);
+      live.clear();
+      storage.clear();
+    }
+  };
+
+  static pool_type &pool()
+  {
+    static pool_type p;
+    return p;
+  }
+
+  // construct a handle, reusing pooled storage if available
+  template <class... Args>
+  static mexObjectHandle<wrappedClass> *construct(Args &&... args)
+  {
+    pool_type &p = pool();
+    void *mem;
+    if (p.storage.empty())
+    {
+      mem = ::operator new(sizeof(mexObjectHandle<wrappedClass>));
+    }
+    else
+    {
+      mem = p.storage.back();
+      p.storage.pop_back();
+    }
+    try
+    {
+      return new (mem) mexObjectHandle<wrappedClass>(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      p.storage.push_back(mem); // never exceeds the reserved capacity
+      throw;
+    }
+  }
+
+  template <class... Args>
+  static mexObjectHandle<wrappedClass> *acquire(std::false_type, Args... args) { return construct(args...); }
+  template <class... Args>
+  static mexObjectHandle<wrappedClass> *acquire(std::true_type, Args... args)
+  {
+    pool_type &p = pool();
+    if (p.live.empty())
+    {
+      mexObjectHandle<wrappedClass> *handle = construct(args...);
+      handle->recyclable_m = true;
+      return handle;
+    }
+
+    mexObjectHandle<wrappedClass> *handle = p.live.back();
+    p.live.pop_back();
+    handle->deleted_m = false;
+    try
+    {
+      handle->obj_m.reset(args...);
+    }
+    catch (...)
+    {
+      handle->~mexObjectHandle();
+      p.storage.push_back(handle);
+      throw;
+    }
+    return handle;
+  }
+
+  // destroy a handle, keeping it in the pool if there is room
+  static void release(mexObjectHandle<wrappedClass> *handle)
+  {
+    pool_type &p = pool();
+    const std::size_t capacity = mexObjectPoolSize<wrappedClass>::value;
+    if (handle->recyclable_m && p.live.size() + p.storage.size() < capacity)
+    {
+      p.live.push_back(handle);
+      return;
+    }
+    handle->~mexObjectHandle();
+    if (p.live.size() + p.storage.size() < capacity)
+      p.storage.push_back(handle);
+    else
+      ::operator delete(handle);
+  }
+
+  // destruct the object of a handle removed from the registry
+  static void finish_destroy(mexObjectHandle<wrappedClass> *handle)
+  {
+    // stop the background jobs while the whole object is still intact
+    cancel_jobs(mexHasAsyncJobs<wrappedClass>(), handle->obj_m);
+    release(handle);
+    mexClassStats<wrappedClass>::instance().object_destroyed(sizeof(mexObjectHandle<wrappedClass>));
+
+    // allow MATLAB to release the MEX function
+    mexUnlock();
+  }
+
+  static void cancel_jobs(std::false_type, wrappedClass &) {}
+  static void cancel_jobs(std::true_type, wrappedClass &obj) { obj.cancel_jobs(); }
+
+  /**
+   * \brief Get handle id from mxArray
+   * 
+   * /param[in] in A pointer to an mxArray object
+   * /returns the handle id
+   * 
+   * /throws mexRuntimeError if mxArray is not a real uint64 scalar
+   */
+  static uint64_t getId(const mxArray *in)
+  {
+    if (mxGetNumberOfElements(in) != 1 || mxGetClassID(in) != mxUINT64_CLASS || mxIsComplex(in))
+      throw mexRuntimeError("invalidMexObjectHandle", "Input must be a real uint64 scalar.");
+    return *((uint64_t *)mxGetData(in));
+  }
 
   /**
    * \brief Get mexObjectHandle from mxArray
@@ -150,52 +504,738 @@ private:
    */
   static mexObjectHandle<wrappedClass> *getHandle(const mxArray *in)
   {
-    if (mxGetNumberOfElements(in) != 1 || mxGetClassID(in) != mxUINT64_CLASS || mxIsComplex(in))
-      throw mexRuntimeError("invalidMexObjectHandle", "Input must be a real uint64 scalar.");
-    mexObjectHandle<wrappedClass> *ptr = reinterpret_cast<mexObjectHandle<wrappedClass> *>(*((uint64_t *)mxGetData(in)));
+    void *ptr = mexHandleRegistry::instance().get(getId(in), &mexTypeTag<wrappedClass>::id);
+    if (!ptr)
+      throw mexRuntimeError("invalidMexObjectHandle", "Handle is either invalid, already destroyed, or not wrapping the intended C++ object.");
+    return static_cast<mexObjectHandle<wrappedClass> *>(ptr);
+  }
+
+  // resolve every element of an array of handles or of MATLAB objects (see getObjects())
+  template <class Fcn>
+  static void resolve(const mxArray *in, Fcn fcn)
+  {
+    mwSize n = mxGetNumberOfElements(in);
+    const mexHandleRegistry &registry = mexHandleRegistry::instance();
+    if (mxGetClassID(in) == mxUINT64_CLASS && !mxIsComplex(in))
+    {
+      const uint64_t *ids = (const uint64_t *)mxGetData(in);
+      for (mwIndex k = 0; k < n; ++k)
+      {
+        void *ptr = registry.get(ids[k], &mexTypeTag<wrappedClass>::id);
+        if (!ptr)
+          throw mexRuntimeError("invalidMexObjectHandle", "Handle #" + std::to_string(k + 1) + " is either invalid, already destroyed, or not wrapping the intended C++ object.");
+        fcn(static_cast<mexObjectHandle<wrappedClass> *>(ptr));
+      }
+      return;
+    }
+    for (mwIndex k = 0; k < n; ++k)
+    {
+      mxArray *backend = mxGetProperty(in, k, "backend");
+      void *ptr = backend && !mxIsEmpty(backend) && mxGetClassID(backend) == mxUINT64_CLASS
+                      ? registry.get(*(uint64_t *)mxGetData(backend), &mexTypeTag<wrappedClass>::id)
+                      : nullptr;
+      if (backend)
+        mxDestroyArray(backend);
+      if (!ptr)
+        throw mexRuntimeError("invalidMexObjectHandle", "Object #" + std::to_string(k + 1) + " has no valid backend of the intended C++ class.");
+      fcn(static_cast<mexObjectHandle<wrappedClass> *>(ptr));
+    }
+  }
+};
+
+/**
+ * \brief Action dispatcher of mexObjectHandler
+ * 
+ * mexActionDispatcher routes an action call to the wrapped class. If the class defines 
+ * `action_table()` (or `static_action_table()` for static actions), the action name is
+ * looked up there first directly from the mxChar buffer of the name mxArray. Only if the 
+ * action is not found in the table, the name is converted to std::string (reusing a 
+ * thread-local buffer, see mexBorrowedString) and the call falls back to `action_handler()`
+ * (or `static_handler()`), if defined.
+ * 
+ * The object action table takes precedence over `action_handler()` only if mexClass declares
+ * it for itself, i.e., it returns `const mexActionTable<mexClass> &` (see mexHasActionTable).
+ * An inherited table, such as mexSetGetClass::action_table(), is not consulted, so overrides
+ * of `action_handler()` keep handling the base class actions.
+ */
+template <class mexClass>
+struct mexActionDispatcher
+{
+  /**
+   * \brief Run an object action
+   * 
+   * \returns false if the action is unknown
+   */
+  static bool action(mexClass &obj, const mxArray *mxObj, const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    return from_table(mexHasActionTable<mexClass>(), obj, mxObj, action, nlhs, plhs, nrhs, prhs) ||
+           from_broadcast_table(mexHasBroadcastTable<mexClass>(), obj, action, nlhs, plhs, nrhs, prhs) ||
+           obj.action_handler(mxObj, mexBorrowedString(action), nlhs, plhs, nrhs, prhs);
+  }
+
+  /**
+   * \brief Run a static action
+   * 
+   * \returns false if the action is unknown
+   */
+  static bool static_action(const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    return from_table(mexHasStaticActionTable<mexClass>(), action, nlhs, plhs, nrhs, prhs) ||
+           from_handler(mexHasStaticHandler<mexClass>(), action, nlhs, plhs, nrhs, prhs);
+  }
 
-    // first check that the retrieved pointer is valid
-    if (!mexObjectHandle<wrappedClass>::isValidPointer(ptr))
-      throw mexRuntimeError("invalidMexObjectHandle", "Handle is not a valid C++ pointer.");
+private:
+  static bool from_table(std::false_type, mexClass &, const mxArray *, const mxArray *, int, mxArray *[], int, const mxArray *[]) { return false; }
+  static bool from_table(std::true_type, mexClass &obj, const mxArray *mxObj, const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    auto fcn = mexClass::action_table().find(action);
+    if (!fcn)
+      return false;
+    (obj.*fcn)(mxObj, nlhs, plhs, nrhs, prhs);
+    return true;
+  }
 
-    //  if (ptr->name_m!=typeid(wrappedClass).name()) // <-likely safe but not standard guaranteed alternative
-    const char *type_name = typeid(wrappedClass).name();
-    if (ptr->name_m != type_name &&
-        (!mexObjectHandle<wrappedClass>::isValidPointer(ptr->name_m) || strcmp(ptr->name_m, type_name)))
-      throw mexRuntimeError("invalidMexObjectHandle", "Handle is either invalid or not wrapping the intended C++ object.");
+  // run a broadcast action on a single object
+  static bool from_broadcast_table(std::false_type, mexClass &, const mxArray *, int, mxArray *[], int, const mxArray *[]) { return false; }
+  static bool from_broadcast_table(std::true_type, mexClass &obj, const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    auto fcn = mexClass::broadcast_table().find(action);
+    if (!fcn)
+      return false;
+    if (nlhs > 1)
+      throw mexRuntimeError("tooManyOutputArguments", "Broadcast actions return up to one output.");
+    mexBroadcastTask task = (obj.*fcn)(nrhs, prhs);
+    if (task.compute)
+      task.compute();
+    mxArray *rval = task.result ? task.result() : NULL;
+    if (nlhs > 0)
+      plhs[0] = rval ? rval : mxCreateDoubleMatrix(0, 0, mxREAL);
+    else if (rval)
+      mxDestroyArray(rval);
+    return true;
+  }
 
-    return ptr;
+  static bool from_table(std::false_type, const mxArray *, int, mxArray *[], int, const mxArray *[]) { return false; }
+  static bool from_table(std::true_type, const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    auto fcn = mexClass::static_action_table().find(action);
+    if (!fcn)
+      return false;
+    fcn(nlhs, plhs, nrhs, prhs);
+    return true;
   }
 
-  template <typename T>
-  static bool isValidPointer(T *lpAddress)
+  static bool from_handler(std::false_type, const mxArray *, int, mxArray *[], int, const mxArray *[]) { return false; }
+  static bool from_handler(std::true_type, const mxArray *action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
-#ifdef _MSC_VER
-    // https://stackoverflow.com/a/35576777/4516027
-    MEMORY_BASIC_INFORMATION mbi = {0};
-    if (::VirtualQuery(lpAddress, &mbi, sizeof(mbi)))
+    return mexClass::static_handler(mexBorrowedString(action), nlhs, plhs, nrhs, prhs);
+  }
+};
+
+/**
+ * \brief Run a batch of object actions in a single MEX call
+ * 
+ * Implements the built-in `batch` action of mexObjectHandler:
+ * 
+ *    results = mexfcn(obj,'batch',ops)
+ *    results = mexfcn(obj,'batch',ops,nargouts)
+ * 
+ * where `ops` is a cell array of operations, each of which is a cell `{'action', arg1, arg2, ...}`.
+ * Operations are performed in order, and `results` is a cell array of the same size as `ops`.
+ * Each element of `results` is empty if the operation returns nothing, the output if it returns
+ * one, or a cell row vector of the outputs otherwise. `nargouts` specifies the number of outputs 
+ * requested from each operation, either as a scalar (for all) or per operation. If omitted, all 
+ * operations are requested one output if `results` is requested and none otherwise.
+ * 
+ * \param[in]    obj   Wrapped C++ object
+ * \param[in]    mxObj Associated MATLAB class object
+ * \param[in]    nlhs  Number of expected output mxArrays
+ * \param[inout] plhs  Array of pointers to the expected output mxArrays
+ * \param[in]    nrhs  Number of input mxArrays
+ * \param[in]    prhs  Array of pointers to the input mxArrays
+ */
+template <class mexClass>
+void mexObjectHandlerBatch(mexClass &obj, const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  if (nlhs > 1 || nrhs < 1 || nrhs > 2 || !mxIsCell(prhs[0]))
+    throw mexRuntimeError("batch:invalidArguments", "Batch action takes a cell array of operations (and optional number of outputs) and returns up to one output.");
+
+  const mxArray *ops = prhs[0];
+  mwSize nops = mxGetNumberOfElements(ops);
+
+  // number of outputs of each operation
+  const mxArray *nargouts = nrhs > 1 ? prhs[1] : NULL;
+  if (nargouts && (!mxIsDouble(nargouts) || mxIsComplex(nargouts) ||
+                   (mxGetNumberOfElements(nargouts) != 1 && mxGetNumberOfElements(nargouts) != nops)))
+    throw mexRuntimeError("batch:invalidArguments", "Batch action's nargouts must be a double scalar or match the number of operations.");
+
+  mxArray *results = nlhs > 0 ? mxCreateCellArray(mxGetNumberOfDimensions(ops), mxGetDimensions(ops)) : NULL;
+
+  std::vector<mxArray *, mexScratchAllocator<mxArray *>> outs;
+  std::vector<const mxArray *, mexScratchAllocator<const mxArray *>> args;
+  for (mwIndex k = 0; k < nops; ++k)
+  {
+    // parse the operation
+    const mxArray *op = mxGetCell(ops, k);
+    if (!op || !mxIsCell(op) || mxIsEmpty(op) || !mxGetCell(op, 0) || !mxIsChar(mxGetCell(op, 0)))
+      throw mexRuntimeError("batch:invalidOperation", "Each batch operation must be a cell array starting with an action name.");
+    const mxArray *action = mxGetCell(op, 0);
+    if (mexIsStringEqual(action, "delete") || mexIsStringEqual(action, "batch") || mexIsStringEqual(action, "clone"))
+      throw mexRuntimeError("batch:invalidOperation", "delete, batch, and clone actions cannot be batched.");
+
+    mwSize nargs = mxGetNumberOfElements(op) - 1;
+    args.resize(nargs);
+    for (mwIndex i = 0; i < nargs; ++i)
+      args[i] = mxGetCell(op, i + 1);
+
+    int nout = nlhs > 0 ? 1 : 0;
+    if (nargouts)
     {
-      DWORD mask = (PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY);
-      bool b = mbi.Protect & mask;
+      double val = mxGetPr(nargouts)[mxGetNumberOfElements(nargouts) == 1 ? 0 : k];
+      nout = (int)val;
+      if (nout != val || nout < 0)
+        throw mexRuntimeError("batch:invalidArguments", "Batch action's nargouts must be non-negative integers.");
+    }
+    outs.assign(nout > 0 ? nout : 1, (mxArray *)NULL);
 
-      // check the page is not a guard page
-      if (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS))
-        b = false;
+    // run the operation
+    try
+    {
+      if (!mexActionDispatcher<mexClass>::action(obj, mxObj, action, nout, outs.data(), (int)nargs, args.data()))
+        throw mexRuntimeError("batch:unknownAction", std::string("Unknown action: ") + mexGetString(action));
+    }
+    catch (mexRuntimeError &e)
+    {
+      std::string msg = "Batch operation #" + std::to_string(k + 1) + " failed: " + e.what();
+      throw mexRuntimeError(e.id(), msg);
+    }
+    catch (std::exception &e)
+    {
+      std::string msg = "Batch operation #" + std::to_string(k + 1) + " failed: " + e.what();
+      throw mexRuntimeError("batch:failedAction", msg);
+    }
 
-      return b;
+    // collect the outputs
+    if (!results)
+    {
+      for (int i = 0; i < nout; ++i)
+        if (outs[i])
+          mxDestroyArray(outs[i]);
     }
+    else if (nout == 1)
+    {
+      mxSetCell(results, k, outs[0]);
+    }
+    else if (nout > 1)
+    {
+      mxArray *cell = mxCreateCellMatrix(1, nout);
+      for (int i = 0; i < nout; ++i)
+        mxSetCell(cell, i, outs[i]);
+      mxSetCell(results, k, cell);
+    }
+  }
+
+  if (results)
+    plhs[0] = results;
+}
+
+/**
+ * \brief Run the broadcast tasks of mexObjectHandlerBroadcast()
+ * 
+ * \returns false if action is not in the broadcast table
+ */
+template <class mexClass>
+bool mexObjectHandlerBroadcastTasks(std::false_type, mexClass **, mwSize, const mxArray *, int, const mxArray *[], mxArray *) { return false; }
+template <class mexClass>
+bool mexObjectHandlerBroadcastTasks(std::true_type, mexClass **targets, mwSize nobjs, const mxArray *action, int nargs, const mxArray *args[], mxArray *results)
+{
+  auto fcn = mexClass::broadcast_table().find(action);
+  if (!fcn)
     return false;
+
+  // create the tasks (MATLAB thread)
+  std::vector<mexBroadcastTask> tasks(nobjs);
+  for (mwIndex k = 0; k < nobjs; ++k)
+  {
+    try
+    {
+      tasks[k] = (targets[k]->*fcn)(nargs, args);
+    }
+    catch (mexRuntimeError &e)
+    {
+      throw mexRuntimeError(e.id(), "Broadcast on object #" + std::to_string(k + 1) + " failed: " + e.what());
+    }
+  }
+
+  // compute in parallel (worker threads), keeping the error of each object
+  std::vector<std::string> errors(nobjs);
+  std::vector<char> failed(nobjs, 0);
+  mexThreadPool::instance().parallel_for(0, nobjs, [&tasks, &errors, &failed](std::size_t k) {
+    try
+    {
+      if (tasks[k].compute)
+        tasks[k].compute();
+    }
+    catch (std::exception &e)
+    {
+      failed[k] = 1;
+      errors[k] = e.what();
+    }
+    catch (...)
+    {
+      failed[k] = 1;
+      errors[k] = "unknown exception";
+    }
+  });
+  for (mwIndex k = 0; k < nobjs; ++k)
+    if (failed[k])
+      throw mexRuntimeError("broadcast:failedAction", "Broadcast on object #" + std::to_string(k + 1) + " failed: " + errors[k]);
+
+  // collect the results (MATLAB thread)
+  for (mwIndex k = 0; k < nobjs; ++k)
+  {
+    mxArray *rval = tasks[k].result ? tasks[k].result() : NULL;
+    if (results)
+      mxSetCell(results, k, rval);
+    else if (rval)
+      mxDestroyArray(rval);
+  }
+  return true;
+}
+
+/**
+ * \brief Get an element of a MATLAB object array as a scalar object
+ * 
+ * The C API has no element access for objects, so the element is indexed by MATLAB via
+ * `builtin('subsref',objs,substruct('()',{k+1}))` (bypassing overloaded indexing).
+ * 
+ * \returns new mxArray to be destroyed by the caller
+ * \throws mexRuntimeError if MATLAB fails to index the array
+ */
+inline mxArray *mexObjectHandlerElement(const mxArray *objs, mwIndex k)
+{
+  const char *fields[] = {"type", "subs"};
+  mxArray *subs = mxCreateStructMatrix(1, 1, 2, fields);
+  mxSetField(subs, 0, "type", mxCreateString("()"));
+  mxArray *index = mxCreateCellMatrix(1, 1);
+  mxSetCell(index, 0, mxCreateDoubleScalar((double)(k + 1)));
+  mxSetField(subs, 0, "subs", index);
+  mxArray *name = mxCreateString("subsref");
+  mxArray *prhs[] = {name, (mxArray *)objs, subs};
+  mxArray *elem = NULL;
+  mxArray *error = mexCallMATLABWithTrap(1, &elem, 3, prhs, "builtin");
+  mxDestroyArray(name);
+  mxDestroyArray(subs);
+  if (error)
+  {
+    mxDestroyArray(error);
+    throw mexRuntimeError("broadcast:invalidObject", "Failed to index object #" + std::to_string(k + 1) + " of the array.");
+  }
+  return elem;
+}
+
+/**
+ * \brief Run an action on every object of a MATLAB object array in a single MEX call
+ * 
+ * Implements the built-in `broadcast` static action of mexObjectHandler:
+ * 
+ *    mexfcn('broadcast',objs,'action',arg1,arg2,...)
+ *    results = mexfcn('broadcast',objs,'action',arg1,arg2,...)
+ * 
+ * where `objs` is an array of the MATLAB class objects and `results` is a cell array of the
+ * same size containing the output of the action for each object (or empty if none).
+ * 
+ * The handles of all objects are validated before any action is performed. If the action is
+ * found in the optional `broadcast_table()` of mexClass, the tasks are first created for all
+ * objects on the MATLAB thread, then their compute parts are run in parallel on \ref mexThreadPool,
+ * and last their results are collected on the MATLAB thread. Any other action is performed on
+ * the objects one by one, receiving the array element as its MATLAB object (`mxObj`).
+ * 
+ * Every object is busy (see mexObjectHandle::action_scope) for the whole broadcast: an object
+ * busy with another action is rejected like in mexObjectHandlerAction(), and an object deleted
+ * by a MATLAB callback during the broadcast is destructed only after it.
+ * 
+ * \param[in]    class_name Name of the MATLAB class
+ * \param[in]    nlhs       Number of expected output mxArrays
+ * \param[inout] plhs       Array of pointers to the expected output mxArrays
+ * \param[in]    nrhs       Number of input mxArrays
+ * \param[in]    prhs       Array of pointers to the input mxArrays: prhs[0] is the object array and prhs[1] the action
+ */
+template <class mexClass>
+void mexObjectHandlerBroadcast(const std::string &class_name, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  if (nlhs > 1 || nrhs < 2 || !mxIsClass(prhs[0], class_name.c_str()) || !mxIsChar(prhs[1]))
+    throw mexRuntimeError("broadcast:invalidArguments", "Broadcast action takes an object array and an action name followed by its arguments, and returns up to one output.");
+  const mxArray *objs = prhs[0];
+  const mxArray *action = prhs[1];
+  int nargs = nrhs - 2;
+  const mxArray **args = prhs + 2;
+  if (mexIsStringEqual(action, "delete") || mexIsStringEqual(action, "batch") || mexIsStringEqual(action, "clone"))
+    throw mexRuntimeError("broadcast:invalidAction", "delete, batch, and clone actions cannot be broadcast.");
+
+  // resolve all the objects first
+  typedef mexObjectHandle<mexClass> handle_type;
+  mwSize nobjs = mxGetNumberOfElements(objs);
+  std::vector<handle_type *, mexScratchAllocator<handle_type *>> handles(nobjs);
+  try
+  {
+    handle_type::getHandles(objs, handles.begin());
+  }
+  catch (mexRuntimeError &e)
+  {
+    throw mexRuntimeError(e.id(), std::string("Broadcast object array is invalid: ") + e.what());
+  }
+
+  // the same object may not be processed concurrently
+  {
+    std::vector<handle_type *, mexScratchAllocator<handle_type *>> sorted(handles);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+      throw mexRuntimeError("broadcast:duplicateObject", "Object array contains the same object more than once.");
+  }
+
+  // keep every object busy for the whole broadcast, as mexObjectHandlerAction() does
+  std::deque<typename handle_type::action_scope> scopes;
+  std::vector<mexClass *, mexScratchAllocator<mexClass *>> targets(nobjs);
+  for (mwIndex k = 0; k < nobjs; ++k)
+  {
+    scopes.emplace_back(handles[k]);
+    if (scopes.back().reentered() && !mexAllowsReentrantActions<mexClass>::value)
+      throw mexRuntimeError("reentrantAction", "Broadcast object #" + std::to_string(k + 1) + " is busy with another of its actions (e.g., from a MATLAB callback).");
+    targets[k] = &scopes.back().object();
+  }
+
+  mxArray *results = nlhs > 0 ? mxCreateCellArray(mxGetNumberOfDimensions(objs), mxGetDimensions(objs)) : NULL;
+  try
+  {
+    if (!mexObjectHandlerBroadcastTasks(mexHasBroadcastTable<mexClass>(), targets.data(), nobjs, action, nargs, args, results))
+    {
+      // not a broadcast action: run it sequentially (an action may call back into MATLAB)
+      for (mwIndex k = 0; k < nobjs; ++k)
+      {
+        mxArray *out = NULL;
+        mxArray *elem = NULL;
+        try
+        {
+          if (scopes[k].deleted())
+            throw mexRuntimeError("invalidMexObjectHandle", "Object was deleted during the broadcast.");
+          elem = nobjs > 1 ? mexObjectHandlerElement(objs, k) : NULL;
+          if (!mexActionDispatcher<mexClass>::action(*targets[k], elem ? elem : objs, action, results ? 1 : 0, &out, nargs, args))
+            throw mexRuntimeError("unknownAction", std::string("Unknown action: ") + mexGetString(action));
+          if (elem)
+            mxDestroyArray(elem);
+        }
+        catch (mexRuntimeError &e)
+        {
+          if (elem)
+            mxDestroyArray(elem);
+          throw mexRuntimeError(e.id(), "Broadcast on object #" + std::to_string(k + 1) + " failed: " + e.what());
+        }
+        catch (std::exception &e)
+        {
+          if (elem)
+            mxDestroyArray(elem);
+          throw mexRuntimeError("broadcast:failedAction", "Broadcast on object #" + std::to_string(k + 1) + " failed: " + e.what());
+        }
+        if (results)
+          mxSetCell(results, k, out);
+      }
+    }
+  }
+  catch (...)
+  {
+    if (results)
+      mxDestroyArray(results);
+    throw;
+  }
+
+  if (results)
+    plhs[0] = results;
+}
+
+/**
+ * \brief Return or reset the call statistics of mexClass
+ * 
+ * Implements the built-in `__stats` and `__resetStats` static actions of mexObjectHandler:
+ * 
+ *    s = mexfcn('__stats')
+ *    mexfcn('__resetStats')
+ * 
+ * The statistics are collected only if MEXUTILS_ENABLE_STATS is defined (see mexStats.h).
+ */
+template <class mexClass>
+void mexObjectHandlerStats(bool reset, int nlhs, mxArray *plhs[], int nrhs)
+{
+  if (nrhs != 0 || nlhs > (reset ? 0 : 1))
+    throw mexRuntimeError("stats:invalidArguments", "__stats takes no argument and returns up to one output; __resetStats takes no argument and returns none.");
+#ifdef MEXUTILS_ENABLE_STATS
+  if (reset)
+    mexClassStats<mexClass>::instance().reset();
+  else
+    plhs[0] = mexClassStats<mexClass>::instance().to_mxarray();
 #else
-    // **UNCHECKED** http://renatocunha.com/blog/2015/12/msync-pointer-validity/
-    /* get the page size */
-    size_t page_size = sysconf(_SC_PAGESIZE);
-    /* find the address of the page that contains p */
-    void *base = (void *)((((size_t)lpAddress) / page_size) * page_size);
-    /* call msync, if it returns non-zero, return false */
-    return msync(base, page_size, MS_ASYNC) == 0;
+  (void)plhs;
+  throw mexRuntimeError("stats:notEnabled", "Call statistics are collected only if MEXUTILS_ENABLE_STATS is defined.");
 #endif
+}
+
+/**
+ * \brief List or destroy the live objects of mexClass
+ * 
+ * Implements the built-in `__objects` and `__purge` static actions of mexObjectHandler:
+ * 
+ *    handles = mexfcn('__objects')
+ *    n = mexfcn('__purge')
+ *    n = mexfcn('__purge',handles)
+ * 
+ * where `handles` is a uint64 column vector of the handles of the live objects, including
+ * the leaked ones whose MATLAB objects were cleared without deleting them. `__purge` destroys
+ * all the live objects (or those in `handles`, skipping invalid and stale ones) and returns
+ * their number. Each destroyed object releases its lock on the MEX function. A MATLAB object
+ * of a purged object is left with a stale backend, whose actions (including delete) fail
+ * with the invalidMexObjectHandle error.
+ */
+template <class mexClass>
+void mexObjectHandlerObjects(bool purge, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  if (nlhs > 1 || nrhs > (purge ? 1 : 0))
+    throw mexRuntimeError("objects:invalidArguments", "__objects takes no argument, __purge takes up to one (handles), and both return up to one output.");
+
+  std::vector<uint64_t> ids;
+  if (nrhs == 0)
+    ids = mexObjectHandle<mexClass>::handles();
+  else if (mxGetClassID(prhs[0]) == mxUINT64_CLASS && !mxIsComplex(prhs[0]))
+    ids.assign((const uint64_t *)mxGetData(prhs[0]), (const uint64_t *)mxGetData(prhs[0]) + mxGetNumberOfElements(prhs[0]));
+  else
+    throw mexRuntimeError("objects:invalidArguments", "Handles must be given as a uint64 array.");
+
+  if (!purge)
+  {
+    plhs[0] = mxCreateNumericMatrix(ids.size(), 1, mxUINT64_CLASS, mxREAL);
+    if (!ids.empty())
+      std::memcpy(mxGetData(plhs[0]), ids.data(), ids.size() * sizeof(uint64_t));
+    return;
+  }
+
+  std::size_t n = 0;
+  for (uint64_t id : ids)
+    n += mexObjectHandle<mexClass>::destroyHandle(id);
+  if (nlhs > 0)
+    plhs[0] = mxCreateDoubleScalar((double)n);
+}
+
+/**
+ * \brief Change the number of worker threads of the module thread pool
+ * 
+ * Implements the built-in `setNumThreads` static action of mexObjectHandler:
+ * 
+ *    mexfcn('setNumThreads',n)
+ *    nprev = mexfcn('setNumThreads',n)
+ * 
+ * where n is a non-negative integer up to mexThreadPool::max_num_threads() (0 for the number
+ * of hardware threads) and nprev is the previous number of threads. The number can only be
+ * changed while no task of the pool is queued or running, e.g., no background job started by
+ * `start` is unfinished; otherwise the call fails with the `setNumThreads:busy` error.
+ */
+inline void mexObjectHandlerSetNumThreads(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  if (nlhs > 1 || nrhs != 1 || !mxIsNumeric(prhs[0]) || !mxIsScalar(prhs[0]) || mxIsComplex(prhs[0]))
+    throw mexRuntimeError("setNumThreads:invalidArguments", "setNumThreads action takes one numeric scalar and returns up to one output.");
+  double val = mxGetScalar(prhs[0]);
+  if (!(val >= 0.0) || val != std::floor(val)) // also rejects NaN
+    throw mexRuntimeError("setNumThreads:invalidArguments", "Number of threads must be a non-negative integer.");
+  if (val > (double)mexThreadPool::max_num_threads())
+    throw mexRuntimeError("setNumThreads:invalidArguments", "Number of threads must not exceed " + std::to_string(mexThreadPool::max_num_threads()) + ".");
+
+  mexThreadPool &pool = mexThreadPool::instance();
+  std::size_t nprev = pool.num_threads();
+  if (!pool.set_num_threads((std::size_t)val))
+    throw mexRuntimeError("setNumThreads:busy", "Number of threads cannot be changed while tasks (e.g., background jobs) are queued or running.");
+  if (nlhs > 0)
+    plhs[0] = mxCreateDoubleScalar((double)nprev);
+}
+
+/**
+ * \brief Clone the wrapped C++ object
+ * 
+ * Implements the built-in `clone` action of mexObjectHandler:
+ * 
+ *    backend = mexfcn(obj,'clone')
+ * 
+ * which returns the handle of a copy of the C++ object, to be set as the `backend` of a new
+ * MATLAB object (see copyElement of mexcpp.BaseClass). The copy is made with the copy
+ * constructor of mexClass, so the action is only available if mexClass is copy-constructible.
+ * 
+ * \param[in]    backend mxArray containing the handle to the wrapped C++ object
+ * \param[in]    nlhs    Number of expected output mxArrays
+ * \param[inout] plhs    Array of pointers to the expected output mxArrays
+ * \param[in]    nrhs    Number of input mxArrays
+ */
+template <class mexClass>
+void mexObjectHandlerClone(std::false_type, const mxArray *, int, mxArray *[], int)
+{
+  throw mexRuntimeError("clone:notSupported", "C++ class is not copy-constructible.");
+}
+template <class mexClass>
+void mexObjectHandlerClone(std::true_type, const mxArray *backend, int nlhs, mxArray *plhs[], int nrhs)
+{
+  if (nlhs > 1 || nrhs != 0)
+    throw mexRuntimeError("clone:invalidArguments", "Clone action takes no argument and returns the new backend.");
+  plhs[0] = mexObjectHandle<mexClass>::clone(backend);
+}
+
+/**
+ * \brief Error ids of mexObjectHandler for a wrapped class
+ * 
+ * The MATLAB class name and the id prefixes are built once on first use, so that neither
+ * a successful call nor a failing one builds any string. An error is reported with the id
+ * `<prefix><id>`, whose prefix depends on the stage of the call where it was thrown:
+ * 
+ * * `name:` while validating the call or creating the object,
+ * * `name:mex:` in an object action, and
+ * * `name:mex:static:` in a static action.
+ * 
+ * Ids already starting with `name:` (e.g., built with get_classname()) are not prefixed again,
+ * and a mexRuntimeError without id is given the default id of its stage (`failedCall`,
+ * `failedConstruction`, `failedAction`, or `executionFailed`). A std::exception gets the same
+ * default id, except in an object action, where its id is `name:failedAction` (without `mex:`)
+ * as in earlier releases. Ids are truncated to mexRuntimeError::max_id_length characters.
+ */
+template <class mexClass>
+class mexClassErrorIds
+{
+public:
+  enum scope
+  {
+    call,    // validation of the mexFunction arguments
+    create,  // construction of the C++ object
+    object,  // object action
+    statics, // static action
+  };
+
+  /**
+   * \brief Error ids of mexClass
+   */
+  static const mexClassErrorIds &instance()
+  {
+    static const mexClassErrorIds ids;
+    return ids;
+  }
+
+  /**
+   * \brief Name of the MATLAB class (mexClass::get_classname())
+   */
+  const std::string &name() const { return name_m; }
+
+  /**
+   * \brief Report an error to MATLAB with mexErrMsgIdAndTxt()
+   * 
+   * The full id is composed in a stack buffer, with any '.' (of the package names) replaced by ':'.
+   * 
+   * \param[in] where   Stage of the call where the error was thrown
+   * \param[in] id      Error id (may be empty)
+   * \param[in] message Error message
+   */
+  void report(scope where, const char *id, const char *message) const
+  {
+    static const char *const defaults[] = {"failedCall", "failedConstruction", "failedAction", "executionFailed"};
+    if (!*id)
+      id = defaults[where];
+
+    char buf[2 * (mexRuntimeError::max_id_length + 1)];
+    std::size_t n = 0;
+    if (std::strncmp(id, name_m.c_str(), name_m.size()) || id[name_m.size()] != ':') // not qualified yet
+      for (const char *c = prefix_m[where].c_str(); *c; ++c)
+        buf[n++] = *c == '.' ? ':' : *c;
+    for (; *id && n < sizeof(buf) - 1; ++id)
+      buf[n++] = *id == '.' ? ':' : *id;
+    buf[n] = '\0';
+
+    mexErrMsgIdAndTxt(buf, "%s", message);
+  }
+
+  /**
+   * \brief Report a std::exception (without id) to MATLAB with mexErrMsgIdAndTxt()
+   * 
+   * \param[in] where   Stage of the call where the exception was thrown
+   * \param[in] message Error message
+   */
+  void report_exception(scope where, const char *message) const
+  {
+    if (where == object)
+      report(call, "failedAction", message); // name:failedAction
+    else
+      report(where, "", message);
+  }
+
+private:
+  std::string name_m;      // MATLAB class name
+  std::string prefix_m[4]; // id prefix of each scope
+
+  mexClassErrorIds() : name_m(mexClass::get_classname())
+  {
+    prefix_m[call] = prefix_m[create] = name_m + ":";
+    prefix_m[object] = name_m + ":mex:";
+    prefix_m[statics] = name_m + ":mex:static:";
+    for (auto &prefix : prefix_m) // leave room for the ids
+      if (prefix.size() > mexRuntimeError::max_id_length)
+        prefix.resize(mexRuntimeError::max_id_length);
+  }
+};
+
+/**
+ * \brief Run an object action on behalf of mexObjectHandler
+ * 
+ * Performs the `delete` action or dispatches any other action to the wrapped C++ object.
+ * Errors are propagated as thrown; mexObjectHandler prefixes their ids (see mexClassErrorIds).
+ * 
+ * An action may call back into MATLAB (see mexMatlabCallback.h), which may in turn call the
+ * MEX function again. While an action is in progress, `delete` of its object is deferred
+ * until the action returns (the handle is invalidated at once), and any other action on the
+ * object is rejected with the id `reentrantAction` unless mexClass defines
+ * `static const bool reentrant_actions = true` (see mexAllowsReentrantActions).
+ * 
+ * \param[in]    mxObj      Associated MATLAB class object
+ * \param[in]    backend    mxArray containing the handle to the wrapped C++ object
+ * \param[in]    nlhs       Number of expected output mxArrays
+ * \param[inout] plhs       Array of pointers to the expected output mxArrays
+ * \param[in]    nrhs       Number of input mxArrays, including the action name
+ * \param[in]    prhs       Array of pointers to the input mxArrays. prhs[0] is the action name.
+ */
+template <class mexClass>
+void mexObjectHandlerAction(const mxArray *mxObj, const mxArray *backend, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+  // check for the delete action (throws exception if invalid, deferred if the object is busy)
+  if (mexIsStringEqual(prhs[0], "delete"))
+  {
+    mexObjectHandle<mexClass>::_destroy(backend);
+
+    // clear the backend property so the stale handle is never reused
+    mxArray *empty = mxCreateNumericMatrix(0, 0, mxUINT64_CLASS, mxREAL);
+    mxSetProperty((mxArray *)mxObj, 0, "backend", empty);
+    mxDestroyArray(empty);
+    return;
+  }
+
+  // get the C++ object (throws exception if invalid), busy until the action returns
+  typename mexObjectHandle<mexClass>::action_scope scope(backend);
+  if (scope.reentered() && !mexAllowsReentrantActions<mexClass>::value)
+    throw mexRuntimeError("reentrantAction", "Action called on an object while another of its actions is in progress (e.g., from a MATLAB callback).");
+  mexClass &obj = scope.object();
+
+  if (mexIsStringEqual(prhs[0], "batch"))
+  {
+    mexObjectHandlerBatch<mexClass>(obj, mxObj, nlhs, plhs, nrhs - 1, prhs + 1);
   }
-};
+  else if (mexIsStringEqual(prhs[0], "clone"))
+  {
+    mexObjectHandlerClone<mexClass>(std::is_copy_constructible<mexClass>(), backend, nlhs, plhs, nrhs - 1);
+  }
+  else if (!mexActionDispatcher<mexClass>::action(obj, mxObj, prhs[0], nlhs, plhs, nrhs - 1, prhs + 1))
+  {
+    throw mexRuntimeError("unknownAction", std::string("Unknown action: ") + mexGetString(prhs[0]));
+  }
+}
 
 /**
  * \brief Function to implement MATLAB class' C++ interface member function
@@ -222,9 +1262,56 @@ private:
  * * mexfcn(obj,'action',varargin) - Perform an action
  * * mexfcn('action',varargin)     - Perform a static action
  * 
+ * The object action `batch` is reserved to run multiple actions in a single call
+ * (see \ref mexObjectHandlerBatch):
+ * 
+ * * results = mexfcn(obj,'batch',{{'action1',args1...},{'action2',args2...},...},nargouts)
+ * 
+ * The object action `clone` is reserved to copy-construct the C++ object of a copy-constructible
+ * mexClass into a new backend (see \ref mexObjectHandlerClone):
+ * 
+ * * backend = mexfcn(obj,'clone')
+ * 
+ * The static action `setNumThreads` is reserved to set the number of worker threads of
+ * \ref mexThreadPool shared by all the objects of the module:
+ * 
+ * * mexfcn('setNumThreads',n)
+ * 
+ * The static action `broadcast` is reserved to perform an action on every object of an
+ * object array in a single call (see \ref mexObjectHandlerBroadcast):
+ * 
+ * * results = mexfcn('broadcast',objs,'action',varargin)
+ * 
+ * The static actions `__stats` and `__resetStats` are reserved to return and reset the call
+ * statistics of mexClass, collected if MEXUTILS_ENABLE_STATS is defined (see mexStats.h):
+ * 
+ * * s = mexfcn('__stats')
+ * * mexfcn('__resetStats')
+ * 
+ * The static actions `__objects` and `__purge` are reserved to list and destroy the live
+ * objects of mexClass, e.g., those leaked by MATLAB objects cleared without deleting them
+ * (see \ref mexObjectHandlerObjects):
+ * 
+ * * handles = mexfcn('__objects')
+ * * n = mexfcn('__purge') or n = mexfcn('__purge',handles)
+ * 
+ * Operations deferred to the MATLAB thread by worker threads (see mexMatlabQueue.h) are run
+ * on every entry to this function. The static action `flush` is reserved to only do so:
+ * 
+ * * mexfcn('flush')
+ * 
  * Note that all non-static action signature receives the MATLAB object, enabling the C++ class
  * object to interact with MATLAB class object as needed.
  * 
+ * Additionally, an action can be called with the fast-path signature:
+ * 
+ * * mexfcn(obj.backend,obj,'action',varargin) - Perform an action
+ * 
+ * Passing the `backend` property value directly saves mxGetProperty() call, which
+ * deep-copies the property value, on every action call. The handle itself is always
+ * validated. In debug builds (NDEBUG not defined), it is also checked against the
+ * `backend` property of `obj`.
+ * 
  * The template class `mexClass` must either inherit \ref mexSetGetClass or match its public 
  * member function syntax to be compatible with this function. Three member functions it must 
  * provide must have the signatures:
@@ -239,42 +1326,109 @@ private:
  *    constructor(const mxArray *mxObj, int nrhs, const mxArray *prhs[]);
  * 
  * where nrhs & prhs accounts for `varargin` inputs of the create-new mexFunction call.
+ * 
+ * Optionally, `mexClass` may define constant-time dispatch tables (see mexActionTable.h):
+ * 
+ * * static const mexActionTable<mexClass> &action_table();
+ * * static const mexStaticActionTable &static_action_table();
+ * * static const mexBroadcastTable<mexClass> &broadcast_table();
+ * 
+ * Actions found in these tables are dispatched without converting the action name to
+ * std::string. Broadcast table actions are also available as regular object actions. If a
+ * table is defined, static_handler() becomes optional, and actions not found in the tables
+ * are still passed to action_handler() and static_handler().
+ * `action_table()` is used only if declared by mexClass itself (not inherited), see
+ * mexActionDispatcher.
+ * 
+ * Exceptions are reported to MATLAB with mexErrMsgIdAndTxt(), with their ids prefixed as
+ * described in \ref mexClassErrorIds.
+ * 
+ * Each call is run in a \ref mexScratchScope. Actions may obtain temporary memory from
+ * mexScratchArena::instance() (or via mexScratchAllocator), which is released in O(1)
+ * when the call returns or fails.
  */
 template <class mexClass>
 void mexObjectHandler(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
 {
-  std::string class_name = mexClass::get_classname(); // should match the associated matlab class
+  typedef mexClassErrorIds<mexClass> error_ids;
+  mexScratchScope scratch; // releases the temporary memory of the actions
+  const error_ids &ids = error_ids::instance();
+  const std::string &class_name = ids.name(); // should match the associated matlab class
+  typename error_ids::scope scope = error_ids::call; // stage of the call, selects the error id prefix
+  typedef mexClassStats<mexClass> stats_type;
+  mexStatsCall<mexClass> stats; // times the call if MEXUTILS_ENABLE_STATS is defined
 
   try
   {
+    // run the MATLAB API calls deferred by the worker threads
+    mexMatlabQueue &deferred = mexMatlabQueue::instance();
+    if (!deferred.empty())
+      deferred.drain();
+
     if (nrhs < 1)
-      throw mexRuntimeError(class_name + ":mex:invalidInput", "Needs at least one input argument.");
+      throw mexRuntimeError("mex:invalidInput", "Needs at least one input argument.");
+
+    if (mxGetClassID(prhs[0]) == mxUINT64_CLASS) // fast-path action: mexfcn(obj.backend, obj, 'action', varargin)
+    {
+      if (nrhs < 3 || !mxIsChar(prhs[2]))
+        throw mexRuntimeError("missingAction", "Third argument (action) is not a string.");
+
+#ifndef NDEBUG
+      // make sure the given backend belongs to the given MATLAB object
+      if (!mxIsClass(prhs[1], class_name.c_str()))
+        throw mexRuntimeError("invalidBackend", "Second argument must be the MATLAB object of the given backend.");
+      mxArray *backend = mxGetProperty(prhs[1], 0, "backend");
+      bool matched = backend && mxGetClassID(backend) == mxUINT64_CLASS && mxGetNumberOfElements(backend) == 1 &&
+                     mxGetNumberOfElements(prhs[0]) == 1 && *(uint64_t *)mxGetData(backend) == *(uint64_t *)mxGetData(prhs[0]);
+      if (backend)
+        mxDestroyArray(backend);
+      if (!matched)
+        throw mexRuntimeError("invalidBackend", "First argument does not match the backend property of the MATLAB object.");
+#else
+      // delete clears the backend property of the MATLAB object, so it must be one
+      if (mexIsStringEqual(prhs[2], "delete") && !mxIsClass(prhs[1], class_name.c_str()))
+        throw mexRuntimeError("invalidBackend", "Second argument must be the MATLAB object of the given backend.");
+#endif
+      stats.lookup_done();
 
-    if (!mxIsClass(prhs[0], class_name.c_str())) // static action
+      scope = error_ids::object;
+      stats.action(stats_type::object, prhs[2]);
+      mexObjectHandlerAction<mexClass>(prhs[1], prhs[0], nlhs, plhs, nrhs - 2, prhs + 2);
+    }
+    else if (!mxIsClass(prhs[0], class_name.c_str())) // static action
     {
+      scope = error_ids::statics;
       if (!mxIsChar(prhs[0]))
-        throw mexRuntimeError(class_name + ":mex:static:functionUndefined", "Static action name not given.");
-      try
+        throw mexRuntimeError("functionUndefined", "Static action name not given.");
+      stats.action(stats_type::statics, prhs[0]);
+
+      if (mexIsStringEqual(prhs[0], "broadcast"))
       {
-        std::string action = mexGetString(prhs[0]);
-        if (!mexClass::static_handler(action, nlhs, plhs, nrhs - 1, prhs + 1))
-        {
-          std::string msg("Unknown static action: ");
-          msg += action;
-          throw mexRuntimeError(class_name + ":mex:static:unknownFunction", msg);
-        }
+        mexObjectHandlerBroadcast<mexClass>(class_name, nlhs, plhs, nrhs - 1, prhs + 1);
       }
-      catch (mexRuntimeError &e)
+      else if (mexIsStringEqual(prhs[0], "setNumThreads"))
       {
-        std::string id = e.id();
-        if (id.empty()) // no id given
-          throw mexRuntimeError(class_name + ":mex:static:executionFailed", e.what());
-        else
-          throw mexRuntimeError(class_name + ":mex:static:" + e.id(), e.what());
+        mexObjectHandlerSetNumThreads(nlhs, plhs, nrhs - 1, prhs + 1);
       }
-      catch (std::exception &e)
+      else if (mexIsStringEqual(prhs[0], "__stats") || mexIsStringEqual(prhs[0], "__resetStats"))
       {
-        throw mexRuntimeError(class_name + ":mex:static:executionFailed", e.what());
+        mexObjectHandlerStats<mexClass>(mexIsStringEqual(prhs[0], "__resetStats"), nlhs, plhs, nrhs - 1);
+      }
+      else if (mexIsStringEqual(prhs[0], "__objects") || mexIsStringEqual(prhs[0], "__purge"))
+      {
+        mexObjectHandlerObjects<mexClass>(mexIsStringEqual(prhs[0], "__purge"), nlhs, plhs, nrhs - 1, prhs + 1);
+      }
+      else if (mexIsStringEqual(prhs[0], "flush"))
+      {
+        if (nlhs > 1 || nrhs != 1)
+          throw mexRuntimeError("flush:invalidArguments", "flush action takes no argument and returns up to one output.");
+        std::size_t n = mexMatlabQueue::instance().drain(); // also drained on entry; catch up with ops posted since
+        if (nlhs > 0)
+          plhs[0] = mxCreateDoubleScalar((double)n);
+      }
+      else if (!mexActionDispatcher<mexClass>::static_action(prhs[0], nlhs, plhs, nrhs - 1, prhs + 1))
+      {
+        throw mexRuntimeError("unknownFunction", std::string("Unknown static action: ") + mexGetString(prhs[0]));
       }
     }
     else
@@ -282,64 +1436,42 @@ void mexObjectHandler(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]
       // attempt to convert the first argument to the object
       mxArray *backend = mxGetProperty(prhs[0], 0, "backend");
       if (!backend)
-        throw mexRuntimeError(class_name + ":unsupportedClass", "MATLAB class must have backend'' property.");
+        throw mexRuntimeError("unsupportedClass", "MATLAB class must have backend'' property.");
+      stats.lookup_done();
       if (mxIsEmpty(backend))
       {
         // no backend object, create a new
         if (nlhs > 1)
-          throw mexRuntimeError(class_name + ":tooManyOutputArguments", "Only one argument is returned for object construction.");
+          throw mexRuntimeError("tooManyOutputArguments", "Only one argument is returned for object construction.");
 
         // set backend with the pointer to the newly created C++ object
+        scope = error_ids::create;
+        stats.action(stats_type::create);
         mxSetProperty((mxArray *)prhs[0], 0, "backend", mexObjectHandle<mexClass>::create(prhs[0], nrhs - 1, prhs + 1));
       }
       else if (nrhs < 2 || !mxIsChar(prhs[1]))
       {
-        throw mexRuntimeError(class_name + ":missingAction", "Second argument (action) is not a string.");
+        throw mexRuntimeError("missingAction", "Second argument (action) is not a string.");
       }
       else
       {
-        // get the action name
-        std::string action = mexGetString(prhs[1]);
-
-        // get the C++ object (throws exception if invalid)
-        mexClass &obj = mexObjectHandle<mexClass>::getObject(backend);
-
-        // check for the delete action
-        if (action == "delete")
-        {
-          mexObjectHandle<mexClass>::destroy(backend);
-        }
-        else // otherwise perform the object-specific (if run_action() is overloaded) action according to the given action
-        {
-          try
-          {
-            if (!obj.action_handler(prhs[0], action, nlhs, plhs, nrhs - 2, prhs + 2))
-            {
-              std::string msg("Unknown action: ");
-              throw mexRuntimeError(class_name + ":unknownAction", msg + action);
-            }
-          }
-          catch (mexRuntimeError &e)
-          {
-            std::string id = e.id();
-            if (id.empty()) // no id given
-              throw mexRuntimeError(class_name + ":mex:failedAction", e.what());
-            else
-              throw mexRuntimeError(class_name + ":mex:" + e.id(), e.what());
-          }
-          catch (std::exception &e)
-          {
-            throw mexRuntimeError(class_name + ":failedAction", e.what());
-          }
-        }
+        scope = error_ids::object;
+        stats.action(stats_type::object, prhs[1]);
+        mexObjectHandlerAction<mexClass>(prhs[0], backend, nlhs, plhs, nrhs - 1, prhs + 1);
       }
     }
   }
   catch (mexRuntimeError &e)
   {
-    std::string id_str = e.id();
-    std::replace(id_str.begin(), id_str.end(), '.', ':'); // replace all 'x' to 'y'
-    mexErrMsgIdAndTxt(id_str.c_str(), e.what());
+    stats.finish(true);
+    scratch.rewind(); // mexErrMsgIdAndTxt() may not unwind the stack
+    ids.report(scope, e.id(), e.what());
+  }
+  catch (std::exception &e)
+  {
+    stats.finish(true);
+    scratch.rewind();
+    ids.report_exception(scope, e.what());
   }
 }
 
@@ -357,12 +1489,49 @@ void mexObjectHandler(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]
  * * data = mexfcn(obj,'save')
  * * mexfcn(obj,'load',data)
  * 
+ * Multiple properties may be accessed in a single call:
+ * 
+ * * [value1,value2,...] = mexfcn(obj,'get',name1,name2,...)
+ * * S = mexfcn(obj,'get',{name1,name2,...}) - S is a struct with the property names as its fields
+ * * mexfcn(obj,'set',name1,value1,name2,value2,...)
+ * * mexfcn(obj,'set',S) - S is a scalar struct with the property names as its fields
+ * 
+ * Long-running work can be run in the background (see mexAsyncJob.h) with 4 more actions:
+ * 
+ * * token = mexfcn(obj,'start',name,varargin) - start the job created by start_job() and return its token
+ * * status = mexfcn(obj,'poll',token)          - 'running', 'done', 'failed', or 'cancelled'
+ * * result = mexfcn(obj,'wait',token,timeout)  - wait (up to timeout seconds if given) and collect the result
+ * * mexfcn(obj,'cancel',token)                 - cancel the job and wait for it to return
+ * 
+ * Outstanding jobs are cancelled before the object is destroyed.
+ * 
+ * For incremental saving (e.g., periodic autosave of a large, mostly static state), the class
+ * tracks which properties are modified since the state was last saved or loaded:
+ * 
+ * * delta = mexfcn(obj,'saveDelta') - save only what changed since the last save/saveDelta/load
+ * * mexfcn(obj,'load',delta)        - apply a delta after loading the preceding saves
+ * 
+ * Properties are marked by the set action, and actions modifying the state otherwise must call
+ * mark_dirty(). The derived class implements save_delta_prop() with is_dirty() (see
+ * mexPropertyClass for struct saves and mexSerialCache of mexSerializer.h for binary saves).
+ * 
  * Note that this class misses the necessary static functions: get_classname() and 
  * static_handler(). They must also be implemented in the derived class.
 */
 class mexSetGetClass
 {
 public:
+  mexSetGetClass() {}
+
+  /**
+ * \brief  Copy constructor for the clone action
+ * 
+ * The background jobs are not copied: the new object starts with none. The new object is
+ * also considered never saved (see is_dirty()).
+ */
+  mexSetGetClass(const mexSetGetClass &) {}
+  virtual ~mexSetGetClass() {}
+
   /**
  * \brief  Perform one of basic class actions
  * 
@@ -372,66 +1541,303 @@ public:
  * \param[inout] plhs   Array of pointers to the expected output mxArrays
  * \param[in]    nrhs   Number of input mxArrays
  * \param[in]    prhs   Array of pointers to the input mxArrays.
+ * \returns false if action is not one of the basic class actions
  */
   virtual bool action_handler(const mxArray *mxObj, const std::string &action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
   {
-    if (action == "set") // (H,"set","name",value)
-    {
-      // check for argument counts
-      if (nlhs != 0 || nrhs != 2)
-        throw mexRuntimeError("set:invalidArguments", "Set action takes 4 input arguments and returns none.");
+    auto fcn = mexSetGetClass::action_table().find(action);
+    if (!fcn) // no matching action found
+      return false;
 
-      // get property name
-      std::string name;
-      try
-      {
-        name = mexGetString(prhs[0]);
-      }
-      catch (...)
+    (this->*fcn)(mxObj, nlhs, plhs, nrhs, prhs);
+    return true;
+  }
+
+  /**
+ * \brief  Dispatch table of the basic class actions
+ * 
+ * A derived class may extend this table with its own actions to let mexObjectHandler
+ * dispatch all of them in constant time:
+ * 
+ *    static const mexActionTable<myClass> &action_table()
+ *    {
+ *      static const mexActionTable<myClass> table(mexSetGetClass::action_table(),
+ *                                                 {{"train", &myClass::train_action}});
+ *      return table;
+ *    }
+ * 
+ * \returns the action table with set, get, save, saveDelta, load, saveToFile, loadFromFile, start,
+ *          poll, wait, and cancel actions
+ */
+  static const mexActionTable<mexSetGetClass> &action_table()
+  {
+    static const mexActionTable<mexSetGetClass> table({{"set", &mexSetGetClass::set_action},
+                                                       {"get", &mexSetGetClass::get_action},
+                                                       {"save", &mexSetGetClass::save_action},
+                                                       {"saveDelta", &mexSetGetClass::save_delta_action},
+                                                       {"load", &mexSetGetClass::load_action},
+                                                       {"saveToFile", &mexSetGetClass::save_to_file_action},
+                                                       {"loadFromFile", &mexSetGetClass::load_from_file_action},
+                                                       {"start", &mexSetGetClass::start_action},
+                                                       {"poll", &mexSetGetClass::poll_action},
+                                                       {"wait", &mexSetGetClass::wait_action},
+                                                       {"cancel", &mexSetGetClass::cancel_action}});
+    return table;
+  }
+
+  /**
+ * \brief  Cancel all background jobs and wait for them
+ * 
+ * Called by mexObjectHandle before the object is destroyed. A derived class whose jobs access
+ * its data should also call it at the beginning of its destructor if the object may be destroyed
+ * otherwise.
+ */
+  void cancel_jobs() { jobs_m.cancel_all(); }
+
+protected:
+  /**
+ * \brief  set action: mexfcn(obj,'set',name1,value1,name2,value2,...) or mexfcn(obj,'set',S)
+ * 
+ * Properties are set in the given order (struct field order for S). If setting a property fails,
+ * the properties preceding it remain set.
+ */
+  void set_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    // check for argument counts
+    if (nlhs != 0)
+      throw mexRuntimeError("set:invalidArguments", "Set action returns none.");
+
+    if (nrhs == 1 && mxIsStruct(prhs[0])) // struct-driven: field names are property names
+    {
+      if (mxGetNumberOfElements(prhs[0]) != 1)
+        throw mexRuntimeError("set:invalidArguments", "Set action's struct argument must be scalar.");
+      int nfields = mxGetNumberOfFields(prhs[0]);
+      for (int i = 0; i < nfields; ++i)
       {
-        throw mexRuntimeError("set:invalidPropName", "Set action's third argument must be a name string.");
+        const char *name = mxGetFieldNameByNumber(prhs[0], i);
+        set_prop(mxObj, name, mxGetFieldByNumber(prhs[0], 0, i));
+        mark_dirty(name);
       }
+      return;
+    }
+
+    if (nrhs < 2 || nrhs % 2)
+      throw mexRuntimeError("set:invalidArguments", "Set action takes name-value pairs or a struct.");
+
+    for (int i = 0; i < nrhs; i += 2)
+    {
+      // get property name (converted in a reused buffer)
+      if (!mexIsString(prhs[i]))
+        throw mexRuntimeError("set:invalidPropName", "Set action's property names must be name strings.");
+      mexBorrowedString name(prhs[i]);
 
       // run the action
-      set_prop(mxObj, name, prhs[1]);
+      set_prop(mxObj, name.str(), prhs[i + 1]);
+      mark_dirty(name.str());
     }
-    else if (action == "get") // value = (H,"get","name")
+  }
+
+  /**
+ * \brief  get action: [value1,value2,...] = mexfcn(obj,'get',name1,name2,...) or S = mexfcn(obj,'get',{name1,name2,...})
+ */
+  void get_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nrhs == 1 && mxIsCell(prhs[0])) // cellstr: return a struct with the names as its fields
     {
-      // check for argument counts
-      if (nlhs != 1 || nrhs != 1)
-        throw mexRuntimeError("get:invalidArguments", "Get action takes 3 input arguments and returns one.");
+      if (nlhs > 1)
+        throw mexRuntimeError("get:invalidArguments", "Get action with a cellstr of names returns one struct.");
 
-      // get property name
-      std::string name;
-      try
-      {
-        name = mexGetString(prhs[0]);
-      }
-      catch (...)
+      mwSize nprops = mxGetNumberOfElements(prhs[0]);
+      std::vector<std::string> names(nprops);
+      std::vector<const char *> fieldnames(nprops);
+      for (mwIndex i = 0; i < nprops; ++i)
       {
-        throw mexRuntimeError("get:invalidPropName", "Get action's third argument must be a name string.");
+        const mxArray *name = mxGetCell(prhs[0], i);
+        if (!name || !mxIsChar(name))
+          throw mexRuntimeError("get:invalidPropName", "Get action's property names must be name strings.");
+        mexGetString(name, names[i]);
+        if (!mxIsValidVariableName(names[i].c_str()))
+          throw mexRuntimeError("get:invalidPropName", "Get action's property name \"" + names[i] + "\" is not a valid struct field name.");
+        fieldnames[i] = names[i].c_str();
       }
 
-      // run the action
-      plhs[0] = get_prop(mxObj, name);
-    }
-    else if (action == "save")
-    {
-      plhs[0] = save_prop(mxObj);
-    }
-    else if (action == "load")
-    {
-      load_prop(mxObj, prhs[0]);
+      // struct field names must be unique
+      std::vector<const char *> sorted(fieldnames);
+      std::sort(sorted.begin(), sorted.end(), [](const char *a, const char *b) { return std::strcmp(a, b) < 0; });
+      auto dup = std::adjacent_find(sorted.begin(), sorted.end(), [](const char *a, const char *b) { return std::strcmp(a, b) == 0; });
+      if (dup != sorted.end())
+        throw mexRuntimeError("get:invalidPropName", std::string("Get action's property name \"") + *dup + "\" is given more than once.");
+
+      mxArray *rval = mxCreateStructMatrix(1, 1, (int)nprops, fieldnames.data());
+      for (mwIndex i = 0; i < nprops; ++i)
+        mxSetFieldByNumber(rval, 0, (int)i, get_prop(mxObj, names[i]));
+      plhs[0] = rval;
+      return;
     }
-    else // no matching action found
+
+    // check for argument counts
+    if (nrhs < 1 || std::max(nlhs, 1) != nrhs)
+      throw mexRuntimeError("get:invalidArguments", "Get action returns one output per property name.");
+
+    for (int i = 0; i < nrhs; ++i)
     {
-      return false;
+      // get property name (converted in a reused buffer)
+      if (!mexIsString(prhs[i]))
+        throw mexRuntimeError("get:invalidPropName", "Get action's property names must be name strings.");
+      mexBorrowedString name(prhs[i]);
+
+      // run the action
+      plhs[i] = get_prop(mxObj, name.str());
     }
+  }
 
-    return true;
+  /**
+ * \brief  save action: data = mexfcn(obj,'save')
+ */
+  void save_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    plhs[0] = save_prop(mxObj);
+    saved_m = generation_m;
+  }
+
+  /**
+ * \brief  saveDelta action: delta = mexfcn(obj,'saveDelta')
+ */
+  void save_delta_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs > 1 || nrhs != 0)
+      throw mexRuntimeError("saveDelta:invalidArguments", "SaveDelta action takes no argument and returns the delta.");
+    plhs[0] = save_delta_prop(mxObj);
+    saved_m = generation_m;
+  }
+
+  /**
+ * \brief  load action: mexfcn(obj,'load',data)
+ */
+  void load_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nrhs != 1)
+      throw mexRuntimeError("load:invalidArguments", "Load action takes 3 input arguments.");
+    load_prop(mxObj, prhs[0]);
+    saved_m = generation_m;
+  }
+
+  /**
+ * \brief  saveToFile action: mexfcn(obj,'saveToFile',filename)
+ */
+  void save_to_file_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs != 0 || nrhs != 1 || !mexIsString(prhs[0]))
+      throw mexRuntimeError("saveToFile:invalidArguments", "SaveToFile action takes a file name and returns none.");
+    save_to_file(mxObj, mexGetString(prhs[0])); // a file is not part of the save/saveDelta chain
+  }
+
+  /**
+ * \brief  loadFromFile action: mexfcn(obj,'loadFromFile',filename)
+ */
+  void load_from_file_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs != 0 || nrhs != 1 || !mexIsString(prhs[0]))
+      throw mexRuntimeError("loadFromFile:invalidArguments", "LoadFromFile action takes a file name and returns none.");
+    load_from_file(mxObj, mexGetString(prhs[0]));
+    mark_dirty(); // the loaded state differs from the last save, and the caches of the previous state are stale
+  }
+
+  /**
+ * \brief  start action: token = mexfcn(obj,'start',name,varargin)
+ */
+  void start_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs > 1 || nrhs < 1 || !mexIsString(prhs[0]))
+      throw mexRuntimeError("start:invalidArguments", "Start action takes a job name followed by its arguments and returns a job token.");
+
+    std::unique_ptr<mexAsyncJob> job = start_job(mxObj, mexBorrowedString(prhs[0]), nrhs - 1, prhs + 1);
+    if (!job)
+      throw mexRuntimeError("start:unknownJob", std::string("Unknown job: ") + mexGetString(prhs[0]));
+
+    mxArray *token = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *(uint64_t *)mxGetData(token) = jobs_m.start(std::move(job));
+    plhs[0] = token;
+  }
+
+  /**
+ * \brief  poll action: status = mexfcn(obj,'poll',token)
+ */
+  void poll_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs > 1 || nrhs != 1)
+      throw mexRuntimeError("poll:invalidArguments", "Poll action takes a job token and returns its status.");
+    plhs[0] = mxCreateString(mexJobTable::status_name(jobs_m.poll(get_job_token(prhs[0]))));
+  }
+
+  /**
+ * \brief  wait action: result = mexfcn(obj,'wait',token) or result = mexfcn(obj,'wait',token,timeout)
+ * 
+ * Throws the error of the job if it failed. If timeout (in seconds) expires before the job finishes,
+ * throws `wait:timeout` error and the job remains running.
+ */
+  void wait_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs > 1 || nrhs < 1 || nrhs > 2 || (nrhs > 1 && !(mxIsNumeric(prhs[1]) && mxIsScalar(prhs[1]))))
+      throw mexRuntimeError("wait:invalidArguments", "Wait action takes a job token and optional timeout and returns the job result.");
+
+    uint64_t token = get_job_token(prhs[0]);
+    if (!jobs_m.wait(token, nrhs > 1 ? mxGetScalar(prhs[1]) : -1.0))
+      throw mexRuntimeError("wait:timeout", "Job did not finish within the timeout.");
+
+    mxArray *rval = jobs_m.collect(token);
+    if (nlhs > 0)
+      plhs[0] = rval ? rval : mxCreateDoubleMatrix(0, 0, mxREAL);
+    else if (rval)
+      mxDestroyArray(rval);
+  }
+
+  /**
+ * \brief  cancel action: mexfcn(obj,'cancel',token)
+ */
+  void cancel_action(const mxArray *mxObj, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs != 0 || nrhs != 1)
+      throw mexRuntimeError("cancel:invalidArguments", "Cancel action takes a job token and returns none.");
+    jobs_m.cancel(get_job_token(prhs[0]));
+  }
+
+  /**
+ * \brief  Create a background job
+ * 
+ * Override to support the start action. The arguments should be validated and copied to the job
+ * here as mxArrays cannot be accessed from the worker thread.
+ * 
+ * \param[in]    mxObj  Associated MATLAB class object
+ * \param[in]    name   Name of the job
+ * \param[in]    nrhs   Number of input mxArrays
+ * \param[in]    prhs   Array of pointers to the input mxArrays
+ * \returns the new job or nullptr if name is unknown
+ */
+  virtual std::unique_ptr<mexAsyncJob> start_job(const mxArray *mxObj, const std::string &name, int nrhs, const mxArray *prhs[]) { return nullptr; }
+
+  /**
+ * \brief  Export a mexVector property value to MATLAB
+ * 
+ * Helper for get_prop() implementations. With \p release set, the buffer of \p value is
+ * handed over to the returned mxArray in O(1) and \p value is left empty (use it for values
+ * computed on demand). Otherwise, the elements are copied.
+ * 
+ * \param[in] value   Property value
+ * \param[in] release True to move the buffer out of \p value instead of copying
+ * \returns mxArray column vector containing the elements of \p value
+ */
+  template <typename T>
+  static mxArray *export_prop(mexVector<T> &value, bool release = false)
+  {
+    return release ? value.release_mxArray() : value.to_mxArray();
+  }
+  template <typename T>
+  static mxArray *export_prop(const mexVector<T> &value)
+  {
+    return value.to_mxArray();
   }
 
-protected:
   /**
  * \brief  Set a property value
  * 
@@ -453,11 +1859,93 @@ protected:
   /**
  * \brief  Save C++ object's data
  * 
+ * For a compact result, serialize the object to a single uint8 mxArray with mexSerialize()
+ * of mexSerializer.h (and restore it with mexDeserialize() in load_prop()).
+ * 
  * \param[in]    mxObj  Associated MATLAB class object
  * \returns mxArray containing the C++ object states
  */
   virtual mxArray *save_prop(const mxArray *mxObj) { return NULL; };
 
+  /**
+ * \brief  Save the C++ object's data modified since the last save
+ * 
+ * Override to support incremental saves: return only the data for which is_dirty() is true,
+ * in a form that load_prop() applies on top of the previously loaded data. By default, all the
+ * data are saved with save_prop().
+ * 
+ * \param[in]    mxObj  Associated MATLAB class object
+ * \returns mxArray containing the modified C++ object states
+ */
+  virtual mxArray *save_delta_prop(const mxArray *mxObj) { return save_prop(mxObj); }
+
+  /**
+ * \brief  Mark a property (or any named part of the state) as modified
+ * 
+ * Called by the set action for each property set. Call it from the actions modifying the state.
+ * 
+ * \param[in]    name   Name of the property
+ */
+  void mark_dirty(const char *name)
+  {
+    int idx = dirty_index(name);
+    if (idx < 0)
+    {
+      modified_m[name] = ++generation_m;
+      return;
+    }
+    if ((std::size_t)idx >= indexed_m.size())
+      indexed_m.resize(idx + 1, 0); // once per object
+    indexed_m[idx] = ++generation_m;
+  }
+  void mark_dirty(const std::string &name) { mark_dirty(name.c_str()); }
+
+  /**
+ * \brief  Mark the whole state as modified
+ */
+  void mark_dirty()
+  {
+    modified_m.clear();
+    indexed_m.assign(indexed_m.size(), 0);
+    all_modified_m = ++generation_m;
+  }
+
+  /**
+ * \brief  Check if a property is modified since the last save, saveDelta, or load
+ * 
+ * All properties of a new object are modified, and so are they after a loadFromFile. A load
+ * leaves them all unmodified; saveToFile does not change them.
+ * 
+ * \param[in]    name   Name of the property
+ */
+  bool is_dirty(const char *name) const { return modified_generation(name) > saved_m; }
+  bool is_dirty(const std::string &name) const { return is_dirty(name.c_str()); }
+
+  /**
+ * \brief  Generation of the last modification of a property
+ * 
+ * The generation increases whenever the property (or the whole state) is marked dirty, so
+ * the saved data of a property (e.g., a segment of mexSerialCache) are fresh as long as its
+ * generation is unchanged. A load does not change it: such a cache must be cleared by
+ * load_prop().
+ * 
+ * \param[in]    name   Name of the property
+ */
+  uint64_t modified_generation(const char *name) const
+  {
+    uint64_t generation = all_modified_m;
+    int idx = dirty_index(name);
+    if (idx >= 0)
+    {
+      if ((std::size_t)idx < indexed_m.size())
+        generation = std::max(generation, indexed_m[idx]);
+      return generation;
+    }
+    auto it = modified_m.find(name);
+    return it != modified_m.end() ? std::max(generation, it->second) : generation;
+  }
+  uint64_t modified_generation(const std::string &name) const { return modified_generation(name.c_str()); }
+
   /**
  * \brief  Load C++ object's data
  * 
@@ -465,4 +1953,72 @@ protected:
  * \param[in] data   Data to reestablish the C++ object states
  */
   virtual void load_prop(const mxArray *mxObj, const mxArray *data){};
+
+  /**
+ * \brief  Save C++ object's data to a file
+ * 
+ * Override to support the saveToFile action. Unlike save_prop(), the object state does not
+ * need to fit in memory twice: stream it with mexSerializeToFile() of mexFileArchive.h (and
+ * restore it with mexDeserializeFromFile() in load_from_file()).
+ * 
+ * \param[in]    mxObj  Associated MATLAB class object
+ * \param[in]    path   File path
+ */
+  virtual void save_to_file(const mxArray *mxObj, const std::string &path)
+  {
+    throw mexRuntimeError("saveToFile:notSupported", "Class does not support saving to a file.");
+  }
+
+  /**
+ * \brief  Load C++ object's data from a file
+ * 
+ * \param[in]    mxObj  Associated MATLAB class object
+ * \param[in]    path   File path written by save_to_file()
+ */
+  virtual void load_from_file(const mxArray *mxObj, const std::string &path)
+  {
+    throw mexRuntimeError("loadFromFile:notSupported", "Class does not support loading from a file.");
+  }
+
+protected:
+  /**
+ * \brief  Index of a property in the modification counters
+ * 
+ * Override to map the property names to small indices (e.g., their index in a property table,
+ * as mexPropertyClass does), so that marking a property as modified neither hashes nor copies
+ * its name. Names without an index are tracked by name.
+ * 
+ * \param[in]    name   Name of the property
+ * \returns the index, or -1 if the name has none
+ */
+  virtual int dirty_index(const char *name) const { return -1; }
+
+  /**
+ * \brief  Restore the state tracking of a new, never saved object
+ * 
+ * Call it from the `reset()` of a recycled class (see mexObjectPoolSize) so that the new object
+ * does not inherit the saves of the deleted one.
+ */
+  void reset_saved_state()
+  {
+    mark_dirty();
+    saved_m = 0;
+  }
+
+private:
+  mexJobTable jobs_m; // background jobs
+
+  // dirty tracking: generation of each modification and of the last save
+  std::unordered_map<std::string, uint64_t> modified_m; // per-property modifications (by name)
+  std::vector<uint64_t> indexed_m;                      // per-property modifications (by dirty_index())
+  uint64_t generation_m = 1;                            // last issued generation
+  uint64_t all_modified_m = 1;                          // last modification of the whole state
+  uint64_t saved_m = 0;                                 // generation at the last save (never saved)
+
+  static uint64_t get_job_token(const mxArray *token)
+  {
+    if (mxGetClassID(token) != mxUINT64_CLASS || mxGetNumberOfElements(token) != 1 || mxIsComplex(token))
+      throw mexRuntimeError("async:invalidJob", "Job token must be a uint64 scalar returned by the start action.");
+    return *(uint64_t *)mxGetData(token);
+  }
 };
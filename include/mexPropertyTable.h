@@ -0,0 +1,838 @@
+/** \file mexPropertyTable.h
+ * C++ header file containing the declarative property binding of mexSetGetClass
+ */
+
+#pragma once
+
+#include "mexActionTable.h"    // for constant-time property lookup
+#include "mexArrayView.h"      // for typed (interleaved complex) data access
+#include "mexClassId.h"        // to map element types to MATLAB classes
+#include "mexCowPtr.h"         // for copy-on-write properties
+#include "mexElementOps.h"     // for vectorized checks and conversions
+#include "mexGetString.h"      // to convert char mxArray to std::string
+#include "mexObjectHandler.h"  // for mexSetGetClass
+#include "mexRuntimeError.h"   // for mexRuntimeError runtime exception class
+#include "mexVector.h"         // for zero-copy property export
+
+#include <mex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Convert the elements of a real numeric or logical mxArray
+ *
+ * The elements are copied as they are if the class of \p array matches T, and converted
+ * with static_cast otherwise.
+ *
+ * \param[in]  array Real, full, numeric or logical mxArray
+ * \param[out] dst   Buffer of mxGetNumberOfElements(array) elements
+ */
+template <typename T>
+void mexConvertElements(const mxArray *array, T *dst)
+{
+  const void *src = mxGetData(array);
+  std::size_t n = mxGetNumberOfElements(array);
+  switch (mxGetClassID(array))
+  {
+#define MEXCONVERTELEMENTS_CASE(ID, TYPE)      \
+  case ID:                                     \
+    mexConvertCopy((const TYPE *)src, n, dst); \
+    break;
+    MEXCONVERTELEMENTS_CASE(mxDOUBLE_CLASS, double)
+    MEXCONVERTELEMENTS_CASE(mxSINGLE_CLASS, float)
+    MEXCONVERTELEMENTS_CASE(mxINT8_CLASS, int8_t)
+    MEXCONVERTELEMENTS_CASE(mxUINT8_CLASS, uint8_t)
+    MEXCONVERTELEMENTS_CASE(mxINT16_CLASS, int16_t)
+    MEXCONVERTELEMENTS_CASE(mxUINT16_CLASS, uint16_t)
+    MEXCONVERTELEMENTS_CASE(mxINT32_CLASS, int32_t)
+    MEXCONVERTELEMENTS_CASE(mxUINT32_CLASS, uint32_t)
+    MEXCONVERTELEMENTS_CASE(mxINT64_CLASS, int64_t)
+    MEXCONVERTELEMENTS_CASE(mxUINT64_CLASS, uint64_t)
+    MEXCONVERTELEMENTS_CASE(mxLOGICAL_CLASS, mxLogical)
+#undef MEXCONVERTELEMENTS_CASE
+  default:
+    throw mexRuntimeError("invalidPropertyValue", "Value is not a numeric or logical array.");
+  }
+}
+
+/**
+ * \brief Create an uninitialized numeric matrix (zero-initialized before R2015a)
+ */
+inline mxArray *mexCreateUninitMatrix(mwSize m, mwSize n, mxClassID id)
+{
+#ifdef MATLAB_PRE_R2015A
+  return mxCreateNumericMatrix(m, n, id, mxREAL);
+#else
+  return mxCreateUninitNumericMatrix(m, n, id, mxREAL);
+#endif
+}
+
+/**
+ * \brief Check if mxArray is a real full numeric or logical array
+ */
+inline bool mexIsRealNumeric(const mxArray *array)
+{
+  return (mxIsNumeric(array) || mxIsLogical(array)) && !mxIsComplex(array) && !mxIsSparse(array);
+}
+
+/**
+ * \brief Conversion of a property value between its C++ type and mxArray
+ *
+ * A specialization provides:
+ *
+ *    static void from_mxarray(const mxArray *value, T &dst, const char *name); // throws if invalid
+ *    static mxArray *to_mxarray(const T &value);
+ *
+ * Specializations are provided for arithmetic and complex types (scalars), std::string,
+ * std::vector and mexVector of numeric or complex types (vectors), mexCowPtr of any supported
+ * type, and Eigen-like dense matrices (see mexIsDenseMatrix). Specialize it to bind other types.
+ */
+template <typename T, typename Enable = void>
+struct mexPropertyConverter;
+
+/**
+ * \brief Arithmetic scalars
+ *
+ * Accepts a real numeric or logical scalar, which must be exactly representable by an
+ * integral T. Floating-point types and bool are returned in their MATLAB class, 64-bit
+ * integers as int64/uint64, and the other integral types as double.
+ */
+template <typename T>
+struct mexPropertyConverter<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+  static void from_mxarray(const mxArray *value, T &dst, const char *name)
+  {
+    if (!mexIsRealNumeric(value) || mxGetNumberOfElements(value) != 1)
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must be a real scalar.");
+    convert(value, dst, name, std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value>());
+  }
+
+  static mxArray *to_mxarray(const T &value) { return create(value, std::is_same<T, bool>()); }
+
+private:
+  typedef typename std::conditional<
+      std::is_floating_point<T>::value,
+      typename std::conditional<std::is_same<T, float>::value, float, double>::type,
+      typename std::conditional<sizeof(T) == 8, typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type, double>::type>::type
+      out_type;
+
+  // floating-point and bool: any value is accepted
+  static void convert(const mxArray *value, T &dst, const char *, std::false_type) { mexConvertElements(value, &dst); }
+
+  // integral: must be an integer within the range of T
+  static void convert(const mxArray *value, T &dst, const char *name, std::true_type)
+  {
+    if (mxGetClassID(value) == mexClassId<out_type>::value && sizeof(T) == sizeof(out_type))
+    {
+      mexConvertElements(value, &dst); // 64-bit integer of the same class: exact
+      return;
+    }
+    mxClassID id = mxGetClassID(value);
+    if (id >= mxINT8_CLASS && id <= mxUINT64_CLASS) // integer class: exact, without going through double
+    {
+      if (!integer_in_range(value))
+        throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must be an integer within the range of its type.");
+      dst = integer_value<T>(value);
+      return;
+    }
+    double val;
+    mexConvertElements(value, &val);
+    if (!(val >= (double)std::numeric_limits<T>::min() && val < std::ldexp(1.0, std::numeric_limits<T>::digits)) || val != std::floor(val))
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must be an integer within the range of its type.");
+    dst = (T)val;
+  }
+
+  // value of an integer-class scalar cast to I
+  template <typename I>
+  static I integer_value(const mxArray *value)
+  {
+    const void *data = mxGetData(value);
+    switch (mxGetClassID(value))
+    {
+    case mxINT8_CLASS: return static_cast<I>(*(const int8_t *)data);
+    case mxUINT8_CLASS: return static_cast<I>(*(const uint8_t *)data);
+    case mxINT16_CLASS: return static_cast<I>(*(const int16_t *)data);
+    case mxUINT16_CLASS: return static_cast<I>(*(const uint16_t *)data);
+    case mxINT32_CLASS: return static_cast<I>(*(const int32_t *)data);
+    case mxUINT32_CLASS: return static_cast<I>(*(const uint32_t *)data);
+    case mxINT64_CLASS: return static_cast<I>(*(const int64_t *)data);
+    default: return static_cast<I>(*(const uint64_t *)data);
+    }
+  }
+
+  // true if an integer-class scalar is within the range of T
+  static bool integer_in_range(const mxArray *value)
+  {
+    switch (mxGetClassID(value))
+    {
+    case mxINT8_CLASS:
+    case mxINT16_CLASS:
+    case mxINT32_CLASS:
+    case mxINT64_CLASS:
+    {
+      int64_t val = integer_value<int64_t>(value);
+      if (val < 0)
+        return std::is_signed<T>::value && val >= (int64_t)std::numeric_limits<T>::min();
+      return (uint64_t)val <= (uint64_t)std::numeric_limits<T>::max();
+    }
+    default:
+      return integer_value<uint64_t>(value) <= (uint64_t)std::numeric_limits<T>::max();
+    }
+  }
+
+  static mxArray *create(const T &value, std::true_type) { return mxCreateLogicalScalar(value); }
+
+  static mxArray *create(const T &value, std::false_type)
+  {
+    mxArray *out = mxCreateNumericMatrix(1, 1, mexClassId<out_type>::value, mxREAL);
+    *(out_type *)mxGetData(out) = (out_type)value;
+    return out;
+  }
+};
+
+/**
+ * \brief Strings (single-row char array)
+ */
+template <>
+struct mexPropertyConverter<std::string, void>
+{
+  static void from_mxarray(const mxArray *value, std::string &dst, const char *name)
+  {
+    if (!mxIsChar(value) || (mxGetM(value) != 1 && !mxIsEmpty(value)))
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must be a single-row character string.");
+    mexGetString(value, dst);
+  }
+
+  static mxArray *to_mxarray(const std::string &value) { return mxCreateString(value.c_str()); }
+};
+
+/**
+ * \brief Type trait to detect complex element types (std::complex of float or double)
+ */
+template <typename T>
+struct mexIsComplexElement : std::false_type
+{
+};
+template <typename T>
+struct mexIsComplexElement<std::complex<T>> : std::integral_constant<bool, std::is_floating_point<T>::value && mexHasClassId<T>::value>
+{
+};
+
+/**
+ * \brief Type trait to detect the element types of the array converters (numeric or complex)
+ */
+template <typename T>
+struct mexIsArrayElement : std::integral_constant<bool, (mexHasClassId<T>::value && !std::is_same<T, mxChar>::value) || mexIsComplexElement<T>::value>
+{
+};
+
+/**
+ * \brief Copy the elements of a single or double mxArray to std::complex<T>
+ *
+ * With the interleaved complex API, complex data is read in place as std::complex (see
+ * mexTypedData), i.e., it is copied in a single pass. With the separate complex API, the
+ * real and imaginary parts are interleaved. Real arrays (of any numeric class) get zero
+ * imaginary parts.
+ */
+template <typename T>
+void mexConvertElements(const mxArray *array, std::complex<T> *dst)
+{
+  std::size_t n = mxGetNumberOfElements(array);
+  if (!mxIsComplex(array))
+  {
+    // convert to the first half of dst, then spread backwards (dst[i] never overlaps buf[j > i])
+    T *buf = reinterpret_cast<T *>(dst);
+    mexConvertElements(array, buf);
+    for (std::size_t i = n; i-- > 0;)
+      dst[i] = std::complex<T>(buf[i], T(0));
+    return;
+  }
+
+  switch (mxGetClassID(array))
+  {
+#ifdef MX_HAS_INTERLEAVED_COMPLEX
+  case mxDOUBLE_CLASS:
+  {
+    const std::complex<double> *src = mexTypedData<const std::complex<double>>::get(array);
+    std::transform(src, src + n, dst, [](const std::complex<double> &v) { return std::complex<T>(v); });
+    break;
+  }
+  case mxSINGLE_CLASS:
+  {
+    const std::complex<float> *src = mexTypedData<const std::complex<float>>::get(array);
+    std::transform(src, src + n, dst, [](const std::complex<float> &v) { return std::complex<T>(v); });
+    break;
+  }
+#else
+  case mxDOUBLE_CLASS:
+  {
+    const double *re = (const double *)mxGetData(array), *im = (const double *)mxGetImagData(array);
+    for (std::size_t i = 0; i < n; ++i)
+      dst[i] = std::complex<T>((T)re[i], (T)im[i]);
+    break;
+  }
+  case mxSINGLE_CLASS:
+  {
+    const float *re = (const float *)mxGetData(array), *im = (const float *)mxGetImagData(array);
+    for (std::size_t i = 0; i < n; ++i)
+      dst[i] = std::complex<T>((T)re[i], (T)im[i]);
+    break;
+  }
+#endif
+  default:
+    throw mexRuntimeError("invalidPropertyValue", "Complex value must be a single or double array.");
+  }
+}
+
+/**
+ * \brief Check if mxArray may be converted to T elements (complex only for complex T)
+ */
+template <typename T>
+bool mexIsConvertible(const mxArray *array, const T *)
+{
+  return mexIsRealNumeric(array);
+}
+template <typename T>
+bool mexIsConvertible(const mxArray *array, const std::complex<T> *)
+{
+  return (mxIsNumeric(array) || mxIsLogical(array)) && !mxIsSparse(array);
+}
+
+// floating-point elements: integers within the range of integral T
+template <typename T, typename S>
+bool mexIntegersFit(const S *x, std::size_t n, std::true_type)
+{
+  return mexAllIntegers(x, n, (S)std::numeric_limits<T>::min(), std::nextafter((S)std::ldexp(1.0, std::numeric_limits<T>::digits), (S)0));
+}
+
+// integer elements: within the range of integral T (always if it is not narrower)
+template <typename T, typename S>
+bool mexIntegersFit(const S *x, std::size_t n, std::false_type)
+{
+  typedef std::numeric_limits<S> src;
+  typedef std::numeric_limits<T> dst;
+  S lo = !src::is_signed ? src::min() : !dst::is_signed ? S(0) : dst::digits < src::digits ? (S)dst::min() : src::min();
+  S hi = (uintmax_t)dst::max() < (uintmax_t)src::max() ? (S)dst::max() : src::max();
+  return (lo == src::min() && hi == src::max()) || mexAllInRange(x, n, lo, hi);
+}
+
+template <typename T>
+bool mexElementsFit(const mxArray *array, std::false_type) { return true; }
+
+template <typename T>
+bool mexElementsFit(const mxArray *array, std::true_type)
+{
+  const void *x = mxGetData(array);
+  std::size_t n = mxGetNumberOfElements(array);
+  switch (mxGetClassID(array))
+  {
+#define MEXELEMENTSFIT_CASE(ID, TYPE) \
+  case ID:                            \
+    return mexIntegersFit<T>((const TYPE *)x, n, std::is_floating_point<TYPE>());
+    MEXELEMENTSFIT_CASE(mxDOUBLE_CLASS, double)
+    MEXELEMENTSFIT_CASE(mxSINGLE_CLASS, float)
+    MEXELEMENTSFIT_CASE(mxINT8_CLASS, int8_t)
+    MEXELEMENTSFIT_CASE(mxUINT8_CLASS, uint8_t)
+    MEXELEMENTSFIT_CASE(mxINT16_CLASS, int16_t)
+    MEXELEMENTSFIT_CASE(mxUINT16_CLASS, uint16_t)
+    MEXELEMENTSFIT_CASE(mxINT32_CLASS, int32_t)
+    MEXELEMENTSFIT_CASE(mxUINT32_CLASS, uint32_t)
+    MEXELEMENTSFIT_CASE(mxINT64_CLASS, int64_t)
+    MEXELEMENTSFIT_CASE(mxUINT64_CLASS, uint64_t)
+#undef MEXELEMENTSFIT_CASE
+  default:
+    return true; // logical
+  }
+}
+
+/**
+ * \brief Check if the elements of a real numeric mxArray are exactly representable as T
+ *
+ * For integral T, the elements must be integers within its range; always true otherwise.
+ * The array is scanned in place (vectorized, see mexElementOps.h) before any conversion.
+ */
+template <typename T>
+bool mexElementsFit(const mxArray *array, const T *)
+{
+  return mexElementsFit<T>(array, std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value>());
+}
+
+/**
+ * \brief Create an m-by-n mxArray with a copy of the column-major elements \p src
+ */
+template <typename T>
+mxArray *mexCreateMatrix(const T *src, std::size_t m, std::size_t n)
+{
+  mxArray *out = mexCreateUninitMatrix(m, n, mexClassId<T>::value);
+  if (m && n)
+    std::memcpy(mxGetData(out), src, m * n * sizeof(T));
+  return out;
+}
+template <typename T>
+mxArray *mexCreateMatrix(const std::complex<T> *src, std::size_t m, std::size_t n)
+{
+  mxArray *out = mxCreateNumericMatrix(m, n, mexClassId<T>::value, mxCOMPLEX);
+  if (!m || !n)
+    return out;
+#ifdef MX_HAS_INTERLEAVED_COMPLEX
+  std::copy(src, src + m * n, mexTypedData<std::complex<T>>::get(out)); // single pass
+#else
+  T *re = (T *)mxGetData(out), *im = (T *)mxGetImagData(out);
+  for (std::size_t i = 0; i < m * n; ++i)
+  {
+    re[i] = src[i].real();
+    im[i] = src[i].imag();
+  }
+#endif
+  return out;
+}
+
+/**
+ * \brief Complex scalars (std::complex of float or double)
+ */
+template <typename T>
+struct mexPropertyConverter<std::complex<T>, typename std::enable_if<mexIsComplexElement<std::complex<T>>::value>::type>
+{
+  static void from_mxarray(const mxArray *value, std::complex<T> &dst, const char *name)
+  {
+    if (!mexIsConvertible(value, &dst) || mxGetNumberOfElements(value) != 1)
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must be a numeric scalar.");
+    mexConvertElements(value, &dst);
+  }
+
+  static mxArray *to_mxarray(const std::complex<T> &value) { return mexCreateMatrix(&value, 1, 1); }
+};
+
+/**
+ * \brief Common implementation of the numeric vector converters (column vector output)
+ */
+template <typename Vector, typename T>
+struct mexVectorPropertyConverter
+{
+  static void from_mxarray(const mxArray *value, Vector &dst, const char *name)
+  {
+    if (!mexIsConvertible(value, (const T *)NULL) || mxGetNumberOfDimensions(value) != 2 ||
+        (mxGetM(value) != 1 && mxGetN(value) != 1 && !mxIsEmpty(value)))
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + (mexIsComplexElement<T>::value ? " must be a numeric vector." : " must be a real vector."));
+    if (!mexElementsFit(value, (const T *)NULL))
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must contain integers within the range of its type.");
+    dst.resize(mxGetNumberOfElements(value));
+    if (!dst.empty())
+      mexConvertElements(value, dst.data());
+  }
+
+  static mxArray *to_mxarray(const Vector &value) { return mexCreateMatrix(value.data(), value.size(), 1); }
+};
+
+template <typename T>
+struct mexPropertyConverter<std::vector<T>, typename std::enable_if<mexIsArrayElement<T>::value && !std::is_same<T, bool>::value>::type>
+    : mexVectorPropertyConverter<std::vector<T>, T>
+{
+};
+
+template <typename T>
+struct mexPropertyConverter<mexVector<T>, typename std::enable_if<mexHasClassId<T>::value>::type>
+    : mexVectorPropertyConverter<mexVector<T>, T>
+{
+  static mxArray *to_mxarray(const mexVector<T> &value) { return value.to_mxArray(); }
+};
+
+/**
+ * \brief Copy-on-write values: converted as the held value, replaced without a copy on set
+ */
+template <typename T>
+struct mexPropertyConverter<mexCowPtr<T>, void>
+{
+  static void from_mxarray(const mxArray *value, mexCowPtr<T> &dst, const char *name)
+  {
+    T val;
+    mexPropertyConverter<T>::from_mxarray(value, val, name);
+    dst.reset(std::move(val));
+  }
+
+  static mxArray *to_mxarray(const mexCowPtr<T> &value) { return mexPropertyConverter<T>::to_mxarray(*value); }
+};
+
+/**
+ * \brief Type trait to detect Eigen-like dense matrices
+ *
+ * A dense matrix type has a numeric (or complex) `Scalar` element type and the members
+ * `rows()`, `cols()`, `data()`, and `resize(rows, cols)`. Its elements are in column-major
+ * order unless it defines a true `IsRowMajor` constant (as Eigen does).
+ */
+template <typename T, typename = void>
+struct mexIsDenseMatrix : std::false_type
+{
+};
+template <typename T>
+struct mexIsDenseMatrix<T, decltype((void)typename std::enable_if<mexIsArrayElement<typename T::Scalar>::value>::type(),
+                                    (void)std::declval<T &>().resize(1, 1), (void)std::declval<const T &>().rows(),
+                                    (void)std::declval<const T &>().cols(), (void)std::declval<T &>().data())> : std::true_type
+{
+};
+
+template <typename T, typename = void>
+struct mexIsRowMajor : std::false_type
+{
+};
+template <typename T>
+struct mexIsRowMajor<T, decltype((void)T::IsRowMajor)> : std::integral_constant<bool, (bool)T::IsRowMajor>
+{
+};
+
+/**
+ * \brief Eigen-like dense matrices (2-D arrays)
+ */
+template <typename T>
+struct mexPropertyConverter<T, typename std::enable_if<mexIsDenseMatrix<T>::value>::type>
+{
+  typedef typename T::Scalar elem_type;
+
+  static void from_mxarray(const mxArray *value, T &dst, const char *name)
+  {
+    if (!mexIsConvertible(value, (const elem_type *)NULL) || mxGetNumberOfDimensions(value) != 2)
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + (mexIsComplexElement<elem_type>::value ? " must be a numeric matrix." : " must be a real matrix."));
+    if (!mexElementsFit(value, (const elem_type *)NULL))
+      throw mexRuntimeError("invalidPropertyValue", std::string(name) + " must contain integers within the range of its type.");
+    std::size_t m = mxGetM(value), n = mxGetN(value);
+    dst.resize(m, n);
+    if (!m || !n)
+      return;
+    if (!mexIsRowMajor<T>::value)
+      mexConvertElements(value, dst.data()); // same memory layout
+    else
+    {
+      std::vector<elem_type> buf(m * n);
+      mexConvertElements(value, buf.data());
+      transpose(buf.data(), dst.data(), m, n);
+    }
+  }
+
+  static mxArray *to_mxarray(const T &value)
+  {
+    std::size_t m = (std::size_t)value.rows(), n = (std::size_t)value.cols();
+    if (!mexIsRowMajor<T>::value || !m || !n)
+      return mexCreateMatrix(value.data(), m, n);
+    std::vector<elem_type> buf(m * n);
+    transpose(value.data(), buf.data(), n, m);
+    return mexCreateMatrix(buf.data(), m, n);
+  }
+
+private:
+  // copy column-major m-by-n src to row-major dst
+  static void transpose(const elem_type *src, elem_type *dst, std::size_t m, std::size_t n)
+  {
+    for (std::size_t j = 0; j < n; ++j)
+      for (std::size_t i = 0; i < m; ++i)
+        dst[i * n + j] = src[j * m + i];
+  }
+};
+
+/**
+ * \brief Bound property of a class (type-erased)
+ *
+ * Created with mexProp() and registered in a \ref mexPropertyTable.
+ *
+ * \tparam Class Class owning the property
+ */
+template <class Class>
+struct mexProperty
+{
+  const char *name;
+  std::function<void(Class &, const mxArray *)> set; // converts, validates, then assigns
+  std::function<mxArray *(const Class &)> get;
+  bool saved; // included in save_prop()/load_prop() of mexPropertyClass
+};
+
+/**
+ * \brief Bind a data member as a property
+ *
+ * The value is converted with mexPropertyConverter<T>. It is assigned to the member only
+ * after the conversion (and the validation) succeeded, so a failed set leaves it unchanged.
+ *
+ * \param[in] name   Property name
+ * \param[in] member Pointer to the data member
+ * \param[in] saved  False to exclude the property from save_prop()/load_prop()
+ */
+template <class Class, typename T>
+mexProperty<Class> mexProp(const char *name, T Class::*member, bool saved = true)
+{
+  return {name,
+          [name, member](Class &obj, const mxArray *value) {
+            T val;
+            mexPropertyConverter<T>::from_mxarray(value, val, name);
+            obj.*member = std::move(val);
+          },
+          [member](const Class &obj) { return mexPropertyConverter<T>::to_mxarray(obj.*member); },
+          saved};
+}
+
+/**
+ * \brief Bind a data member as a property with a validator
+ *
+ *    mexProp("VarA", &myClass::VarA, [](int v) { return v >= -10 && v <= 10; }, "VarA must be between -10 and 10.")
+ *
+ * \param[in] name    Property name
+ * \param[in] member  Pointer to the data member
+ * \param[in] valid   Callable as `bool(const T &)`, returning false for an invalid value
+ *                    (it may also throw mexRuntimeError with its own message)
+ * \param[in] message Error message if \p valid returns false
+ * \param[in] saved   False to exclude the property from save_prop()/load_prop()
+ */
+template <class Class, typename T, typename Validator>
+mexProperty<Class> mexProp(const char *name, T Class::*member, Validator valid, const char *message, bool saved = true)
+{
+  return {name,
+          [name, member, valid, message](Class &obj, const mxArray *value) {
+            T val;
+            mexPropertyConverter<T>::from_mxarray(value, val, name);
+            if (!valid(static_cast<const T &>(val)))
+              throw mexRuntimeError("invalidPropertyValue", message);
+            obj.*member = std::move(val);
+          },
+          [member](const Class &obj) { return mexPropertyConverter<T>::to_mxarray(obj.*member); },
+          saved};
+}
+
+/**
+ * \brief Elements of a property value for the element-wise validators
+ *
+ * Arithmetic scalars, containers with data() and size() (std::vector, mexVector), dense
+ * matrices, and mexCowPtr of any of them.
+ */
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value, std::pair<const T *, std::size_t>>::type mexPropElements(const T &value)
+{
+  return {&value, 1};
+}
+template <typename T>
+typename std::enable_if<mexIsDenseMatrix<T>::value, std::pair<const typename T::Scalar *, std::size_t>>::type mexPropElements(const T &value)
+{
+  return {value.data(), (std::size_t)value.rows() * (std::size_t)value.cols()};
+}
+template <typename T>
+auto mexPropElements(const T &value) -> typename std::enable_if<!mexIsDenseMatrix<T>::value, std::pair<decltype(value.data()), std::size_t>>::type
+{
+  return {value.data(), value.size()};
+}
+template <typename T>
+auto mexPropElements(const mexCowPtr<T> &value) -> decltype(mexPropElements(*value)) { return mexPropElements(*value); }
+
+/**
+ * \brief Validator of mexProp(): no element is NaN or Inf
+ *
+ *    mexProp("VarB", &myClass::VarB, mexFiniteValues(), "VarB must be finite.")
+ */
+struct mexFiniteValues
+{
+  template <typename T>
+  bool operator()(const T &value) const
+  {
+    auto elems = mexPropElements(value);
+    return mexAllFinite(elems.first, elems.second);
+  }
+};
+
+/**
+ * \brief Validator of mexProp(): every element is within [lo, hi] (see mexInRange())
+ */
+template <typename E>
+struct mexValueRange
+{
+  E lo, hi;
+
+  template <typename T>
+  bool operator()(const T &value) const
+  {
+    auto elems = mexPropElements(value);
+    typedef typename std::remove_const<typename std::remove_pointer<decltype(elems.first)>::type>::type elem_type;
+    return mexAllInRange(elems.first, elems.second, (elem_type)lo, (elem_type)hi);
+  }
+};
+
+/**
+ * \brief Validator of mexProp(): every element is within [lo, hi] (NaN is not)
+ *
+ *    mexProp("Gains", &myClass::Gains, mexInRange(0.0, 1.0), "Gains must be between 0 and 1.")
+ */
+template <typename E>
+mexValueRange<E> mexInRange(E lo, E hi) { return {lo, hi}; }
+
+/**
+ * \brief Constant-time lookup table of the bound properties of a class
+ *
+ * Built once per class (e.g., as a function-local static) from mexProp() entries:
+ *
+ *    static const mexPropertyTable<myClass> &property_table()
+ *    {
+ *      static const mexPropertyTable<myClass> table({mexProp("VarA", &myClass::VarA),
+ *                                                    mexProp("VarB", &myClass::VarB)});
+ *      return table;
+ *    }
+ *
+ * \tparam Class Class owning the properties
+ */
+template <class Class>
+class mexPropertyTable
+{
+public:
+  typedef mexProperty<Class> property_type;
+
+  mexPropertyTable(std::initializer_list<property_type> props) : props_m(props), lookup_m(build(props_m)) {}
+
+  mexPropertyTable(const mexPropertyTable &) = delete;
+  mexPropertyTable &operator=(const mexPropertyTable &) = delete;
+
+  /**
+   * \brief Look up a property by its name (std::string or MATLAB char array)
+   *
+   * \returns the property or NULL if not found
+   */
+  const property_type *find(const std::string &name) const { return lookup_m.find(name); }
+  const property_type *find(const mxArray *name) const { return lookup_m.find(name); }
+  const property_type *find(const char *name) const { return lookup_m.find(name, std::strlen(name)); }
+
+  std::size_t size() const { return props_m.size(); }
+  const property_type &operator[](std::size_t i) const { return props_m[i]; }
+
+  /**
+   * \brief Index of a property found by find()
+   */
+  std::size_t index(const property_type *p) const { return (std::size_t)(p - props_m.data()); }
+
+  /**
+   * \brief Get the saved properties as a scalar struct (in the order of registration)
+   */
+  mxArray *to_struct(const Class &obj) const
+  {
+    return to_struct(obj, [](const char *) { return true; });
+  }
+
+  /**
+   * \brief Get the saved properties selected by a predicate as a scalar struct
+   *
+   * \param[in] obj     Object owning the properties
+   * \param[in] include Predicate `bool(const char *name)` selecting the properties to include
+   */
+  template <typename Pred>
+  mxArray *to_struct(const Class &obj, Pred include) const
+  {
+    std::vector<const property_type *> selected;
+    std::vector<const char *> names;
+    for (auto &p : props_m)
+      if (p.saved && include(p.name))
+      {
+        selected.push_back(&p);
+        names.push_back(p.name);
+      }
+    mxArray *out = mxCreateStructMatrix(1, 1, (int)names.size(), names.data());
+    for (std::size_t i = 0; i < selected.size(); ++i)
+      mxSetFieldByNumber(out, 0, (int)i, selected[i]->get(obj));
+    return out;
+  }
+
+  /**
+   * \brief Set the saved properties from the fields of a scalar struct
+   *
+   * Fields not matching a saved property are ignored, and properties without a field are
+   * left unchanged.
+   */
+  void from_struct(Class &obj, const mxArray *value) const
+  {
+    if (!mxIsStruct(value) || mxGetNumberOfElements(value) != 1)
+      throw mexRuntimeError("load:invalidData", "Saved properties must be given as a scalar struct.");
+    int nfields = mxGetNumberOfFields(value);
+    for (int i = 0; i < nfields; ++i)
+    {
+      const property_type *p = find(mxGetFieldNameByNumber(value, i));
+      if (p && p->saved)
+        p->set(obj, mxGetFieldByNumber(value, 0, i));
+    }
+  }
+
+private:
+  typedef mexDispatchTable<const property_type *> lookup_type;
+
+  std::vector<property_type> props_m; // not modified after construction (lookup_m points to its elements)
+  lookup_type lookup_m;
+
+  static lookup_type build(const std::vector<property_type> &props)
+  {
+    std::vector<std::pair<const char *, const property_type *>> entries;
+    for (auto &p : props)
+      entries.push_back({p.name, &p});
+    return lookup_type(entries.begin(), entries.end());
+  }
+};
+
+/**
+ * \brief mexSetGetClass with the properties bound in a mexPropertyTable
+ *
+ * Implements set_prop(), get_prop(), save_prop(), and load_prop() of mexSetGetClass with the
+ * property table of the derived class, which replaces their hand-written if/else chains:
+ *
+ *    class myClass : public mexPropertyClass<myClass>
+ *    {
+ *    public:
+ *      static const mexPropertyTable<myClass> &property_table(); // see mexPropertyTable
+ *      ...
+ *    };
+ *
+ * The properties are looked up in constant time, converted by mexPropertyConverter, and
+ * saved as a struct with a field per saved property. The saveDelta action saves the struct of
+ * the properties modified since the last save (see mexSetGetClass::is_dirty()), which the load
+ * action applies on top of the current values. The derived class may still override any of
+ * these member functions (e.g., to save in a binary format).
+ *
+ * \tparam Derived Derived class defining `static const mexPropertyTable<Derived> &property_table()`
+ * \tparam Base    mexSetGetClass or a class derived from it
+ */
+template <class Derived, class Base = mexSetGetClass>
+class mexPropertyClass : public Base
+{
+protected:
+  void set_prop(const mxArray *mxObj, const std::string name, const mxArray *value)
+  {
+    find(name)->set(static_cast<Derived &>(*this), value);
+  }
+
+  mxArray *get_prop(const mxArray *mxObj, const std::string name)
+  {
+    return find(name)->get(static_cast<const Derived &>(*this));
+  }
+
+  mxArray *save_prop(const mxArray *mxObj) { return Derived::property_table().to_struct(static_cast<const Derived &>(*this)); }
+
+  mxArray *save_delta_prop(const mxArray *mxObj)
+  {
+    return Derived::property_table().to_struct(static_cast<const Derived &>(*this), [this](const char *name) { return this->is_dirty(name); });
+  }
+
+  void load_prop(const mxArray *mxObj, const mxArray *value) { Derived::property_table().from_struct(static_cast<Derived &>(*this), value); }
+
+  // track the modifications of the properties by their table index
+  int dirty_index(const char *name) const
+  {
+    const mexProperty<Derived> *p = Derived::property_table().find(name);
+    return p ? (int)Derived::property_table().index(p) : -1;
+  }
+
+private:
+  static const mexProperty<Derived> *find(const std::string &name)
+  {
+    const mexProperty<Derived> *p = Derived::property_table().find(name);
+    if (!p)
+      throw mexRuntimeError("invalidPropertyName", "Unknown property name: " + name);
+    return p;
+  }
+};
@@ -0,0 +1,1294 @@
+/** \file mexRemoteBackend.h
+ * C++ header file containing the out-of-process backend of mexObjectHandler (POSIX only)
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#error "mexRemoteBackend.h requires POSIX (posix_spawn() and process-shared semaphores)."
+#endif
+
+#include "mexActionTable.h"   // for the action tables of the server class
+#include "mexRuntimeError.h"  // for mexRuntimeError runtime exception class
+#include "mexSharedMemory.h"  // for the shared-memory channel
+
+// the MEX (mxArray) parts are left out of the helper process, which runs without MATLAB
+#ifndef MEXUTILS_REMOTE_SERVER
+#include "mexAtExit.h" // to shut the helper process down
+#include <mex.h>
+#include <dlfcn.h>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ; // passed on to the helper process
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/**
+ * \brief Element types of the arrays passed to and from a remote server
+ */
+enum mexRemoteType : uint32_t
+{
+  mexRemoteLogical,
+  mexRemoteChar, // UTF-16 code units
+  mexRemoteDouble,
+  mexRemoteSingle,
+  mexRemoteInt8,
+  mexRemoteUint8,
+  mexRemoteInt16,
+  mexRemoteUint16,
+  mexRemoteInt32,
+  mexRemoteUint32,
+  mexRemoteInt64,
+  mexRemoteUint64,
+  mexRemoteTypeCount
+};
+
+/**
+ * \brief Type trait of the mexRemoteType of a C++ element type
+ */
+template <class T>
+struct mexRemoteTypeOf;
+#define MEXREMOTETYPEOF_SPECIALIZATION(T, type) \
+  template <>                                   \
+  struct mexRemoteTypeOf<T> : std::integral_constant<mexRemoteType, type> {};
+MEXREMOTETYPEOF_SPECIALIZATION(bool, mexRemoteLogical)
+MEXREMOTETYPEOF_SPECIALIZATION(char16_t, mexRemoteChar)
+MEXREMOTETYPEOF_SPECIALIZATION(double, mexRemoteDouble)
+MEXREMOTETYPEOF_SPECIALIZATION(float, mexRemoteSingle)
+MEXREMOTETYPEOF_SPECIALIZATION(int8_t, mexRemoteInt8)
+MEXREMOTETYPEOF_SPECIALIZATION(uint8_t, mexRemoteUint8)
+MEXREMOTETYPEOF_SPECIALIZATION(int16_t, mexRemoteInt16)
+MEXREMOTETYPEOF_SPECIALIZATION(uint16_t, mexRemoteUint16)
+MEXREMOTETYPEOF_SPECIALIZATION(int32_t, mexRemoteInt32)
+MEXREMOTETYPEOF_SPECIALIZATION(uint32_t, mexRemoteUint32)
+MEXREMOTETYPEOF_SPECIALIZATION(int64_t, mexRemoteInt64)
+MEXREMOTETYPEOF_SPECIALIZATION(uint64_t, mexRemoteUint64)
+#undef MEXREMOTETYPEOF_SPECIALIZATION
+
+/**
+ * \brief Size in bytes of an element of the given type
+ */
+inline std::size_t mexRemoteElementSize(uint32_t type)
+{
+  static const std::size_t sizes[mexRemoteTypeCount] = {1, 2, 8, 4, 1, 1, 2, 2, 4, 4, 8, 8};
+  return type < mexRemoteTypeCount ? sizes[type] : 0;
+}
+
+/**
+ * \brief Wire format of the channel between the MEX function (client) and the helper process (server)
+ *
+ * The client writes its requests to a ring buffer in the shared-memory segment of the channel,
+ * and the server writes the response of a request that the client waits for to a separate
+ * response buffer. Every record is aligned to 8 bytes. A request is a mexRemoteProtocol::request
+ * followed by the action name and the arguments, and a response is a mexRemoteProtocol::response
+ * followed by the outputs (or by the error id and message). An array is an array_header followed
+ * by its uint64 dimensions and its elements, and a string is its uint64 length followed by its
+ * characters.
+ */
+struct mexRemoteProtocol
+{
+  enum kind : uint16_t
+  {
+    pad,           // skip to the start of the ring
+    create,        // construct the object `target`
+    destroy,       // destroy the object `object`
+    clone,         // copy-construct the object `target` from the object `object`
+    action,        // run an action of the object `object`
+    static_action, // run a static action
+    sync,          // report the error of a posted request, if any
+    shutdown       // exit the server
+  };
+
+  enum status : uint32_t
+  {
+    ok,
+    error,
+    unknown // action is not in the table
+  };
+
+  static const uint16_t reply = 1; // request flag: the client waits for the response
+
+  struct request
+  {
+    uint32_t size;        // bytes including this header (multiple of 8)
+    uint16_t kind;        // mexRemoteProtocol::kind
+    uint16_t flags;       // mexRemoteProtocol::reply
+    uint64_t object;      // id of the object
+    uint64_t target;      // id of the new object (create and clone)
+    uint32_t nargs;       // number of arguments
+    int32_t nout;         // number of requested outputs
+    uint64_t name_length; // length of the action name
+  };
+
+  struct response
+  {
+    uint32_t size;   // bytes including this header (multiple of 8)
+    uint32_t status; // mexRemoteProtocol::status
+    uint32_t nout;   // number of outputs
+    uint32_t reserved;
+  };
+
+  struct array_header
+  {
+    uint32_t type;  // mexRemoteType
+    uint32_t ndims; // number of dimensions
+    uint64_t bytes; // size of the elements
+  };
+
+  static uint64_t padded(uint64_t bytes) { return (bytes + 7) & ~(uint64_t)7; }
+  static uint64_t string_size(std::size_t len) { return sizeof(uint64_t) + padded(len); }
+  static uint64_t array_size(std::size_t ndims, uint64_t bytes) { return sizeof(array_header) + ndims * sizeof(uint64_t) + padded(bytes); }
+
+  static char *put_string(char *dst, const char *str, std::size_t len)
+  {
+    uint64_t n = len;
+    std::memcpy(dst, &n, sizeof(n));
+    if (len)
+      std::memcpy(dst + sizeof(n), str, len);
+    return dst + string_size(len);
+  }
+};
+static_assert(sizeof(mexRemoteProtocol::request) == 40, "mexRemoteProtocol::request must not be padded.");
+static_assert(sizeof(mexRemoteProtocol::response) == 16, "mexRemoteProtocol::response must not be padded.");
+static_assert(sizeof(mexRemoteProtocol::array_header) == 16, "mexRemoteProtocol::array_header must not be padded.");
+
+/**
+ * \brief Shared-memory channel between a MEX function and its helper process
+ *
+ * The channel lives in a mexSharedSegment created by the client and attached read-write by
+ * the server. Requests go through a single-producer single-consumer ring buffer, so the client
+ * can queue requests without waiting for the server and the server processes them in order.
+ * A request is stored contiguously (a wrapping request is preceded by a pad record), and the
+ * server reads its arguments in place. Process-shared semaphores signal new requests and
+ * responses, and every wait periodically checks that the other process is still running.
+ */
+class mexRemoteChannel
+{
+public:
+  typedef mexRemoteProtocol protocol;
+
+  /**
+   * \brief Create the channel (client)
+   *
+   * \param[in] name     Name of the shared-memory segment
+   * \param[in] capacity Size in bytes of the largest request and of the response buffer (at least 4 KiB)
+   */
+  mexRemoteChannel(const std::string &name, std::size_t capacity)
+      : segment_m(name, sizeof(state) + alignof(state) + 3 * segment_capacity(capacity) + 16)
+  {
+    capacity = segment_capacity(capacity);
+    state *s = new (segment_m.allocate(sizeof(state), alignof(state))) state();
+    s->capacity = capacity;
+    s->ring = segment_m.allocate_array<char>(2 * capacity); // a wrapping request always fits after its pad record
+    s->response = segment_m.allocate_array<char>(capacity);
+    s->client_pid.store((int32_t)getpid());
+    if (sem_init(&s->requests, 1, 0) || sem_init(&s->responses, 1, 0))
+      throw mexRuntimeError("remote:channelFailed", "Failed to initialize the semaphores of remote channel " + name + ".");
+    segment_m.publish(s, signature());
+    state_m = s;
+  }
+
+  /**
+   * \brief Attach to the channel created by the client (server)
+   */
+  explicit mexRemoteChannel(const std::string &name)
+      : segment_m(name, mexSharedSegment::read_write), state_m((state *)segment_m.root(signature()))
+  {
+    state_m->server_pid.store((int32_t)getpid());
+  }
+
+  ~mexRemoteChannel()
+  {
+    if (segment_m.owner())
+    {
+      sem_destroy(&state_m->requests);
+      sem_destroy(&state_m->responses);
+    }
+  }
+
+  mexRemoteChannel(const mexRemoteChannel &) = delete;
+  mexRemoteChannel &operator=(const mexRemoteChannel &) = delete;
+
+  /**
+   * \brief Size in bytes of the largest request and of the response buffer
+   */
+  std::size_t capacity() const { return (std::size_t)state_m->capacity; }
+
+  /**
+   * \brief Process id of the client
+   */
+  pid_t client_pid() const { return (pid_t)state_m->client_pid.load(); }
+
+  /**
+   * \brief Reserve contiguous space for a request in the ring (client)
+   *
+   * Waits for the server to consume earlier requests if the ring is full.
+   *
+   * \param[in] size  Size of the request (multiple of 8, up to capacity())
+   * \param[in] alive Callable returning false once the server has exited
+   * \returns null if the server exited while waiting
+   */
+  template <class Alive>
+  char *reserve(std::size_t size, Alive alive)
+  {
+    uint64_t cap = 2 * state_m->capacity;
+    uint64_t head = state_m->head.load(std::memory_order_relaxed);
+    uint64_t pos = head % cap;
+    uint64_t skip = cap - pos < size ? cap - pos : 0; // pad to the start of the ring
+    for (int spins = 0; cap - (head - state_m->tail.load(std::memory_order_acquire)) < skip + size; ++spins)
+    {
+      // the ring is full: the server is busy with earlier requests
+      if (spins < 64)
+        std::this_thread::yield();
+      else if (!alive())
+        return NULL;
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    char *ring = state_m->ring.data();
+    pad_m = skip;
+    if (skip)
+    {
+      protocol::request marker = {};
+      marker.size = (uint32_t)skip;
+      marker.kind = protocol::pad;
+      std::memcpy(ring + pos, &marker, sizeof(marker.size) + sizeof(marker.kind));
+      return ring;
+    }
+    return ring + pos;
+  }
+
+  /**
+   * \brief Make the request written to the space of reserve() available to the server (client)
+   */
+  void commit(std::size_t size)
+  {
+    state_m->head.store(state_m->head.load(std::memory_order_relaxed) + pad_m + size, std::memory_order_release);
+    sem_post(&state_m->requests);
+  }
+
+  /**
+   * \brief Wait for the next request (server)
+   *
+   * \returns null if the client exited while waiting
+   */
+  template <class Alive>
+  const protocol::request *next(Alive alive)
+  {
+    if (!wait(&state_m->requests, alive))
+      return NULL;
+    uint64_t cap = 2 * state_m->capacity;
+    uint64_t tail = state_m->tail.load(std::memory_order_relaxed);
+    const char *ring = state_m->ring.data();
+    const protocol::request *req = (const protocol::request *)(ring + tail % cap);
+    if (req->kind == protocol::pad)
+    {
+      state_m->tail.store(tail + req->size, std::memory_order_release);
+      req = (const protocol::request *)ring;
+    }
+    return req;
+  }
+
+  /**
+   * \brief Release the space of the request returned by next() to the client (server)
+   */
+  void consume(const protocol::request *req)
+  {
+    state_m->tail.store(state_m->tail.load(std::memory_order_relaxed) + req->size, std::memory_order_release);
+  }
+
+  /**
+   * \brief Buffer of the response to a request with the reply flag
+   *
+   * Written by the server, then read by the client once respond() is called. The client
+   * waits for each response, so a single buffer suffices.
+   */
+  char *response() { return state_m->response.data(); }
+
+  /**
+   * \brief Signal the response written to response() (server)
+   */
+  void respond() { sem_post(&state_m->responses); }
+
+  /**
+   * \brief Wait for the response of the last request (client)
+   *
+   * \returns false if the server exited while waiting
+   */
+  template <class Alive>
+  bool wait_response(Alive alive) { return wait(&state_m->responses, alive); }
+
+private:
+  struct state
+  {
+    uint64_t capacity;             // size of the largest request and of the response buffer (half the ring)
+    mexSharedArray<char> ring;     // requests
+    mexSharedArray<char> response; // response to the last request with the reply flag
+    std::atomic<uint64_t> head;    // bytes written to the ring (by the client)
+    std::atomic<uint64_t> tail;    // bytes consumed from the ring (by the server)
+    std::atomic<int32_t> client_pid;
+    std::atomic<int32_t> server_pid; // 0 until the server attaches
+    sem_t requests;                // posted once per request
+    sem_t responses;               // posted once per response
+  };
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory requires address-free atomics.");
+
+  mexSharedSegment segment_m;
+  state *state_m;
+  uint64_t pad_m = 0; // size of the pad record written by the last reserve()
+
+  static uint64_t signature() { return 0x4d5852454d4f5431ull; } // "MXREMOT1"
+  static std::size_t segment_capacity(std::size_t capacity) { return (std::size_t)protocol::padded(std::max(capacity, (std::size_t)4096)); }
+
+  // wait on a semaphore, checking the other process every 100 ms
+  template <class Alive>
+  static bool wait(sem_t *sem, Alive alive)
+  {
+    for (;;)
+    {
+      timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += 100000000;
+      if (deadline.tv_nsec >= 1000000000)
+      {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+      }
+      if (!sem_timedwait(sem, &deadline))
+        return true;
+      if (errno != EINTR && errno != ETIMEDOUT)
+        throw mexRuntimeError("remote:channelFailed", "Failed to wait on the remote channel.");
+      if (errno == ETIMEDOUT && !alive())
+        return false;
+    }
+  }
+};
+
+/**
+ * \brief Array argument of a remote action (view into the request ring)
+ *
+ * Arguments are read in place, without a copy, and are valid until the action returns.
+ */
+class mexRemoteArray
+{
+public:
+  mexRemoteArray(const mexRemoteProtocol::array_header *header) : header_m(header) {}
+
+  /**
+   * \brief Element type
+   */
+  mexRemoteType type() const { return (mexRemoteType)header_m->type; }
+
+  /**
+   * \brief Dimensions
+   */
+  std::size_t ndims() const { return header_m->ndims; }
+  const uint64_t *dims() const { return (const uint64_t *)(header_m + 1); }
+  uint64_t dim(std::size_t i) const { return i < ndims() ? dims()[i] : 1; }
+
+  /**
+   * \brief Number of elements
+   */
+  std::size_t numel() const { return (std::size_t)(header_m->bytes / mexRemoteElementSize(header_m->type)); }
+  bool empty() const { return !header_m->bytes; }
+
+  /**
+   * \brief True if the elements are of type T
+   */
+  template <class T>
+  bool is() const { return header_m->type == mexRemoteTypeOf<T>::value; }
+
+  /**
+   * \brief Elements (in column-major order)
+   *
+   * \throws mexRuntimeError if the elements are not of type T
+   */
+  template <class T>
+  const T *data() const
+  {
+    if (!is<T>())
+      throw mexRuntimeError("remote:typeMismatch", "Remote argument is not of the expected type.");
+    return (const T *)(dims() + ndims());
+  }
+
+  /**
+   * \brief Value of a numeric or logical scalar
+   *
+   * \throws mexRuntimeError if the array is not a numeric or logical scalar
+   */
+  double scalar() const
+  {
+    if (numel() != 1 || header_m->type == mexRemoteChar)
+      throw mexRuntimeError("remote:notScalar", "Remote argument is not a numeric or logical scalar.");
+    const void *p = dims() + ndims();
+    switch (header_m->type)
+    {
+    case mexRemoteLogical: return *(const bool *)p;
+    case mexRemoteDouble: return *(const double *)p;
+    case mexRemoteSingle: return *(const float *)p;
+    case mexRemoteInt8: return *(const int8_t *)p;
+    case mexRemoteUint8: return *(const uint8_t *)p;
+    case mexRemoteInt16: return *(const int16_t *)p;
+    case mexRemoteUint16: return *(const uint16_t *)p;
+    case mexRemoteInt32: return *(const int32_t *)p;
+    case mexRemoteUint32: return *(const uint32_t *)p;
+    case mexRemoteInt64: return (double)*(const int64_t *)p;
+    default: return (double)*(const uint64_t *)p;
+    }
+  }
+
+  /**
+   * \brief Content of a char array as a UTF-8 string
+   *
+   * \throws mexRuntimeError if the array is not a char array
+   */
+  std::string string() const
+  {
+    if (!is<char16_t>())
+      throw mexRuntimeError("remote:notString", "Remote argument is not a char array.");
+    const char16_t *c = data<char16_t>(), *end = c + numel();
+    std::string str;
+    str.reserve(numel());
+    while (c != end)
+    {
+      uint32_t code = *c++;
+      if (code >= 0xD800 && code < 0xDC00 && c != end && *c >= 0xDC00 && *c < 0xE000) // surrogate pair
+        code = 0x10000 + ((code - 0xD800) << 10) + (*c++ - 0xDC00);
+      if (code < 0x80)
+        str += (char)code;
+      else if (code < 0x800)
+        str.append({(char)(0xC0 | code >> 6), (char)(0x80 | (code & 0x3F))});
+      else if (code < 0x10000)
+        str.append({(char)(0xE0 | code >> 12), (char)(0x80 | (code >> 6 & 0x3F)), (char)(0x80 | (code & 0x3F))});
+      else
+        str.append({(char)(0xF0 | code >> 18), (char)(0x80 | (code >> 12 & 0x3F)), (char)(0x80 | (code >> 6 & 0x3F)), (char)(0x80 | (code & 0x3F))});
+    }
+    return str;
+  }
+
+private:
+  const mexRemoteProtocol::array_header *header_m;
+};
+
+/**
+ * \brief Arguments of a remote action
+ */
+class mexRemoteArgs
+{
+public:
+  std::size_t size() const { return args_m.size(); }
+  bool empty() const { return args_m.empty(); }
+  const mexRemoteArray &operator[](std::size_t i) const { return args_m[i]; }
+
+  /**
+   * \brief Parse the arguments of a request (server)
+   *
+   * \returns the action name
+   */
+  std::string parse(const mexRemoteProtocol::request *req)
+  {
+    typedef mexRemoteProtocol protocol;
+    const char *p = (const char *)(req + 1), *end = (const char *)req + req->size;
+    if (req->name_length > (uint64_t)(end - p))
+      throw mexRuntimeError("remote:corruptRequest", "Remote request is truncated or corrupt.");
+    std::string name(p, (std::size_t)req->name_length);
+    p += protocol::padded(req->name_length);
+    args_m.clear();
+    for (uint32_t i = 0; i < req->nargs; ++i)
+    {
+      const protocol::array_header *header = (const protocol::array_header *)p;
+      if (p + sizeof(*header) > end || !mexRemoteElementSize(header->type) ||
+          (p += protocol::array_size(header->ndims, header->bytes)) > end)
+        throw mexRuntimeError("remote:corruptRequest", "Remote request is truncated or corrupt.");
+      args_m.emplace_back(header);
+    }
+    return name;
+  }
+
+private:
+  std::vector<mexRemoteArray> args_m;
+};
+
+/**
+ * \brief Outputs of a remote action, written directly to the response buffer of the channel
+ */
+class mexRemoteResults
+{
+public:
+  typedef mexRemoteProtocol protocol;
+
+  mexRemoteResults(char *buffer, std::size_t capacity, int nout)
+      : begin_m(buffer), ptr_m(buffer + sizeof(protocol::response)), end_m(buffer + capacity), nout_m(nout), count_m(0) {}
+
+  /**
+   * \brief Number of outputs requested by the caller (nargout, may be 0 for `ans`)
+   */
+  int nout() const { return nout_m; }
+
+  /**
+   * \brief Number of outputs added so far
+   */
+  std::size_t size() const { return count_m; }
+
+  /**
+   * \brief Add an uninitialized output array and return its elements to be filled
+   *
+   * The elements are in the shared-memory response buffer, so filling them is the only copy
+   * on the server side.
+   *
+   * \throws mexRuntimeError if the outputs do not fit in the response buffer
+   */
+  template <class T>
+  T *create(std::initializer_list<uint64_t> dims) { return (T *)add(mexRemoteTypeOf<T>::value, dims.begin(), dims.size()); }
+  template <class T>
+  T *create(uint64_t m, uint64_t n) { return create<T>({m, n}); }
+
+  /**
+   * \brief Add a scalar output
+   */
+  template <class T>
+  void scalar(T value) { *create<T>(1, 1) = value; }
+
+  /**
+   * \brief Add a char row vector output from a UTF-8 string
+   */
+  void string(const std::string &str)
+  {
+    std::u16string units;
+    units.reserve(str.size());
+    for (std::size_t i = 0; i < str.size();)
+    {
+      uint32_t c = (unsigned char)str[i++];
+      int extra = c < 0xC0 ? 0 : c < 0xE0 ? 1 : c < 0xF0 ? 2 : 3;
+      if (extra)
+        c &= 0x3F >> extra;
+      for (; extra && i < str.size(); --extra)
+        c = c << 6 | ((unsigned char)str[i++] & 0x3F);
+      if (c < 0x10000)
+        units += (char16_t)c;
+      else
+        units.append({(char16_t)(0xD800 + ((c - 0x10000) >> 10)), (char16_t)(0xDC00 + ((c - 0x10000) & 0x3FF))});
+    }
+    std::memcpy(create<char16_t>(1, units.size()), units.data(), units.size() * sizeof(char16_t));
+  }
+
+  /**
+   * \brief Complete the response with the given status (server)
+   */
+  void finish(uint32_t status)
+  {
+    protocol::response *res = (protocol::response *)begin_m;
+    res->size = (uint32_t)(ptr_m - begin_m);
+    res->status = status;
+    res->nout = (uint32_t)count_m;
+    res->reserved = 0;
+  }
+
+  /**
+   * \brief Replace the outputs with an error (server)
+   */
+  void fail(const char *id, const char *message)
+  {
+    std::size_t ilen = std::strlen(id), mlen = std::strlen(message);
+    mlen = std::min(mlen, (std::size_t)(end_m - begin_m) - sizeof(protocol::response) - protocol::string_size(ilen) - 8);
+    ptr_m = begin_m + sizeof(protocol::response);
+    count_m = 0;
+    ptr_m = protocol::put_string(ptr_m, id, ilen);
+    ptr_m = protocol::put_string(ptr_m, message, mlen);
+    finish(protocol::error);
+  }
+
+private:
+  char *begin_m;
+  char *ptr_m;
+  char *end_m;
+  int nout_m;
+  std::size_t count_m;
+
+  void *add(uint32_t type, const uint64_t *dims, std::size_t ndims)
+  {
+    uint64_t numel = 1;
+    for (std::size_t i = 0; i < ndims; ++i)
+      numel *= dims[i];
+    uint64_t bytes = numel * mexRemoteElementSize(type);
+    if (protocol::array_size(ndims, bytes) > (uint64_t)(end_m - ptr_m))
+      throw mexRuntimeError("remote:outputTooLarge", "Outputs of the remote action do not fit in the response buffer.");
+    protocol::array_header *header = (protocol::array_header *)ptr_m;
+    header->type = type;
+    header->ndims = (uint32_t)ndims;
+    header->bytes = bytes;
+    std::memcpy(header + 1, dims, ndims * sizeof(uint64_t));
+    ptr_m += protocol::array_size(ndims, bytes);
+    ++count_m;
+    return (uint64_t *)(header + 1) + ndims;
+  }
+};
+
+/**
+ * \brief Dispatch table type for the actions of a class run by mexRemoteServer
+ *
+ *    void serverClass::my_action(mexRemoteResults &out, const mexRemoteArgs &in);
+ */
+template <class serverClass>
+using mexRemoteActionTable = mexDispatchTable<void (serverClass::*)(mexRemoteResults &out, const mexRemoteArgs &in)>;
+
+/**
+ * \brief Dispatch table type for the static actions of a class run by mexRemoteServer
+ *
+ *    static void serverClass::my_static_action(mexRemoteResults &out, const mexRemoteArgs &in);
+ */
+typedef mexDispatchTable<void (*)(mexRemoteResults &out, const mexRemoteArgs &in)> mexRemoteStaticActionTable;
+
+/**
+ * \brief Type trait to check if serverClass defines `remote_static_action_table()`
+ */
+template <class serverClass, class = void>
+struct mexHasRemoteStaticActionTable : std::false_type
+{
+};
+template <class serverClass>
+struct mexHasRemoteStaticActionTable<serverClass, decltype((void)serverClass::remote_static_action_table())> : std::true_type
+{
+};
+
+/**
+ * \brief Request loop of the helper process running the objects of serverClass
+ *
+ * serverClass is a plain C++ class, independent of MATLAB:
+ *
+ *    class Model
+ *    {
+ *    public:
+ *      Model(const mexRemoteArgs &args);                               // create
+ *      static const mexRemoteActionTable<Model> &remote_action_table(); // object actions
+ *      static const mexRemoteStaticActionTable &remote_static_action_table(); // (optional)
+ *    };
+ *
+ * Objects are cloned with the copy constructor if serverClass is copy-constructible.
+ *
+ * An exception thrown by an action is returned to the client with its id. The error of a
+ * request that the client did not wait for (see mexRemoteClient::post()) is kept and
+ * reported in place of the next request the client waits for, which then is not run.
+ */
+template <class serverClass>
+class mexRemoteServer
+{
+public:
+  typedef mexRemoteProtocol protocol;
+
+  /**
+   * \brief Attach to the channel given by the client
+   */
+  explicit mexRemoteServer(const std::string &channel) : channel_m(channel), client_m(channel_m.client_pid()) {}
+
+  /**
+   * \brief Process the requests until shut down or until the client exits
+   */
+  int run()
+  {
+    auto alive = [this]() { return getppid() == client_m || !kill(client_m, 0); };
+    for (const protocol::request *req; (req = channel_m.next(alive));)
+    {
+      if (req->kind == protocol::shutdown)
+        return 0;
+      bool reply = req->flags & protocol::reply;
+      mexRemoteResults out(channel_m.response(), channel_m.capacity(), req->nout);
+      uint32_t status = protocol::ok;
+      std::string name;
+      try
+      {
+        if (reply && !deferred_id_m.empty())
+        {
+          mexRuntimeError deferred(deferred_id_m, deferred_msg_m);
+          deferred_id_m.clear(); // reported now
+          throw deferred;
+        }
+        name = args_m.parse(req);
+        status = dispatch(req, name, out);
+      }
+      catch (mexRuntimeError &e)
+      {
+        status = protocol::error;
+        fail(reply, out, e.id(), name, e.what());
+      }
+      catch (std::exception &e)
+      {
+        status = protocol::error;
+        fail(reply, out, "", name, e.what());
+      }
+      if (reply)
+      {
+        if (status != protocol::error)
+          out.finish(status);
+        channel_m.respond();
+      }
+      else if (status == protocol::unknown && deferred_id_m.empty())
+      {
+        deferred_id_m = "unknownAction";
+        deferred_msg_m = "Unknown action: " + name;
+      }
+      channel_m.consume(req);
+    }
+    return 1; // the client exited
+  }
+
+private:
+  mexRemoteChannel channel_m;
+  pid_t client_m;
+  mexRemoteArgs args_m;
+  std::unordered_map<uint64_t, std::unique_ptr<serverClass>> objects_m;
+  std::string deferred_id_m; // error of the first failed posted request
+  std::string deferred_msg_m;
+
+  uint32_t dispatch(const protocol::request *req, const std::string &name, mexRemoteResults &out)
+  {
+    switch (req->kind)
+    {
+    case protocol::create:
+    {
+      std::unique_ptr<serverClass> obj(new serverClass(args_m));
+      objects_m[req->target] = std::move(obj);
+      break;
+    }
+    case protocol::destroy:
+      objects_m.erase(req->object);
+      break;
+    case protocol::clone:
+    {
+      std::unique_ptr<serverClass> obj = clone(std::is_copy_constructible<serverClass>(), object(req->object));
+      objects_m[req->target] = std::move(obj);
+      break;
+    }
+    case protocol::action:
+    {
+      auto fcn = serverClass::remote_action_table().find(name);
+      if (!fcn)
+        return protocol::unknown;
+      (object(req->object).*fcn)(out, args_m);
+      break;
+    }
+    case protocol::static_action:
+      return static_action(mexHasRemoteStaticActionTable<serverClass>(), name, out);
+    case protocol::sync:
+      break;
+    default:
+      throw mexRuntimeError("remote:corruptRequest", "Unknown remote request.");
+    }
+    return protocol::ok;
+  }
+
+  serverClass &object(uint64_t id)
+  {
+    auto it = objects_m.find(id);
+    if (it == objects_m.end())
+      throw mexRuntimeError("invalidMexObjectHandle", "Remote object does not exist.");
+    return *it->second;
+  }
+
+  static std::unique_ptr<serverClass> clone(std::false_type, const serverClass &)
+  {
+    throw mexRuntimeError("clone:notSupported", "C++ class is not copy-constructible.");
+  }
+  static std::unique_ptr<serverClass> clone(std::true_type, const serverClass &obj) { return std::unique_ptr<serverClass>(new serverClass(obj)); }
+
+  uint32_t static_action(std::false_type, const std::string &, mexRemoteResults &) { return protocol::unknown; }
+  uint32_t static_action(std::true_type, const std::string &name, mexRemoteResults &out)
+  {
+    auto fcn = serverClass::remote_static_action_table().find(name);
+    if (!fcn)
+      return protocol::unknown;
+    fcn(out, args_m);
+    return protocol::ok;
+  }
+
+  void fail(bool reply, mexRemoteResults &out, const char *id, const std::string &name, const char *message)
+  {
+    if (reply)
+      out.fail(id, message);
+    else if (deferred_id_m.empty())
+    {
+      deferred_id_m = *id ? id : "remote:postedActionFailed";
+      deferred_msg_m = "Posted remote action " + name + " failed: " + message;
+    }
+  }
+};
+
+/**
+ * \brief Entry point of the helper process of serverClass
+ *
+ * The helper executable consists of serverClass and
+ *
+ *    int main(int argc, char *argv[]) { return mexRemoteServe<Model>(argc, argv); }
+ *
+ * It is launched by the MEX function (see mexRemoteClient) with the name of the channel.
+ */
+template <class serverClass>
+int mexRemoteServe(int argc, char *argv[])
+{
+  if (argc != 3 || std::strcmp(argv[1], "--mexutils-remote"))
+    return 2; // not launched by mexRemoteClient
+  try
+  {
+    return mexRemoteServer<serverClass>(argv[2]).run();
+  }
+  catch (std::exception &)
+  {
+    return 1;
+  }
+}
+
+#ifndef MEXUTILS_REMOTE_SERVER
+
+/**
+ * \brief Path of a file in the folder of the running MEX file
+ *
+ * \param[in] file Name of the file, e.g., of the helper executable
+ */
+inline std::string mexRemoteModulePath(const std::string &file)
+{
+  static const char anchor = 0; // an address in this MEX file
+  Dl_info info;
+  if (!dladdr(&anchor, &info) || !info.dli_fname)
+    throw mexRuntimeError("remote:pathNotFound", "Failed to locate the folder of the MEX file.");
+  std::string path(info.dli_fname);
+  std::size_t sep = path.rfind('/');
+  return (sep == std::string::npos ? std::string(".") : path.substr(0, sep)) + "/" + file;
+}
+
+/**
+ * \brief MEX side of a remote server: launches the helper process and forwards the requests
+ *
+ * The helper process is launched (with posix_spawn(), in its own process group so that Ctrl+C
+ * in MATLAB does not reach it) with the name of a new channel, and exits when the client is
+ * destroyed or when MATLAB exits. If the helper crashes, every pending and later request
+ * fails with the `remote:serverDied` error instead of taking MATLAB down.
+ *
+ * Arguments must be real full numeric, logical, or char arrays. They are copied once, from
+ * the mxArray into the request ring, and read in place by the server. Outputs are written in
+ * place to the response buffer by the server and copied once into new mxArrays.
+ *
+ * \note All member functions must be called from the MATLAB thread.
+ */
+class mexRemoteClient
+{
+public:
+  typedef mexRemoteProtocol protocol;
+
+  /**
+   * \brief Launch the helper process
+   *
+   * \param[in] server   Path of the helper executable (see mexRemoteModulePath())
+   * \param[in] capacity Size in bytes of the largest request and of the response buffer
+   * \throws mexRuntimeError if the channel cannot be created or the executable cannot be run
+   */
+  mexRemoteClient(const std::string &server, std::size_t capacity)
+      : channel_m(channel_name(), capacity), pid_m(0), exited_m(false), next_id_m(0)
+  {
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t none;
+    sigemptyset(&none);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+    std::string flag("--mexutils-remote"), name(channel_name_m);
+    char *argv[] = {(char *)server.c_str(), &flag[0], &name[0], NULL};
+    int rc = posix_spawn(&pid_m, server.c_str(), NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (rc)
+      throw mexRuntimeError("remote:launchFailed", "Failed to launch the remote server " + server + ": " + std::strerror(rc));
+  }
+
+  /**
+   * \brief Shut the helper process down
+   */
+  ~mexRemoteClient()
+  {
+    if (alive())
+    {
+      try
+      {
+        send(protocol::shutdown, 0, 0, 0);
+      }
+      catch (...)
+      {
+      }
+      for (int i = 0; i < 100 && alive(); ++i) // up to 1 s
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (alive())
+      {
+        kill(pid_m, SIGKILL);
+        waitpid(pid_m, NULL, 0);
+      }
+    }
+  }
+
+  mexRemoteClient(const mexRemoteClient &) = delete;
+  mexRemoteClient &operator=(const mexRemoteClient &) = delete;
+
+  /**
+   * \brief True while the helper process is running
+   */
+  bool alive()
+  {
+    if (exited_m)
+      return false;
+    int status;
+    pid_t rc = waitpid(pid_m, &status, WNOHANG);
+    if (rc == 0 || (rc < 0 && errno == ECHILD && !kill(pid_m, 0))) // ECHILD if MATLAB reaps its children
+      return true;
+    exited_m = true;
+    return false;
+  }
+
+  /**
+   * \brief Create a remote object
+   *
+   * \returns the id of the new object
+   */
+  uint64_t create(int nrhs, const mxArray *prhs[])
+  {
+    uint64_t id = ++next_id_m;
+    call(protocol::create, 0, id, "", 0, NULL, nrhs, prhs);
+    return id;
+  }
+
+  /**
+   * \brief Copy-construct a remote object
+   *
+   * \returns the id of the new object
+   */
+  uint64_t clone(uint64_t object)
+  {
+    uint64_t id = ++next_id_m;
+    call(protocol::clone, object, id, "", 0, NULL, 0, NULL);
+    return id;
+  }
+
+  /**
+   * \brief Destroy a remote object (without waiting for the server)
+   */
+  void destroy(uint64_t object) noexcept
+  {
+    try
+    {
+      if (alive())
+        send(protocol::destroy, 0, object, 0);
+    }
+    catch (...)
+    {
+    }
+  }
+
+  /**
+   * \brief Run an action and wait for its outputs
+   *
+   * \param[in] object Id of the object, or 0 for a static action
+   * \returns false if the action is unknown to the server
+   * \throws mexRuntimeError with the id of the exception thrown by the action
+   */
+  bool action(uint64_t object, const std::string &name, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    return call(object ? protocol::action : protocol::static_action, object, 0, name, nlhs, plhs, nrhs, prhs);
+  }
+
+  /**
+   * \brief Queue an action without outputs and return without waiting for the server
+   *
+   * Consecutive posted actions are run by the server while MATLAB goes on, so their IPC is
+   * amortized. An error of a posted action is reported by the next call that waits for the
+   * server (or by sync()).
+   */
+  void post(uint64_t object, const std::string &name, int nrhs, const mxArray *prhs[])
+  {
+    char *msg = write(object ? protocol::action : protocol::static_action, 0, object, 0, name, 0, nrhs, prhs);
+    channel_m.commit(((protocol::request *)msg)->size);
+  }
+
+  /**
+   * \brief Wait for the posted actions and report the first error among them
+   */
+  void sync() { call(protocol::sync, 0, 0, "", 0, NULL, 0, NULL); }
+
+private:
+  std::string channel_name_m;
+  mexRemoteChannel channel_m;
+  pid_t pid_m;
+  bool exited_m;
+  uint64_t next_id_m;
+
+  const std::string &channel_name()
+  {
+    static unsigned counter = 0;
+    channel_name_m = "mexremote_" + std::to_string(getpid()) + "_" + std::to_string(++counter);
+    return channel_name_m;
+  }
+
+  static uint32_t type_of(const mxArray *array)
+  {
+    switch (mxGetClassID(array))
+    {
+    case mxLOGICAL_CLASS: return mexRemoteLogical;
+    case mxCHAR_CLASS: return mexRemoteChar;
+    case mxDOUBLE_CLASS: return mexRemoteDouble;
+    case mxSINGLE_CLASS: return mexRemoteSingle;
+    case mxINT8_CLASS: return mexRemoteInt8;
+    case mxUINT8_CLASS: return mexRemoteUint8;
+    case mxINT16_CLASS: return mexRemoteInt16;
+    case mxUINT16_CLASS: return mexRemoteUint16;
+    case mxINT32_CLASS: return mexRemoteInt32;
+    case mxUINT32_CLASS: return mexRemoteUint32;
+    case mxINT64_CLASS: return mexRemoteInt64;
+    case mxUINT64_CLASS: return mexRemoteUint64;
+    default: return mexRemoteTypeCount;
+    }
+  }
+
+  static mxArray *to_mxarray(const mexRemoteArray &array)
+  {
+    static const mxClassID classes[mexRemoteTypeCount] = {mxLOGICAL_CLASS, mxCHAR_CLASS, mxDOUBLE_CLASS, mxSINGLE_CLASS,
+                                                          mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS,
+                                                          mxINT32_CLASS, mxUINT32_CLASS, mxINT64_CLASS, mxUINT64_CLASS};
+    std::vector<mwSize> dims(array.ndims() < 2 ? 2 : array.ndims(), 1);
+    for (std::size_t i = 0; i < array.ndims(); ++i)
+      dims[i] = (mwSize)array.dims()[i];
+    mxArray *out;
+    if (array.type() == mexRemoteLogical)
+      out = mxCreateLogicalArray(dims.size(), dims.data());
+    else if (array.type() == mexRemoteChar)
+      out = mxCreateCharArray(dims.size(), dims.data());
+    else
+      out = mxCreateNumericArray(dims.size(), dims.data(), classes[array.type()], mxREAL);
+    if (!array.empty())
+      std::memcpy(mxGetData(out), array.dims() + array.ndims(), array.numel() * mexRemoteElementSize(array.type()));
+    return out;
+  }
+
+  // write a request to the ring, returning its start
+  char *write(uint16_t kind, uint16_t flags, uint64_t object, uint64_t target, const std::string &name, int nout, int nrhs, const mxArray *prhs[])
+  {
+    if (exited_m)
+      throw mexRuntimeError("remote:serverDied", "Remote server has exited.");
+
+    uint64_t size = sizeof(protocol::request) + protocol::padded(name.size());
+    for (int i = 0; i < nrhs; ++i)
+    {
+      if (mxIsSparse(prhs[i]) || mxIsComplex(prhs[i]) || type_of(prhs[i]) == mexRemoteTypeCount)
+        throw mexRuntimeError("remote:unsupportedArgument", "Argument #" + std::to_string(i + 1) + " is not a real full numeric, logical, or char array.");
+      size += protocol::array_size(mxGetNumberOfDimensions(prhs[i]), mxGetNumberOfElements(prhs[i]) * mxGetElementSize(prhs[i]));
+    }
+    if (size > channel_m.capacity())
+      throw mexRuntimeError("remote:requestTooLarge", "Arguments do not fit in the remote channel.");
+
+    char *msg = channel_m.reserve((std::size_t)size, [this]() { return alive(); });
+    if (!msg)
+      throw mexRuntimeError("remote:serverDied", "Remote server has exited.");
+    protocol::request *req = (protocol::request *)msg;
+    req->size = (uint32_t)size;
+    req->kind = kind;
+    req->flags = flags;
+    req->object = object;
+    req->target = target;
+    req->nargs = (uint32_t)nrhs;
+    req->nout = nout;
+    req->name_length = name.size();
+    char *p = msg + sizeof(protocol::request);
+    std::memcpy(p, name.data(), name.size());
+    p += protocol::padded(name.size());
+    for (int i = 0; i < nrhs; ++i)
+    {
+      protocol::array_header *header = (protocol::array_header *)p;
+      std::size_t ndims = mxGetNumberOfDimensions(prhs[i]);
+      const mwSize *dims = mxGetDimensions(prhs[i]);
+      header->type = type_of(prhs[i]);
+      header->ndims = (uint32_t)ndims;
+      header->bytes = mxGetNumberOfElements(prhs[i]) * mxGetElementSize(prhs[i]);
+      uint64_t *wire_dims = (uint64_t *)(header + 1);
+      for (std::size_t d = 0; d < ndims; ++d)
+        wire_dims[d] = dims[d];
+      if (header->bytes)
+        std::memcpy(wire_dims + ndims, mxGetData(prhs[i]), (std::size_t)header->bytes); // the only copy of the argument
+      p += protocol::array_size(ndims, header->bytes);
+    }
+    return msg;
+  }
+
+  void send(uint16_t kind, uint64_t object, uint64_t target, int nrhs)
+  {
+    char *msg = write(kind, 0, object, target, "", 0, nrhs, NULL);
+    channel_m.commit(((protocol::request *)msg)->size);
+  }
+
+  bool call(uint16_t kind, uint64_t object, uint64_t target, const std::string &name, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    char *msg = write(kind, protocol::reply, object, target, name, nlhs, nrhs, prhs);
+    channel_m.commit(((protocol::request *)msg)->size);
+    if (!channel_m.wait_response([this]() { return alive(); }))
+      throw mexRuntimeError("remote:serverDied", "Remote server has exited while running the request.");
+
+    const char *p = channel_m.response();
+    const protocol::response *res = (const protocol::response *)p;
+    p += sizeof(protocol::response);
+    if (res->status == protocol::unknown)
+      return false;
+    if (res->status == protocol::error)
+    {
+      uint64_t len;
+      std::memcpy(&len, p, sizeof(len));
+      std::string id(p + sizeof(len), (std::size_t)len);
+      p += protocol::string_size((std::size_t)len);
+      std::memcpy(&len, p, sizeof(len));
+      throw mexRuntimeError(id, std::string(p + sizeof(len), (std::size_t)len));
+    }
+
+    // outputs: at least one for `ans`, the extra ones are dropped
+    uint32_t nout = std::min(res->nout, (uint32_t)(nlhs > 0 ? nlhs : 1));
+    for (uint32_t i = 0; i < nout && plhs; ++i)
+    {
+      mexRemoteArray array((const protocol::array_header *)p);
+      plhs[i] = to_mxarray(array);
+      p += protocol::array_size(array.ndims(), array.numel() * mexRemoteElementSize(array.type()));
+    }
+    return true;
+  }
+};
+
+/**
+ * \brief Type trait of the size of the largest request and of the response buffer
+ *
+ * T::remote_buffer_size if T defines `static const std::size_t remote_buffer_size`, or 32 MiB.
+ */
+template <class T, class = void>
+struct mexRemoteBufferSize : std::integral_constant<std::size_t, (std::size_t)32 << 20>
+{
+};
+template <class T>
+struct mexRemoteBufferSize<T, decltype((void)T::remote_buffer_size)> : std::integral_constant<std::size_t, T::remote_buffer_size>
+{
+};
+
+/**
+ * \brief Type trait to check if actions without outputs may be posted instead of waited for
+ *
+ * True if T defines `static const bool remote_post_actions = true`.
+ */
+template <class T, class = void>
+struct mexRemotePostActions : std::false_type
+{
+};
+template <class T>
+struct mexRemotePostActions<T, decltype((void)T::remote_post_actions)> : std::integral_constant<bool, T::remote_post_actions>
+{
+};
+
+/**
+ * \brief Wrapped class of mexObjectHandler forwarding all the actions to a helper process
+ *
+ * The MATLAB class (derived from mexcpp.BaseClass) and its mexFunction are the same as for a
+ * local class, but the C++ objects live in a helper process running mexRemoteServer. A crash
+ * or the memory use of the objects is then confined to the helper. The proxy class only
+ * names the MATLAB class and the helper executable:
+ *
+ *    class Model : public mexRemoteProxy<Model>
+ *    {
+ *    public:
+ *      using mexRemoteProxy<Model>::mexRemoteProxy;
+ *      static std::string get_classname() { return "Model"; }
+ *      static std::string remote_server() { return mexRemoteModulePath("Model_server"); }
+ *    };
+ *
+ *    void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+ *    {
+ *      mexObjectHandler<Model>(nlhs, plhs, nrhs, prhs);
+ *    }
+ *
+ * Object and static actions, including those of the built-in batch and broadcast actions, are
+ * run by the server. The built-in clone action copy-constructs the remote object. All the
+ * objects of the MEX function share one helper process, launched by the first construction
+ * and shut down when MATLAB clears the MEX function. If the helper crashes, its objects fail
+ * with `remote:serverDied` and the next construction launches a new helper.
+ *
+ * If Derived defines `static const bool remote_post_actions = true`, actions called without
+ * outputs are posted (see mexRemoteClient::post()): MATLAB does not wait for them, and their
+ * errors are reported by the next call that returns outputs. Derived may also define
+ * `static const std::size_t remote_buffer_size` to change the 32-MiB default size of the
+ * largest request and of the response buffer (the request ring is twice as large).
+ *
+ * \tparam Derived Proxy class defining `get_classname()` and `remote_server()`
+ */
+template <class Derived>
+class mexRemoteProxy
+{
+public:
+  mexRemoteProxy(const mxArray *mxObj, int nrhs, const mxArray *prhs[]) : client_m(client()), id_m(client_m->create(nrhs, prhs)) {}
+  mexRemoteProxy(const mexRemoteProxy &other) : client_m(other.client_m), id_m(client_m->clone(other.id_m)) {}
+  ~mexRemoteProxy() { client_m->destroy(id_m); }
+  mexRemoteProxy &operator=(const mexRemoteProxy &) = delete;
+
+  /**
+   * \brief Forward an object action to the remote object
+   */
+  bool action_handler(const mxArray *mxObj, const std::string &action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    if (nlhs == 0 && mexRemotePostActions<Derived>::value)
+    {
+      client_m->post(id_m, action, nrhs, prhs);
+      return true;
+    }
+    return client_m->action(id_m, action, nlhs, plhs, nrhs, prhs);
+  }
+
+  /**
+   * \brief Forward a static action to the helper process
+   */
+  static bool static_handler(std::string action, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+  {
+    return client()->action(0, action, nlhs, plhs, nrhs, prhs);
+  }
+
+  /**
+   * \brief Connection to the helper process
+   */
+  mexRemoteClient &remote() { return *client_m; }
+
+private:
+  std::shared_ptr<mexRemoteClient> client_m;
+  uint64_t id_m;
+
+  // the running helper process (launched on demand)
+  static std::shared_ptr<mexRemoteClient> client()
+  {
+    static std::shared_ptr<mexRemoteClient> current;
+    static bool registered = false;
+    if (!registered)
+    {
+      mexOnExit([]() { current.reset(); });
+      registered = true;
+    }
+    if (!current || !current->alive())
+      current = std::make_shared<mexRemoteClient>(Derived::remote_server(), mexRemoteBufferSize<Derived>::value);
+    return current;
+  }
+};
+
+#endif
@@ -1,31 +1,52 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <stdexcept>
 
 /**
  * \brief mexErrMsgAndTxt friendly runtime exception class
+ *
+ * The error id is kept in an internal buffer (up to max_id_length characters, longer ids
+ * are truncated), so constructing or copying the exception makes no heap allocation for
+ * the id.
  */
 class mexRuntimeError : public std::runtime_error
 {
 public:
+  static const std::size_t max_id_length = 127; // longer ids are truncated
+
   mexRuntimeError(char const *const message) throw() : std::runtime_error(message)
   {
+    id_buf[0] = '\0';
   }
-  mexRuntimeError(char const *ident, char const *const message) throw() : std::runtime_error(message), id_str(ident)
+  mexRuntimeError(char const *ident, char const *const message) throw() : std::runtime_error(message)
   {
+    set_id(ident);
   }
-  mexRuntimeError(std::string &message) throw() : std::runtime_error(message.c_str())
+  mexRuntimeError(const std::string &message) throw() : std::runtime_error(message.c_str())
   {
+    id_buf[0] = '\0';
   }
-  mexRuntimeError(std::string &ident, std::string &message) throw() : std::runtime_error(message.c_str()), id_str(ident)
+  mexRuntimeError(const std::string &ident, const std::string &message) throw() : std::runtime_error(message.c_str())
   {
+    set_id(ident.c_str());
   }
-  mexRuntimeError(std::string &ident, char const *const message) throw() : std::runtime_error(message), id_str(ident)
+  mexRuntimeError(const std::string &ident, char const *const message) throw() : std::runtime_error(message)
   {
+    set_id(ident.c_str());
   }
-  virtual char const *id() const throw() { return id_str.c_str(); }
+
+  virtual char const *id() const throw() { return id_buf; }
 
 private:
-  std::string id_str;
+  char id_buf[max_id_length + 1];
+
+  void set_id(char const *ident)
+  {
+    std::size_t n = 0;
+    for (; ident && *ident && n < max_id_length; ++ident)
+      id_buf[n++] = *ident;
+    id_buf[n] = '\0';
+  }
 };
@@ -0,0 +1,217 @@
+/** \file mexScratchArena.h
+ * C++ header file containing the per-call scratch memory arena used by mexObjectHandler
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \brief Bump-pointer arena for temporary memory of a MEX call
+ *
+ * mexScratchArena hands out memory by advancing a pointer within large blocks, and
+ * releases it all at once by rewinding the pointer to a previously taken mark. The
+ * blocks are kept for the following calls, so a steady state of a MEX function makes
+ * no heap allocation for its temporary buffers at all.
+ *
+ * mexObjectHandler() opens a \ref mexScratchScope for every call, so the memory obtained
+ * from the module arena (instance()) during an action is reclaimed in O(1) when the
+ * action returns or throws. Actions may also open nested scopes for their own phases.
+ * Because the scopes only rewind to their own marks, reentrant MEX calls (e.g., via
+ * mexCallMATLAB) do not disturb the memory of the outer call.
+ *
+ * Memory is uninitialized and no destructor is ever run, so only place trivially
+ * destructible data in the arena (or use \ref mexScratchAllocator with containers whose
+ * lifetime is within the scope).
+ *
+ * \note Use from the MATLAB thread only.
+ */
+class mexScratchArena
+{
+public:
+  /**
+   * \brief Position in the arena to be rewound to
+   */
+  struct marker
+  {
+    std::size_t block; // index of the current block
+    char *ptr;         // next free byte in the current block
+  };
+
+  /**
+   * \brief Scratch arena of the MEX module
+   */
+  static mexScratchArena &instance()
+  {
+    static mexScratchArena arena;
+    return arena;
+  }
+
+  /**
+   * \param[in] block_size Minimum size of the blocks in bytes
+   */
+  explicit mexScratchArena(std::size_t block_size = 64 * 1024) : block_size_m(block_size), cur_m(0), ptr_m(NULL), end_m(NULL) {}
+  ~mexScratchArena()
+  {
+    for (auto &b : blocks_m)
+      std::free(b.data);
+  }
+
+  mexScratchArena(const mexScratchArena &) = delete;
+  mexScratchArena &operator=(const mexScratchArena &) = delete;
+
+  /**
+   * \brief Allocate uninitialized memory
+   *
+   * \param[in] bytes Number of bytes
+   * \param[in] align Alignment (power of 2)
+   * \throws std::bad_alloc if a new block cannot be allocated
+   */
+  void *allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t))
+  {
+    char *p = align_up(ptr_m, align);
+    if (!ptr_m || p > end_m || (std::size_t)(end_m - p) < bytes)
+      p = next_block(bytes + align - 1, align);
+    ptr_m = p + bytes;
+    return p;
+  }
+
+  /**
+   * \brief Allocate an uninitialized array of n elements of type T
+   */
+  template <typename T>
+  T *allocate_array(std::size_t n)
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "mexScratchArena does not run destructors.");
+    return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /**
+   * \brief Current position to be passed to rewind()
+   */
+  marker mark() const { return {cur_m, ptr_m}; }
+
+  /**
+   * \brief Release all memory allocated since the mark was taken
+   */
+  void rewind(const marker &m)
+  {
+    cur_m = m.block;
+    ptr_m = m.ptr;
+    end_m = ptr_m ? blocks_m[cur_m].data + blocks_m[cur_m].size : NULL;
+  }
+
+  /**
+   * \brief Release all memory
+   */
+  void reset() { rewind({0, NULL}); }
+
+  /**
+   * \brief Total size of the blocks held by the arena in bytes
+   */
+  std::size_t capacity() const
+  {
+    std::size_t n = 0;
+    for (auto &b : blocks_m)
+      n += b.size;
+    return n;
+  }
+
+private:
+  struct block
+  {
+    char *data;
+    std::size_t size;
+  };
+
+  std::size_t block_size_m;   // minimum block size
+  std::vector<block> blocks_m; // all blocks in the order of use
+  std::size_t cur_m;          // index of the current block (valid if ptr_m)
+  char *ptr_m;                // next free byte in the current block (NULL before the first block is used)
+  char *end_m;                // end of the current block
+
+  static char *align_up(char *p, std::size_t align)
+  {
+    return (char *)(((uintptr_t)p + (align - 1)) & ~(uintptr_t)(align - 1));
+  }
+
+  // move to the next block which can hold the requested bytes (allocating one if necessary)
+  char *next_block(std::size_t bytes, std::size_t align)
+  {
+    std::size_t next = ptr_m ? cur_m + 1 : 0;
+    if (next == blocks_m.size() || blocks_m[next].size < bytes) // insert a new block
+    {
+      std::size_t size = bytes > block_size_m ? bytes : block_size_m;
+      blocks_m.reserve(blocks_m.size() + 1);
+      char *data = static_cast<char *>(std::malloc(size));
+      if (!data)
+        throw std::bad_alloc();
+      blocks_m.insert(blocks_m.begin() + next, {data, size});
+    }
+    cur_m = next;
+    ptr_m = blocks_m[next].data;
+    end_m = ptr_m + blocks_m[next].size;
+    return align_up(ptr_m, align);
+  }
+};
+
+/**
+ * \brief RAII scope of mexScratchArena memory
+ *
+ * All memory allocated from the arena during the lifetime of the scope is released
+ * when the scope is destroyed, including when an exception unwinds the stack.
+ *
+ *    {
+ *      mexScratchScope scope;
+ *      double *tmp = mexScratchArena::instance().allocate_array<double>(n);
+ *      ...
+ *    } // tmp is released here
+ */
+class mexScratchScope
+{
+public:
+  explicit mexScratchScope(mexScratchArena &arena = mexScratchArena::instance()) : arena_m(arena), mark_m(arena.mark()) {}
+  ~mexScratchScope() { arena_m.rewind(mark_m); }
+
+  mexScratchScope(const mexScratchScope &) = delete;
+  mexScratchScope &operator=(const mexScratchScope &) = delete;
+
+  /**
+   * \brief Release the memory allocated within this scope so far
+   */
+  void rewind() { arena_m.rewind(mark_m); }
+
+private:
+  mexScratchArena &arena_m;
+  mexScratchArena::marker mark_m;
+};
+
+/**
+ * \brief C++ Allocator drawing from the module scratch arena
+ *
+ * deallocate() is a no-op; the memory is reclaimed when the enclosing \ref mexScratchScope
+ * ends. Hence, a container using this allocator must be destroyed within the scope in which
+ * it was created, e.g., a local variable of an action:
+ *
+ *    std::vector<double, mexScratchAllocator<double>> tmp(n);
+ */
+template <typename T>
+struct mexScratchAllocator
+{
+  using value_type = T;
+  using pointer = T *;
+  mexScratchAllocator() {}
+  template <typename U>
+  mexScratchAllocator(const mexScratchAllocator<U> &) {}
+  pointer allocate(std::size_t n) { return static_cast<pointer>(mexScratchArena::instance().allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(pointer p, std::size_t n) {}
+  template <typename U>
+  bool operator==(mexScratchAllocator<U> const &rhs) const { return true; }
+  template <typename U>
+  bool operator!=(mexScratchAllocator<U> const &rhs) const { return false; }
+};
@@ -0,0 +1,637 @@
+/** \file mexSerializer.h
+ * C++ header file containing the binary serialization of C++ objects to uint8 mxArrays
+ */
+
+#pragma once
+
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+#include "mexVector.h"       // for bulk serialization of mexVector fields
+
+#include <mex.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef MEXUTILS_USE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * \brief Header of a serialized blob (also the format documentation)
+ *
+ * A blob is a uint8 row vector: this 24-byte header followed by the payload. The payload
+ * is the sequence of the fields visited by `serialize()`, in the native byte order without
+ * any padding. Strings and containers are prefixed by their uint64 element counts. If the
+ * blob is compressed, the payload is a zlib stream of stored_size bytes.
+ *
+ * A segmented blob (format 2, see mexSerialCache) is a sequence of named segments instead:
+ * for each, its uint64 name length, the name, its uint64 size, and its fields.
+ */
+struct mexSerialHeader
+{
+  char magic[4];         // "MXSB"
+  uint16_t format;       // format version of the blob layout (mexSerialHeader::current_format)
+  uint16_t flags;        // mexSerialHeader::compressed, segmented, and delta
+  uint32_t version;      // class version given by the user
+  uint32_t byte_order;   // 0x01020304 in the native byte order of the writer
+  uint64_t payload_size; // uncompressed payload size in bytes
+
+  static const uint16_t current_format = 2;   // latest format that can be read
+  static const uint16_t plain_format = 1;     // format of the blobs of mexSerialize()
+  static const uint16_t segmented_format = 2; // format of the blobs of mexSerialCache
+  static const uint16_t compressed = 1;
+  static const uint16_t segmented = 2;
+  static const uint16_t delta = 4; // only the segments modified since the previous save
+};
+static_assert(sizeof(mexSerialHeader) == 24, "mexSerialHeader must not be padded.");
+
+/**
+ * \brief Base of the serialization archives
+ *
+ * An archive is passed to the `serialize()` member function template of a serializable
+ * class, which lists the fields to be saved or loaded with one code path:
+ *
+ *    template <class Archive>
+ *    void serialize(Archive &ar)
+ *    {
+ *      ar(VarA, VarB, VarC);                  // saved/loaded in this order
+ *      if (ar.version() > 1) ar(VarD);        // fields added in class version 2
+ *    }
+ *
+ * The supported field types are arithmetic and enum types, std::string, std::vector and
+ * mexVector of any supported type (bulk copied if trivially copyable), std::pair, and
+ * classes with their own `serialize()`.
+ *
+ * \tparam Derived Archive class implementing `raw(void *data, std::size_t bytes)`
+ *                 and `expect(uint64_t bytes)`
+ */
+template <class Derived>
+class mexArchive
+{
+public:
+  explicit mexArchive(uint32_t version) : version_m(version) {}
+
+  /**
+   * \brief Class version being saved or loaded
+   */
+  uint32_t version() const { return version_m; }
+
+  /**
+   * \brief Visit the fields in the given order
+   */
+  template <class... Ts>
+  Derived &operator()(Ts &... fields)
+  {
+    int visit[] = {0, (field(fields), 0)...};
+    (void)visit;
+    return static_cast<Derived &>(*this);
+  }
+
+private:
+  uint32_t version_m;
+
+  Derived &self() { return static_cast<Derived &>(*this); }
+
+  template <class T>
+  void field(T &value) { field(value, category<T>()); }
+
+  // dispatch categories
+  struct bits_tag {};
+  struct object_tag {};
+  template <class T>
+  using category = typename std::conditional<std::is_arithmetic<T>::value || std::is_enum<T>::value, bits_tag, object_tag>::type;
+
+  template <class T>
+  void field(T &value, bits_tag) { self().raw(&value, sizeof(T)); }
+  template <class T>
+  void field(T &value, object_tag) { value.serialize(self()); }
+
+  uint64_t count(std::size_t n, std::size_t elsize)
+  {
+    uint64_t len = n;
+    self().raw(&len, sizeof(len));
+    self().expect(len * elsize); // let the reader reject a corrupt count before allocating
+    return len;
+  }
+
+  void field(std::string &value, object_tag)
+  {
+    uint64_t len = count(value.size(), 1);
+    if (Derived::loading)
+      value.resize((std::size_t)len);
+    if (len)
+      self().raw(&value[0], (std::size_t)len);
+  }
+
+  template <class T>
+  void field(std::vector<T> &value, object_tag)
+  {
+    uint64_t len = count(value.size(), std::is_arithmetic<T>::value ? sizeof(T) : 1);
+    if (Derived::loading)
+      value.resize((std::size_t)len);
+    elements(value.data(), (std::size_t)len, category<T>());
+  }
+
+  template <class T>
+  void field(mexVector<T> &value, object_tag)
+  {
+    uint64_t len = count(value.size(), sizeof(T));
+    if (Derived::loading)
+      value.resize((std::size_t)len);
+    elements(value.data(), (std::size_t)len, category<T>());
+  }
+
+  template <class T, class U>
+  void field(std::pair<T, U> &value, object_tag)
+  {
+    field(value.first);
+    field(value.second);
+  }
+
+  template <class T>
+  void elements(T *data, std::size_t n, bits_tag)
+  {
+    if (n)
+      self().raw(data, n * sizeof(T));
+  }
+  template <class T>
+  void elements(T *data, std::size_t n, object_tag)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      field(data[i]);
+  }
+};
+
+/**
+ * \brief Archive to compute the payload size (first pass of saving)
+ */
+class mexSizeArchive : public mexArchive<mexSizeArchive>
+{
+public:
+  static const bool loading = false;
+  explicit mexSizeArchive(uint32_t version) : mexArchive<mexSizeArchive>(version), size_m(0) {}
+  void raw(const void *, std::size_t bytes) { size_m += bytes; }
+  void expect(uint64_t) {}
+  uint64_t size() const { return size_m; }
+
+private:
+  uint64_t size_m;
+};
+
+/**
+ * \brief Archive to write the payload to a preallocated buffer (second pass of saving)
+ */
+class mexWriteArchive : public mexArchive<mexWriteArchive>
+{
+public:
+  static const bool loading = false;
+  mexWriteArchive(uint32_t version, char *buffer) : mexArchive<mexWriteArchive>(version), ptr_m(buffer) {}
+  void raw(const void *data, std::size_t bytes)
+  {
+    std::memcpy(ptr_m, data, bytes);
+    ptr_m += bytes;
+  }
+  void expect(uint64_t) {}
+
+private:
+  char *ptr_m;
+};
+
+/**
+ * \brief Archive to read the payload from a buffer
+ *
+ * Every read is bounds-checked.
+ */
+class mexReadArchive : public mexArchive<mexReadArchive>
+{
+public:
+  static const bool loading = true;
+  mexReadArchive(uint32_t version, const char *data, uint64_t size) : mexArchive<mexReadArchive>(version), ptr_m(data), end_m(data + size) {}
+  void raw(void *data, std::size_t bytes)
+  {
+    expect(bytes);
+    std::memcpy(data, ptr_m, bytes);
+    ptr_m += bytes;
+  }
+  void expect(uint64_t bytes)
+  {
+    if (bytes > (uint64_t)(end_m - ptr_m))
+      throw mexRuntimeError("load:corruptData", "Serialized data is truncated or corrupt.");
+  }
+  uint64_t remaining() const { return end_m - ptr_m; }
+  void skip(uint64_t bytes)
+  {
+    expect(bytes);
+    ptr_m += bytes;
+  }
+
+private:
+  const char *ptr_m;
+  const char *end_m;
+};
+
+/**
+ * \brief Serialize an object to a uint8 mxArray
+ *
+ * The payload size is computed first, then the fields are written directly into the data
+ * of the returned mxArray, so no intermediate mxArray or buffer is created (except when
+ * compressed, which requires a temporary buffer of the uncompressed payload).
+ *
+ * \param[in] obj      Object with `template <class Archive> void serialize(Archive &)`
+ * \param[in] version  Class version to be stored (available as `ar.version()` on loading)
+ * \param[in] compress True to compress the payload with zlib (requires MEXUTILS_USE_ZLIB)
+ * \returns 1-by-N uint8 mxArray blob
+ *
+ * \throws mexRuntimeError if compression is requested but not available
+ */
+template <class T>
+mxArray *mexSerialize(T &obj, uint32_t version = 0, bool compress = false)
+{
+  mexSizeArchive sizer(version);
+  obj.serialize(sizer);
+  uint64_t payload = sizer.size();
+
+  mexSerialHeader header = {{'M', 'X', 'S', 'B'}, mexSerialHeader::plain_format, 0, version, 0x01020304, payload};
+
+  if (!compress)
+  {
+#ifdef MATLAB_PRE_R2015A
+    mxArray *blob = mxCreateNumericMatrix(1, (mwSize)(sizeof(header) + payload), mxUINT8_CLASS, mxREAL);
+#else
+    mxArray *blob = mxCreateUninitNumericMatrix(1, (mwSize)(sizeof(header) + payload), mxUINT8_CLASS, mxREAL);
+#endif
+    char *data = (char *)mxGetData(blob);
+    std::memcpy(data, &header, sizeof(header));
+    mexWriteArchive writer(version, data + sizeof(header));
+    obj.serialize(writer);
+    return blob;
+  }
+
+#ifdef MEXUTILS_USE_ZLIB
+  // serialize to a temporary buffer, then compress directly to the blob data
+  std::vector<char> buffer((std::size_t)payload);
+  mexWriteArchive writer(version, buffer.data());
+  obj.serialize(writer);
+
+  uLongf stored = compressBound((uLong)payload);
+  char *data = (char *)mxMalloc(sizeof(header) + stored);
+  if (compress2((Bytef *)data + sizeof(header), &stored, (const Bytef *)buffer.data(), (uLong)payload, Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    mxFree(data);
+    throw mexRuntimeError("save:compressionFailed", "Failed to compress the serialized data.");
+  }
+  header.flags = mexSerialHeader::compressed;
+  std::memcpy(data, &header, sizeof(header));
+  data = (char *)mxRealloc(data, sizeof(header) + stored); // trim
+
+  mxArray *blob = mxCreateNumericMatrix(0, 0, mxUINT8_CLASS, mxREAL);
+  mxSetData(blob, data);
+  mxSetM(blob, 1);
+  mxSetN(blob, (mwSize)(sizeof(header) + stored));
+  return blob;
+#else
+  throw mexRuntimeError("save:compressionUnavailable", "mexutils is built without zlib (MEXUTILS_USE_ZLIB).");
+#endif
+}
+
+/**
+ * \brief Read the header of serialized data in memory
+ *
+ * \param[in] data Serialized data
+ * \param[in] size Size of \p data in bytes
+ * \throws mexRuntimeError if \p data does not start with a valid header
+ */
+inline mexSerialHeader mexSerialHeaderOf(const void *data, uint64_t size)
+{
+  mexSerialHeader header;
+  if (size < sizeof(header))
+    throw mexRuntimeError("load:invalidData", "Serialized data must be produced by mexSerialize().");
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, "MXSB", 4))
+    throw mexRuntimeError("load:invalidData", "Serialized data must be produced by mexSerialize().");
+  if (header.format > mexSerialHeader::current_format)
+    throw mexRuntimeError("load:unsupportedFormat", "Serialized data was written by a newer version of mexutils.");
+  if (header.byte_order != 0x01020304)
+    throw mexRuntimeError("load:unsupportedFormat", "Serialized data was written on a machine with another byte order.");
+  return header;
+}
+
+/**
+ * \brief Read the header of a serialized blob
+ *
+ * \throws mexRuntimeError if \p blob is not a valid blob
+ */
+inline mexSerialHeader mexSerialHeaderOf(const mxArray *blob)
+{
+  if (!blob || mxGetClassID(blob) != mxUINT8_CLASS || mxIsComplex(blob))
+    throw mexRuntimeError("load:invalidData", "Serialized data must be a uint8 array produced by mexSerialize().");
+  return mexSerialHeaderOf(mxGetData(blob), mxGetNumberOfElements(blob));
+}
+
+/**
+ * \brief Deserialize an object from serialized data in memory
+ *
+ * \param[in]    bytes Serialized data (header and payload, e.g., a memory-mapped file)
+ * \param[in]    nbytes Size of \p bytes
+ * \param[inout] obj   Object with `template <class Archive> void serialize(Archive &)`
+ * \returns the class version stored in \p bytes
+ *
+ * \throws mexRuntimeError if \p bytes is invalid, corrupt, or compressed without zlib support
+ */
+template <class T>
+uint32_t mexDeserialize(const void *bytes, uint64_t nbytes, T &obj)
+{
+  mexSerialHeader header = mexSerialHeaderOf(bytes, nbytes);
+  const char *data = (const char *)bytes + sizeof(header);
+  uint64_t size = nbytes - sizeof(header);
+  if (header.flags & mexSerialHeader::segmented)
+    throw mexRuntimeError("load:segmentedData", "Serialized data is segmented: read it with mexSegmentReader.");
+
+  if (header.flags & mexSerialHeader::compressed)
+  {
+#ifdef MEXUTILS_USE_ZLIB
+    std::vector<char> buffer((std::size_t)header.payload_size);
+    uLongf len = (uLongf)header.payload_size;
+    if (uncompress((Bytef *)buffer.data(), &len, (const Bytef *)data, (uLong)size) != Z_OK || len != header.payload_size)
+      throw mexRuntimeError("load:corruptData", "Failed to decompress the serialized data.");
+    mexReadArchive reader(header.version, buffer.data(), len);
+    obj.serialize(reader);
+    return header.version;
+#else
+    throw mexRuntimeError("load:compressionUnavailable", "Serialized data is compressed, but mexutils is built without zlib (MEXUTILS_USE_ZLIB).");
+#endif
+  }
+
+  if (size != header.payload_size)
+    throw mexRuntimeError("load:corruptData", "Serialized data is truncated or corrupt.");
+  mexReadArchive reader(header.version, data, size);
+  obj.serialize(reader);
+  return header.version;
+}
+
+/**
+ * \brief Deserialize an object from a uint8 mxArray created by mexSerialize()
+ *
+ * \param[in]    blob Serialized data
+ * \param[inout] obj  Object with `template <class Archive> void serialize(Archive &)`
+ * \returns the class version stored in \p blob
+ *
+ * \throws mexRuntimeError if \p blob is invalid, corrupt, or compressed without zlib support
+ */
+template <class T>
+uint32_t mexDeserialize(const mxArray *blob, T &obj)
+{
+  if (!blob || mxGetClassID(blob) != mxUINT8_CLASS || mxIsComplex(blob))
+    throw mexRuntimeError("load:invalidData", "Serialized data must be a uint8 array produced by mexSerialize().");
+  return mexDeserialize(mxGetData(blob), mxGetNumberOfElements(blob), obj);
+}
+
+/**
+ * \brief Cache of serialized segments for incremental saving
+ *
+ * The state of an object is divided into named segments (e.g., a segment per large member).
+ * Each segment is serialized only if its generation (e.g., mexSetGetClass::modified_generation())
+ * differs from the one it was cached at, and otherwise reused as cached. save() then assembles
+ * the blob from the cached bytes, either with all the segments or, as a delta, with only the
+ * segments given as dirty since the previous save():
+ *
+ *    mxArray *save(bool delta)
+ *    {
+ *      cache.segment("VarA", modified_generation("VarA"), is_dirty("VarA"), VarA)
+ *           .segment("Table", modified_generation("Table"), is_dirty("Table"), Table, Index); // multiple fields per segment
+ *      return cache.save(delta);
+ *    }
+ *
+ * The blob is read with mexSegmentReader, which loads the segments present in it. Loading the
+ * last full save followed by the later deltas in order restores the latest state.
+ *
+ * A segment must always be given the same fields in the same order. Compression is not
+ * supported.
+ *
+ * \note The cache keeps a serialized copy of every segment, i.e., it doubles the memory held
+ *       by the saved state for the lifetime of the object. A copy of the cache starts empty, so
+ *       copying (e.g., cloning) an object does not copy the serialized bytes.
+ * \note The cache must be cleared (see clear()) whenever the fields change without a new
+ *       generation, notably on loading: mexSetGetClass::modified_generation() is unchanged by
+ *       a load, so the cached bytes of the state before the load would be reused.
+ */
+class mexSerialCache
+{
+public:
+  /**
+   * \param[in] version Class version to be stored (available as `ar.version()` on loading)
+   */
+  explicit mexSerialCache(uint32_t version = 0) : version_m(version) {}
+  mexSerialCache(const mexSerialCache &other) : version_m(other.version_m) {} // starts empty
+  mexSerialCache(mexSerialCache &&) = default;
+  mexSerialCache &operator=(const mexSerialCache &other)
+  {
+    version_m = other.version_m;
+    segments_m.clear();
+    return *this;
+  }
+  mexSerialCache &operator=(mexSerialCache &&) = default;
+
+  /**
+   * \brief Serialize a segment if not cached at its generation
+   *
+   * \param[in] name       Name of the segment
+   * \param[in] generation Generation of the fields, which must change whenever they are modified
+   * \param[in] dirty      True if the fields are modified since the last save (to include in a delta)
+   * \param[in] fields     Fields of the segment, as listed by a `serialize()` member function
+   */
+  template <class... Ts>
+  mexSerialCache &segment(const std::string &name, uint64_t generation, bool dirty, Ts &... fields)
+  {
+    entry *e = find(name);
+    if (!e) // not cached yet: serialized, but only included in a delta if dirty
+    {
+      segments_m.push_back(entry());
+      e = &segments_m.back();
+      e->name = name;
+      e->modified = false;
+      write(*e, generation, fields...);
+    }
+    else if (e->generation != generation)
+    {
+      write(*e, generation, fields...);
+    }
+    e->modified = e->modified || dirty;
+    return *this;
+  }
+
+  /**
+   * \brief Assemble the cached segments to a uint8 mxArray
+   *
+   * \param[in] delta True to include only the segments dirty since the previous save()
+   * \returns 1-by-N uint8 mxArray blob
+   */
+  mxArray *save(bool delta = false)
+  {
+    uint64_t payload = 0;
+    for (auto &e : segments_m)
+      if (!delta || e.modified)
+        payload += 2 * sizeof(uint64_t) + e.name.size() + e.bytes.size();
+
+    uint16_t flags = mexSerialHeader::segmented | (delta ? mexSerialHeader::delta : 0);
+    mexSerialHeader header = {{'M', 'X', 'S', 'B'}, mexSerialHeader::segmented_format, flags, version_m, 0x01020304, payload};
+#ifdef MATLAB_PRE_R2015A
+    mxArray *blob = mxCreateNumericMatrix(1, (mwSize)(sizeof(header) + payload), mxUINT8_CLASS, mxREAL);
+#else
+    mxArray *blob = mxCreateUninitNumericMatrix(1, (mwSize)(sizeof(header) + payload), mxUINT8_CLASS, mxREAL);
+#endif
+    char *data = (char *)mxGetData(blob);
+    std::memcpy(data, &header, sizeof(header));
+    data += sizeof(header);
+    for (auto &e : segments_m)
+    {
+      if (!delta || e.modified)
+      {
+        data = put(data, e.name.size(), e.name.data());
+        data = put(data, e.bytes.size(), e.bytes.data());
+      }
+      e.modified = false;
+    }
+    return blob;
+  }
+
+  /**
+   * \brief Drop the cached segments (all are serialized on the next call)
+   */
+  void clear() { segments_m.clear(); }
+
+private:
+  struct entry
+  {
+    std::string name;
+    std::vector<char> bytes; // serialized fields
+    uint64_t generation;     // generation of the serialized fields
+    bool modified;           // dirty since the previous save()
+  };
+
+  uint32_t version_m;
+  std::vector<entry> segments_m; // in the order of first use (few segments: linear search)
+
+  entry *find(const std::string &name)
+  {
+    for (auto &e : segments_m)
+      if (e.name == name)
+        return &e;
+    return NULL;
+  }
+
+  template <class... Ts>
+  void write(entry &e, uint64_t generation, Ts &... fields)
+  {
+    e.generation = generation;
+    mexSizeArchive sizer(version_m);
+    sizer(fields...);
+    e.bytes.resize((std::size_t)sizer.size());
+    mexWriteArchive writer(version_m, e.bytes.data());
+    writer(fields...);
+  }
+
+  static char *put(char *dst, uint64_t n, const char *src)
+  {
+    std::memcpy(dst, &n, sizeof(n));
+    if (n)
+      std::memcpy(dst + sizeof(n), src, (std::size_t)n);
+    return dst + sizeof(n) + n;
+  }
+};
+
+/**
+ * \brief Reader of a segmented blob created by mexSerialCache
+ *
+ * The segments are looked up by name, so they may be read in any order. Segments missing in
+ * the blob (i.e., not modified in a delta) are skipped, leaving their fields unchanged:
+ *
+ *    mexSegmentReader reader(blob);
+ *    reader.segment("VarA", VarA).segment("Table", Table, Index);
+ */
+class mexSegmentReader
+{
+public:
+  /**
+   * \throws mexRuntimeError if \p blob is not a valid segmented blob
+   */
+  explicit mexSegmentReader(const mxArray *blob) : header_m(mexSerialHeaderOf(blob))
+  {
+    if (!(header_m.flags & mexSerialHeader::segmented))
+      throw mexRuntimeError("load:invalidData", "Serialized data is not segmented: read it with mexDeserialize().");
+
+    const char *data = (const char *)mxGetData(blob) + sizeof(mexSerialHeader);
+    uint64_t size = mxGetNumberOfElements(blob) - sizeof(mexSerialHeader);
+    if (size != header_m.payload_size)
+      throw mexRuntimeError("load:corruptData", "Serialized data is truncated or corrupt.");
+
+    mexReadArchive index(header_m.version, data, size);
+    while (index.remaining())
+    {
+      std::string name;
+      uint64_t len;
+      index(name, len);
+      index.expect(len);
+      const char *bytes = data + (size - index.remaining());
+      segments_m.push_back({name, bytes, len});
+      index.skip(len);
+    }
+  }
+
+  /**
+   * \brief Class version stored in the blob
+   */
+  uint32_t version() const { return header_m.version; }
+
+  /**
+   * \brief True if the blob is a delta (see mexSerialCache::save())
+   */
+  bool is_delta() const { return (header_m.flags & mexSerialHeader::delta) != 0; }
+
+  /**
+   * \brief Check if the blob contains a segment
+   */
+  bool contains(const std::string &name) const { return find(name) != NULL; }
+
+  /**
+   * \brief Load the fields of a segment if the blob contains it
+   *
+   * \throws mexRuntimeError if the segment does not match the fields
+   */
+  template <class... Ts>
+  mexSegmentReader &segment(const std::string &name, Ts &... fields)
+  {
+    const entry *e = find(name);
+    if (e)
+    {
+      mexReadArchive reader(header_m.version, e->data, e->size);
+      reader(fields...);
+      if (reader.remaining())
+        throw mexRuntimeError("load:corruptData", "Serialized segment " + name + " does not match its fields.");
+    }
+    return *this;
+  }
+
+private:
+  struct entry
+  {
+    std::string name;
+    const char *data;
+    uint64_t size;
+  };
+
+  mexSerialHeader header_m;
+  std::vector<entry> segments_m;
+
+  const entry *find(const std::string &name) const
+  {
+    for (auto &e : segments_m)
+      if (e.name == name)
+        return &e;
+    return NULL;
+  }
+};
@@ -0,0 +1,413 @@
+/** \file mexSharedMemory.h
+ * C++ header file containing the named shared-memory segments to share read-only objects across MATLAB processes
+ */
+
+#pragma once
+
+#include "mexRuntimeError.h" // for mexRuntimeError runtime exception class
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \brief Array stored in a shared-memory segment
+ *
+ * A segment is mapped at a different address in every process, so an object placed in a
+ * segment cannot hold raw pointers. mexSharedArray holds the offset of its elements from
+ * itself instead, which stays valid wherever the segment is mapped as long as both the
+ * array object and its elements reside in the same segment. Copying recomputes the offset
+ * for the new location.
+ *
+ * \tparam U Trivially copyable element type
+ */
+template <class U>
+class mexSharedArray
+{
+  static_assert(std::is_trivially_copyable<U>::value, "mexSharedArray elements must be trivially copyable.");
+
+public:
+  typedef U value_type;
+
+  mexSharedArray() : offset_m(0), size_m(0) {}
+  mexSharedArray(U *data, std::size_t n) : offset_m(offset_to(data)), size_m(n) {}
+  mexSharedArray(const mexSharedArray &other) : offset_m(offset_to(other.data())), size_m(other.size_m) {}
+  mexSharedArray &operator=(const mexSharedArray &other)
+  {
+    offset_m = offset_to(other.data());
+    size_m = other.size_m;
+    return *this;
+  }
+
+  U *data() const { return offset_m ? (U *)((intptr_t)this + offset_m) : nullptr; }
+  std::size_t size() const { return (std::size_t)size_m; }
+  bool empty() const { return !size_m; }
+
+  U *begin() const { return data(); }
+  U *end() const { return data() + size_m; }
+  U &operator[](std::size_t i) const { return data()[i]; }
+
+private:
+  int64_t offset_m; // from this to the first element (0 if none)
+  uint64_t size_m;  // number of elements
+
+  int64_t offset_to(const U *data) const { return data ? (int64_t)((intptr_t)data - (intptr_t)this) : 0; }
+};
+
+/**
+ * \brief Named shared-memory segment
+ *
+ * A segment is created (read-write) by one process, filled by bump-allocating from it,
+ * and published. Other processes on the same machine, e.g., the workers of a MATLAB
+ * parallel pool, attach to it by name (read-only) and access the published object in
+ * place, without a copy.
+ *
+ * The creator removes the name when its mexSharedSegment is destroyed. Processes that
+ * have already attached keep their mappings, but no new process can attach afterwards,
+ * so the creator must outlive the attaching phase. The segment is backed by POSIX shared
+ * memory (`shm_open()`) or a Windows paging-file mapping (`Local\` namespace).
+ *
+ * \note A segment left behind by a crashed process prevents the creation of another one
+ *       with the same name until it is removed (e.g., from /dev/shm on Linux).
+ */
+class mexSharedSegment
+{
+public:
+  /**
+   * \brief Access of a process attaching to an existing segment
+   */
+  enum access
+  {
+    read_only,
+    read_write // for segments written by both processes, e.g., the channel of mexRemoteBackend.h
+  };
+
+  /**
+   * \brief Create a new segment
+   *
+   * \param[in] name Name of the segment (without any path separators)
+   * \param[in] size Size of the segment in bytes, excluding its internal header
+   * \throws mexRuntimeError if the segment already exists or cannot be created
+   */
+  mexSharedSegment(const std::string &name, std::size_t size) : name_m(name), header_m(nullptr), size_m(sizeof(header) + size), owner_m(true), writable_m(true)
+  {
+#ifdef _WIN32
+    map_m = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size_m >> 32), (DWORD)size_m, native_name().c_str());
+    if (!map_m)
+      throw mexRuntimeError("shared:createFailed", "Failed to create shared memory segment " + name + ".");
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+      CloseHandle(map_m);
+      throw mexRuntimeError("shared:alreadyExists", "Shared memory segment " + name + " already exists.");
+    }
+    void *data = MapViewOfFile(map_m, FILE_MAP_WRITE, 0, 0, size_m);
+    if (!data)
+    {
+      CloseHandle(map_m);
+      throw mexRuntimeError("shared:createFailed", "Failed to map shared memory segment " + name + ".");
+    }
+#else
+    int fd = shm_open(native_name().c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+      if (errno == EEXIST)
+        throw mexRuntimeError("shared:alreadyExists", "Shared memory segment " + name + " already exists.");
+      throw mexRuntimeError("shared:createFailed", "Failed to create shared memory segment " + name + ".");
+    }
+    void *data = ftruncate(fd, (off_t)size_m) ? MAP_FAILED : mmap(NULL, size_m, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+      shm_unlink(native_name().c_str());
+      throw mexRuntimeError("shared:createFailed", "Failed to map shared memory segment " + name + ".");
+    }
+#endif
+    // the new pages are zero-filled
+    header_m = new (data) header;
+    std::memcpy(header_m->magic, "MXSHM001", 8);
+    header_m->size = size_m;
+    header_m->used = sizeof(header);
+  }
+
+  /**
+   * \brief Attach to an existing segment
+   *
+   * \param[in] name Name of the segment
+   * \param[in] mode Access to the segment (only its creator may allocate() from it)
+   * \throws mexRuntimeError if the segment does not exist or is not a mexSharedSegment
+   */
+  explicit mexSharedSegment(const std::string &name, access mode = read_only)
+      : name_m(name), header_m(nullptr), size_m(0), owner_m(false), writable_m(mode == read_write)
+  {
+#ifdef _WIN32
+    DWORD map_access = writable_m ? FILE_MAP_WRITE : FILE_MAP_READ;
+    map_m = OpenFileMappingA(map_access, FALSE, native_name().c_str());
+    if (!map_m)
+      throw mexRuntimeError("shared:notFound", "Shared memory segment " + name + " does not exist.");
+    void *data = MapViewOfFile(map_m, map_access, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!data || !VirtualQuery(data, &info, sizeof(info)))
+    {
+      if (data)
+        UnmapViewOfFile(data);
+      CloseHandle(map_m);
+      throw mexRuntimeError("shared:attachFailed", "Failed to map shared memory segment " + name + ".");
+    }
+    size_m = info.RegionSize;
+#else
+    int fd = shm_open(native_name().c_str(), writable_m ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+      throw mexRuntimeError("shared:notFound", "Shared memory segment " + name + " does not exist.");
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (!fstat(fd, &st) && st.st_size > 0)
+    {
+      size_m = (std::size_t)st.st_size;
+      data = mmap(NULL, size_m, writable_m ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED)
+      throw mexRuntimeError("shared:attachFailed", "Failed to map shared memory segment " + name + ".");
+#endif
+    header_m = (header *)data;
+    if (size_m < sizeof(header) || std::memcmp(header_m->magic, "MXSHM001", 8) || header_m->size > size_m)
+    {
+      unmap();
+      throw mexRuntimeError("shared:invalidSegment", "Shared memory segment " + name + " was not created by mexSharedSegment.");
+    }
+  }
+
+  ~mexSharedSegment() { unmap(); }
+
+  mexSharedSegment(const mexSharedSegment &) = delete;
+  mexSharedSegment &operator=(const mexSharedSegment &) = delete;
+
+  /**
+   * \brief Name of the segment
+   */
+  const std::string &name() const { return name_m; }
+
+  /**
+   * \brief True if this process created the segment (and may write to it)
+   */
+  bool owner() const { return owner_m; }
+
+  /**
+   * \brief Number of bytes available for allocate()
+   */
+  std::size_t available() const { return (std::size_t)(header_m->size - header_m->used); }
+
+  /**
+   * \brief Allocate zero-filled memory from the segment (creator only, before publish())
+   *
+   * \throws mexRuntimeError if the segment is read-only, published, or out of space
+   */
+  void *allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t))
+  {
+    if (!owner_m || header_m->root)
+      throw mexRuntimeError("shared:readOnly", "Shared memory segment " + name_m + " is read-only.");
+    uint64_t offset = (header_m->used + align - 1) / align * align;
+    if (offset + bytes > header_m->size)
+      throw mexRuntimeError("shared:outOfSpace", "Shared memory segment " + name_m + " is too small.");
+    header_m->used = offset + bytes;
+    return (char *)header_m + offset;
+  }
+
+  /**
+   * \brief Allocate an array from the segment (creator only, before publish())
+   */
+  template <class U>
+  mexSharedArray<U> allocate_array(std::size_t n)
+  {
+    return mexSharedArray<U>(n ? (U *)allocate(n * sizeof(U), alignof(U)) : nullptr, n);
+  }
+
+  /**
+   * \brief Make an object allocated in the segment available to the attaching processes
+   *
+   * \param[in] root Object in the segment
+   * \param[in] type Type signature checked by root()
+   */
+  void publish(const void *root, uint64_t type)
+  {
+    header_m->type = type;
+    header_m->root = (uint64_t)((const char *)root - (const char *)header_m);
+    header_m->ready.store(1, std::memory_order_release);
+  }
+
+  /**
+   * \brief Get the published object
+   *
+   * \param[in] type Expected type signature
+   * \throws mexRuntimeError if the object is not published yet or of another type
+   */
+  const void *root(uint64_t type) const
+  {
+    if (!header_m->ready.load(std::memory_order_acquire))
+      throw mexRuntimeError("shared:notReady", "Shared memory segment " + name_m + " is not published yet.");
+    if (header_m->type != type)
+      throw mexRuntimeError("shared:typeMismatch", "Shared memory segment " + name_m + " holds an object of another type.");
+    return (const char *)header_m + header_m->root;
+  }
+
+  /**
+   * \brief Get the published object for writing
+   *
+   * \throws mexRuntimeError if the segment is mapped read-only, or as root() const
+   */
+  void *root(uint64_t type)
+  {
+    if (!writable_m)
+      throw mexRuntimeError("shared:readOnly", "Shared memory segment " + name_m + " is read-only.");
+    return const_cast<void *>(static_cast<const mexSharedSegment *>(this)->root(type));
+  }
+
+private:
+  struct header
+  {
+    char magic[8];              // "MXSHM001"
+    uint64_t size;              // segment size including this header
+    uint64_t used;              // bytes allocated including this header
+    uint64_t root;              // offset of the published object
+    uint64_t type;              // type signature of the published object
+    std::atomic<uint32_t> ready; // set once the object is published
+  };
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory requires address-free atomics.");
+
+  std::string name_m;
+  header *header_m;
+  std::size_t size_m; // mapped size
+  bool owner_m;
+  bool writable_m;
+#ifdef _WIN32
+  HANDLE map_m;
+#endif
+
+  std::string native_name() const
+  {
+#ifdef _WIN32
+    return "Local\\" + name_m;
+#else
+    return name_m[0] == '/' ? name_m : "/" + name_m;
+#endif
+  }
+
+  void unmap()
+  {
+    if (!header_m)
+      return;
+#ifdef _WIN32
+    UnmapViewOfFile(header_m);
+    CloseHandle(map_m);
+#else
+    munmap(header_m, size_m);
+    if (owner_m)
+      shm_unlink(native_name().c_str());
+#endif
+    header_m = nullptr;
+  }
+};
+
+/**
+ * \brief Object constructed in a named shared-memory segment
+ *
+ * The creating process constructs the object in a new segment:
+ *
+ *    mexSharedObject<Model> model("model1", capacity, args...); // calls Model(segment, args...)
+ *
+ * and any process on the same machine attaches to it read-only:
+ *
+ *    mexSharedObject<Model> model("model1");
+ *    double w = model->weights[0];
+ *
+ * T must be trivially destructible and must not hold pointers other than mexSharedArray
+ * members allocated from the segment passed to its constructor:
+ *
+ *    struct Model
+ *    {
+ *      double scale;
+ *      mexSharedArray<double> weights;
+ *      Model(mexSharedSegment &seg, std::size_t n) : scale(1.0), weights(seg.allocate_array<double>(n)) {}
+ *    };
+ *
+ * A mexSharedObject is usually held by the wrapped class of a mexObjectHandle, so every
+ * MATLAB process has its own handle to the one shared instance.
+ *
+ * \tparam T Type of the shared object
+ */
+template <class T>
+class mexSharedObject
+{
+  static_assert(std::is_trivially_destructible<T>::value, "mexSharedObject type must be trivially destructible.");
+
+public:
+  /**
+   * \brief Create a segment and construct the object in it
+   *
+   * \param[in] name     Name of the segment
+   * \param[in] capacity Bytes to reserve for the allocations of the constructor
+   * \param[in] args     Arguments passed to `T(mexSharedSegment &, args...)`
+   * \throws mexRuntimeError if the segment cannot be created or is too small
+   */
+  template <class... Args>
+  mexSharedObject(const std::string &name, std::size_t capacity, Args &&... args)
+      : segment_m(name, sizeof(T) + alignof(T) + capacity)
+  {
+    T *obj = new (segment_m.allocate(sizeof(T), alignof(T))) T(segment_m, std::forward<Args>(args)...);
+    segment_m.publish(obj, signature());
+    obj_m = obj;
+  }
+
+  /**
+   * \brief Attach to an object created by another mexSharedObject (read-only)
+   *
+   * \throws mexRuntimeError if the segment does not exist or does not hold a T object
+   */
+  explicit mexSharedObject(const std::string &name) : segment_m(name), obj_m((const T *)static_cast<const mexSharedSegment &>(segment_m).root(signature())) {}
+
+  const T &get() const { return *obj_m; }
+  const T &operator*() const { return *obj_m; }
+  const T *operator->() const { return obj_m; }
+
+  /**
+   * \brief Name of the segment
+   */
+  const std::string &name() const { return segment_m.name(); }
+
+  /**
+   * \brief True if this process created the object
+   */
+  bool owner() const { return segment_m.owner(); }
+
+private:
+  mexSharedSegment segment_m;
+  const T *obj_m;
+
+  // identifies T among the processes running the same MEX module
+  static uint64_t signature()
+  {
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (const char *c = typeid(T).name(); *c; ++c)
+      hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+    return hash ^ sizeof(T);
+  }
+};
@@ -0,0 +1,315 @@
+/** \file mexStats.h
+ * C++ header file containing the optional call instrumentation of mexObjectHandler
+ */
+
+#pragma once
+
+#include <mex.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef MEXUTILS_ENABLE_STATS
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * \brief Latency statistics of an action
+ *
+ * Keeps the number of calls and failures, the total and maximum latency, and a latency
+ * histogram with log2 bins: bin k counts the calls taking [2^k, 2^(k+1)) nanoseconds
+ * (the last bin also counts all the longer calls).
+ */
+struct mexActionStats
+{
+  static const int num_bins = 32;
+
+  uint64_t calls = 0;
+  uint64_t errors = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  uint64_t histogram[num_bins] = {};
+
+  void record(uint64_t ns, bool failed)
+  {
+    ++calls;
+    if (failed)
+      ++errors;
+    total_ns += ns;
+    if (ns > max_ns)
+      max_ns = ns;
+    ++histogram[bin(ns)];
+  }
+
+  static int bin(uint64_t ns)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    int k = 63 - __builtin_clzll(ns | 1);
+#else
+    int k = 0;
+    while (ns >>= 1)
+      ++k;
+#endif
+    return k < num_bins ? k : num_bins - 1;
+  }
+
+  /**
+   * \brief Convert to a scalar MATLAB struct (calls, errors, totalTime, maxTime, histogram)
+   */
+  mxArray *to_mxarray() const
+  {
+    const char *fields[] = {"calls", "errors", "totalTime", "maxTime", "histogram"};
+    mxArray *out = mxCreateStructMatrix(1, 1, 5, fields);
+    mxSetFieldByNumber(out, 0, 0, mxCreateDoubleScalar((double)calls));
+    mxSetFieldByNumber(out, 0, 1, mxCreateDoubleScalar((double)errors));
+    mxSetFieldByNumber(out, 0, 2, mxCreateDoubleScalar(total_ns * 1e-9));
+    mxSetFieldByNumber(out, 0, 3, mxCreateDoubleScalar(max_ns * 1e-9));
+    mxArray *hist = mxCreateDoubleMatrix(1, num_bins, mxREAL);
+    double *h = mxGetPr(hist);
+    for (int k = 0; k < num_bins; ++k)
+      h[k] = (double)histogram[k];
+    mxSetFieldByNumber(out, 0, 4, hist);
+    return out;
+  }
+};
+
+/**
+ * \brief Call statistics of a wrapped class
+ *
+ * Collected by mexObjectHandler() and mexObjectHandle when MEXUTILS_ENABLE_STATS is defined
+ * (CMake option MatlabMexutils_EnableStats):
+ *
+ * * per-action statistics (mexActionStats) of the object and static actions and of the
+ *   object construction, timed from the entry to the return of mexObjectHandler(),
+ * * the statistics of the backend lookup (mxGetProperty() of the `backend` property, or
+ *   the handle check of the fast path), which is a part of the action latencies, and
+ * * the number of live, created, and destroyed objects, and the bytes of the live handles.
+ *
+ * These are returned and reset by the reserved static actions of mexObjectHandler:
+ *
+ *    s = mexfcn('__stats')
+ *    mexfcn('__resetStats')
+ *
+ * \note Use from the MATLAB thread only.
+ *
+ * \tparam mexClass Wrapped class
+ */
+template <class mexClass>
+class mexClassStats
+{
+public:
+  enum kind
+  {
+    create,
+    object,
+    statics,
+  };
+
+  static mexClassStats &instance()
+  {
+    static mexClassStats stats;
+    return stats;
+  }
+
+  /**
+   * \brief Record a call
+   *
+   * \param[in] where  Kind of the call
+   * \param[in] name   Action name (char mxArray, ignored for construction)
+   * \param[in] ns     Latency in nanoseconds
+   * \param[in] failed True if the call threw
+   */
+  void record(kind where, const mxArray *name, uint64_t ns, bool failed)
+  {
+    if (where == create)
+    {
+      create_m.record(ns, failed);
+      return;
+    }
+
+    char buf[64]; // action names rarely exceed the small-string buffer of std::string
+    if (mxGetString(name, buf, sizeof(buf)))
+      buf[sizeof(buf) - 1] = '\0'; // truncated
+    (where == object ? actions_m : statics_m)[buf].record(ns, failed);
+  }
+
+  void record_lookup(uint64_t ns) { lookup_m.record(ns, false); }
+
+  void object_created(std::size_t bytes)
+  {
+    ++live_m;
+    ++created_m;
+    live_bytes_m += bytes;
+  }
+
+  void object_destroyed(std::size_t bytes)
+  {
+    --live_m;
+    ++destroyed_m;
+    live_bytes_m -= bytes;
+  }
+
+  /**
+   * \brief Reset the call statistics and the created/destroyed counts (live counts are kept)
+   */
+  void reset()
+  {
+    actions_m.clear();
+    statics_m.clear();
+    create_m = mexActionStats();
+    lookup_m = mexActionStats();
+    created_m = destroyed_m = 0;
+  }
+
+  /**
+   * \brief Convert to a scalar MATLAB struct
+   *
+   * Fields: liveObjects, liveBytes, created, destroyed, construction, backendLookup,
+   * actions, and staticActions. The last two are structs with a field per action name.
+   */
+  mxArray *to_mxarray() const
+  {
+    const char *fields[] = {"liveObjects", "liveBytes", "created", "destroyed",
+                            "construction", "backendLookup", "actions", "staticActions"};
+    mxArray *out = mxCreateStructMatrix(1, 1, 8, fields);
+    mxSetFieldByNumber(out, 0, 0, mxCreateDoubleScalar((double)live_m));
+    mxSetFieldByNumber(out, 0, 1, mxCreateDoubleScalar((double)live_bytes_m));
+    mxSetFieldByNumber(out, 0, 2, mxCreateDoubleScalar((double)created_m));
+    mxSetFieldByNumber(out, 0, 3, mxCreateDoubleScalar((double)destroyed_m));
+    mxSetFieldByNumber(out, 0, 4, create_m.to_mxarray());
+    mxSetFieldByNumber(out, 0, 5, lookup_m.to_mxarray());
+    mxSetFieldByNumber(out, 0, 6, to_mxarray(actions_m));
+    mxSetFieldByNumber(out, 0, 7, to_mxarray(statics_m));
+    return out;
+  }
+
+private:
+  typedef std::unordered_map<std::string, mexActionStats> action_map;
+
+  action_map actions_m;
+  action_map statics_m;
+  mexActionStats create_m;
+  mexActionStats lookup_m;
+  uint64_t live_m = 0;
+  uint64_t live_bytes_m = 0;
+  uint64_t created_m = 0;
+  uint64_t destroyed_m = 0;
+
+  mexClassStats() {}
+
+  static mxArray *to_mxarray(const action_map &actions)
+  {
+    mxArray *out = mxCreateStructMatrix(1, 1, 0, NULL);
+    for (auto &action : actions)
+    {
+      // actions that are not valid field names (e.g., "__stats") are skipped
+      int field = mxAddField(out, action.first.c_str());
+      if (field >= 0)
+        mxSetFieldByNumber(out, 0, field, action.second.to_mxarray());
+    }
+    return out;
+  }
+};
+
+/**
+ * \brief Timer of a mexObjectHandler() call
+ *
+ * Started on construction, and records the call to mexClassStats when finish() is called
+ * or when it is destroyed, whichever comes first. Calls without a known action (e.g.,
+ * rejected for invalid arguments) are not recorded.
+ */
+template <class mexClass>
+class mexStatsCall
+{
+public:
+  typedef typename mexClassStats<mexClass>::kind kind;
+
+  mexStatsCall() : start_m(clock::now()), name_m(NULL), active_m(false) {}
+  ~mexStatsCall() { finish(false); }
+
+  /**
+   * \brief Set the action being called
+   */
+  void action(kind where, const mxArray *name = NULL)
+  {
+    where_m = where;
+    name_m = name;
+    active_m = true;
+  }
+
+  /**
+   * \brief Mark the end of the backend lookup
+   */
+  void lookup_done() { mexClassStats<mexClass>::instance().record_lookup(elapsed()); }
+
+  /**
+   * \brief Record the call
+   */
+  void finish(bool failed)
+  {
+    if (active_m)
+      mexClassStats<mexClass>::instance().record(where_m, name_m, elapsed(), failed);
+    active_m = false;
+  }
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  clock::time_point start_m;
+  kind where_m;
+  const mxArray *name_m;
+  bool active_m;
+
+  uint64_t elapsed() const
+  {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_m).count();
+  }
+};
+
+#else
+
+/**
+ * \brief Call statistics of a wrapped class (disabled)
+ *
+ * Define MEXUTILS_ENABLE_STATS to collect the statistics. Without it, all the members
+ * are empty and the instrumentation of mexObjectHandler() compiles to nothing.
+ */
+template <class mexClass>
+class mexClassStats
+{
+public:
+  enum kind
+  {
+    create,
+    object,
+    statics,
+  };
+
+  static mexClassStats &instance()
+  {
+    static mexClassStats stats;
+    return stats;
+  }
+
+  void object_created(std::size_t) {}
+  void object_destroyed(std::size_t) {}
+};
+
+/**
+ * \brief Timer of a mexObjectHandler() call (disabled)
+ */
+template <class mexClass>
+class mexStatsCall
+{
+public:
+  typedef typename mexClassStats<mexClass>::kind kind;
+
+  void action(kind, const mxArray * = NULL) {}
+  void lookup_done() {}
+  void finish(bool) {}
+};
+
+#endif
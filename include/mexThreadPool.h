@@ -0,0 +1,353 @@
+/** \file mexThreadPool.h
+ * C++ header file containing the worker thread pool shared by all objects of a MEX module
+ */
+
+#pragma once
+
+#include "mexAtExit.h"      // to stop the workers when the MEX function is cleared
+#include "mexMatlabQueue.h" // to run the operations posted by the workers while stopping them
+
+#include <mex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Work-stealing thread pool of the MEX module
+ *
+ * mexThreadPool is a single pool of worker threads shared by all the objects and actions
+ * of a MEX module, so a session with many wrapped objects does not oversubscribe the
+ * machine. Each worker owns a task deque: tasks submitted from a worker go to its own
+ * deque (processed LIFO for locality), tasks submitted from other threads are distributed
+ * round-robin, and an idle worker steals the oldest task of another worker.
+ *
+ * The workers are started lazily on the first submission, and they are stopped when
+ * MATLAB clears the MEX function (the pool registers its teardown with mexOnExit()) or
+ * when the number of threads is changed while the pool is idle. The number of threads
+ * defaults to std::thread::hardware_concurrency() and may be changed from MATLAB with the
+ * built-in static action of mexObjectHandler:
+ *
+ *    mexfcn('setNumThreads', n)
+ *
+ * \note Tasks must not call any MATLAB API function. Submission and parallel_for() may be
+ *       called from any thread, but set_num_threads() and shutdown() only from the
+ *       MATLAB thread.
+ * \note mexExitHandlers occupies mexAtExit() of the MEX module. A MEX function needing its
+ *       own exit handler must register it with mexOnExit() instead (see mexAtExit.h).
+ */
+class mexThreadPool
+{
+public:
+  /**
+   * \brief Thread pool of the MEX module
+   */
+  static mexThreadPool &instance()
+  {
+    static mexThreadPool pool;
+    return pool;
+  }
+
+  /**
+   * \brief Exit handler registered with mexOnExit()
+   */
+  static void at_exit() { instance().shutdown(); }
+
+  ~mexThreadPool() { shutdown(false); } // MATLAB (and the MATLAB queue) may already be gone
+
+  mexThreadPool(const mexThreadPool &) = delete;
+  mexThreadPool &operator=(const mexThreadPool &) = delete;
+
+  /**
+   * \brief Number of worker threads (running or to be started)
+   */
+  std::size_t num_threads() const { return num_threads_m; }
+
+  /**
+   * \brief Change the number of worker threads
+   *
+   * The number can only be changed while the pool is idle, as a queued or running task
+   * (e.g., a background job) may take any length of time to finish. The idle workers are
+   * stopped, and the new number of workers is started on the next submission.
+   *
+   * \param[in] n Number of threads (0 for the number of hardware threads, clamped to max_num_threads())
+   * \returns false if the pool is busy and the number was not changed
+   */
+  bool set_num_threads(std::size_t n)
+  {
+    n = n ? std::min(n, max_num_threads()) : default_num_threads();
+    if (n == num_threads_m)
+      return true;
+    if (busy())
+      return false;
+    shutdown();
+    num_threads_m = n;
+    return true;
+  }
+
+  /**
+   * \brief Check if any task is queued or running
+   */
+  bool busy()
+  {
+    std::lock_guard<std::mutex> lock(mutex_m);
+    return pending_m || running_m;
+  }
+
+  /**
+   * \brief Maximum number of worker threads (16 per hardware thread)
+   */
+  static std::size_t max_num_threads() { return 16 * default_num_threads(); }
+
+  /**
+   * \brief Stop all worker threads after they finish the queued tasks
+   *
+   * While waiting for the workers, the operations they defer to the MATLAB thread (see
+   * mexMatlabQueue) are run periodically, so a task printing progress or waiting on
+   * mexPostCall() does not deadlock the MATLAB thread.
+   *
+   * \param[in] drain false to skip draining the MATLAB queue (when MATLAB is unavailable)
+   */
+  void shutdown(bool drain = true)
+  {
+    std::lock_guard<std::mutex> guard(start_mutex_m);
+    if (workers_m.empty())
+      return;
+    std::unique_lock<std::mutex> lock(mutex_m);
+    stop_m = true;
+    cv_m.notify_all();
+    const std::size_t n = workers_m.size();
+    while (drain && exited_m < n)
+    {
+      lock.unlock();
+      mexMatlabQueue::instance().drain();
+      lock.lock();
+      exit_cv_m.wait_for(lock, std::chrono::milliseconds(10), [this, n]() { return exited_m == n; });
+    }
+    lock.unlock();
+    for (auto &w : workers_m)
+      w->thread.join();
+    if (drain)
+      mexMatlabQueue::instance().drain(); // the tasks' last posts
+    started_m = false;
+    workers_m.clear();
+    exited_m = 0;
+    stop_m = false;
+  }
+
+  /**
+   * \brief Queue a task
+   */
+  void submit(std::function<void()> task)
+  {
+    start();
+    worker *self = current();
+    worker &w = self && self->pool == this ? *self : *workers_m[next_m++ % workers_m.size()];
+    {
+      std::lock_guard<std::mutex> lock(mutex_m); // count first so pop() never underflows it
+      ++pending_m;
+    }
+    {
+      std::lock_guard<std::mutex> lock(w.mutex);
+      w.tasks.push_back(std::move(task));
+    }
+    cv_m.notify_one();
+  }
+
+  /**
+   * \brief Run fcn(i) for i in [begin, end) in parallel and wait for them
+   *
+   * The range is split into chunks of \p grain indices. The calling thread processes
+   * chunks as well, so parallel_for() may be nested or called from a task without
+   * deadlocking. If any call throws, the remaining chunks are skipped and the first
+   * exception is rethrown on the calling thread.
+   *
+   * \param[in] begin First index
+   * \param[in] end   One past the last index
+   * \param[in] fcn   Callable as `void(std::size_t i)`
+   * \param[in] grain Number of indices per chunk (0 to select automatically)
+   */
+  template <class Fcn>
+  void parallel_for(std::size_t begin, std::size_t end, Fcn fcn, std::size_t grain = 0)
+  {
+    if (end <= begin)
+      return;
+    std::size_t n = end - begin;
+    start();
+    if (!grain)
+      grain = std::max<std::size_t>(1, n / (8 * workers_m.size()));
+    std::size_t nchunks = (n + grain - 1) / grain;
+
+    struct state
+    {
+      std::atomic<std::size_t> next{0}, done{0};
+      std::atomic<bool> failed{false};
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable cv;
+    };
+    auto st = std::make_shared<state>();
+    auto body = [st, begin, end, grain, nchunks, &fcn]() {
+      std::size_t c;
+      while ((c = st->next++) < nchunks)
+      {
+        if (!st->failed)
+        {
+          try
+          {
+            std::size_t last = std::min(end, begin + (c + 1) * grain);
+            for (std::size_t i = begin + c * grain; i < last; ++i)
+              fcn(i);
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(st->mutex);
+            if (!st->failed.exchange(true))
+              st->error = std::current_exception();
+          }
+        }
+        if (++st->done == nchunks)
+        {
+          std::lock_guard<std::mutex> lock(st->mutex);
+          st->cv.notify_all();
+        }
+      }
+    };
+
+    // helpers only touch fcn while a chunk is unfinished, i.e., while this call is waiting
+    std::size_t nhelpers = std::min(nchunks - 1, workers_m.size());
+    for (std::size_t k = 0; k < nhelpers; ++k)
+      submit(body);
+    body();
+
+    std::unique_lock<std::mutex> lock(st->mutex);
+    st->cv.wait(lock, [&st, nchunks]() { return st->done == nchunks; });
+    if (st->error)
+      std::rethrow_exception(st->error);
+  }
+
+private:
+  struct worker
+  {
+    mexThreadPool *pool;
+    std::mutex mutex;                       // guards tasks
+    std::deque<std::function<void()>> tasks; // own tasks (back) / stolen (front)
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<worker>> workers_m;
+  std::size_t num_threads_m;
+  std::atomic<std::size_t> next_m;   // round-robin target for external submissions
+  std::atomic<bool> started_m;       // true while workers_m is populated
+  std::mutex start_mutex_m;          // guards starting/stopping workers
+  std::mutex mutex_m;                // guards pending_m, running_m, exited_m & stop_m for sleeping workers
+  std::condition_variable cv_m;      // signaled on new task or stop
+  std::condition_variable exit_cv_m; // signaled when a worker exits
+  std::size_t pending_m;             // number of queued tasks
+  std::size_t running_m;             // number of running tasks
+  std::size_t exited_m;              // number of workers that left run() since stop_m was set
+  bool stop_m;
+
+  mexThreadPool() : num_threads_m(default_num_threads()), next_m(0), started_m(false), pending_m(0), running_m(0), exited_m(0), stop_m(false)
+  {
+    mexOnExit(&mexThreadPool::at_exit);
+  }
+
+  static std::size_t default_num_threads()
+  {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+  }
+
+  static worker *&current()
+  {
+    static thread_local worker *w = nullptr;
+    return w;
+  }
+
+  void start()
+  {
+    if (started_m) // also lets tasks submit while the pool is shutting down
+      return;
+    std::lock_guard<std::mutex> guard(start_mutex_m);
+    if (started_m)
+      return;
+    for (std::size_t k = 0; k < num_threads_m; ++k)
+    {
+      workers_m.emplace_back(new worker);
+      workers_m.back()->pool = this;
+    }
+    for (std::size_t k = 0; k < num_threads_m; ++k)
+      workers_m[k]->thread = std::thread(&mexThreadPool::run, this, k);
+    started_m = true;
+  }
+
+  bool pop(std::size_t k, std::function<void()> &task)
+  {
+    // own deque first (newest), then steal from the others (oldest)
+    std::size_t n = workers_m.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      worker &w = *workers_m[(k + i) % n];
+      std::lock_guard<std::mutex> lock(w.mutex);
+      if (w.tasks.empty())
+        continue;
+      if (i == 0)
+      {
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move(w.tasks.front());
+        w.tasks.pop_front();
+      }
+      std::lock_guard<std::mutex> lock2(mutex_m);
+      --pending_m;
+      ++running_m;
+      return true;
+    }
+    return false;
+  }
+
+  void run(std::size_t k)
+  {
+    current() = workers_m[k].get();
+    std::function<void()> task;
+    for (;;)
+    {
+      if (pop(k, task))
+      {
+        try
+        {
+          task();
+        }
+        catch (...) // tasks are responsible to report their own errors
+        {
+        }
+        task = nullptr;
+        std::lock_guard<std::mutex> lock(mutex_m);
+        --running_m;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_m);
+      cv_m.wait(lock, [this]() { return pending_m > 0 || stop_m; });
+      if (stop_m && pending_m == 0)
+      {
+        ++exited_m;
+        exit_cv_m.notify_all();
+        break;
+      }
+    }
+    current() = nullptr;
+  }
+};
@@ -0,0 +1,214 @@
+/** \file mexVector.h
+ * C++ header file containing a vector container whose buffer can be handed over to an mxArray
+ */
+
+#pragma once
+
+#include "mexAllocator.h" // MATLAB memory manager allocator
+#include "mexClassId.h"   // mxClassID of element type
+
+#include <mex.h>
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * \brief Contiguous container in MATLAB-managed memory
+ *
+ * mexVector is a minimal std::vector-like container of a simple (trivially copyable)
+ * element type whose buffer is allocated by \ref mexAllocator, i.e., from the MATLAB
+ * memory manager as persistent memory. Because the buffer is compatible with mxSetData(),
+ * it can be exported to MATLAB in two ways:
+ *
+ * * to_mxArray() copies the elements to a new mxArray. Use it when the C++ object keeps
+ *   owning the data (copy-on-export).
+ * * release_mxArray() hands the buffer itself over to a new mxArray in O(1) without any
+ *   copy. The mexVector is left empty (move-out).
+ *
+ * Results computed in a mexVector can therefore be returned to MATLAB without copying
+ * no matter how large they are.
+ *
+ * \tparam T Element type, which must be mapped to a MATLAB class by \ref mexClassId
+ *           (e.g., double, float, int32_t, mxLogical).
+ */
+template <typename T>
+class mexVector
+{
+  static_assert(std::is_trivially_copyable<T>::value, "mexVector only supports trivially copyable element types.");
+
+public:
+  typedef T value_type;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+  typedef std::size_t size_type;
+  typedef mexAllocator<T> allocator_type;
+
+  mexVector() : data_m(NULL), size_m(0), capacity_m(0) {}
+  explicit mexVector(size_type n) : mexVector() { resize(n); }
+  mexVector(size_type n, const T &value) : mexVector() { resize(n, value); }
+  mexVector(std::initializer_list<T> values) : mexVector() { assign(values.begin(), values.end()); }
+  mexVector(const mexVector &other) : mexVector() { assign(other.begin(), other.end()); }
+  mexVector(mexVector &&other) : data_m(other.data_m), size_m(other.size_m), capacity_m(other.capacity_m)
+  {
+    other.data_m = NULL;
+    other.size_m = other.capacity_m = 0;
+  }
+  ~mexVector() { deallocate(); }
+
+  mexVector &operator=(const mexVector &other)
+  {
+    if (this != &other)
+      assign(other.begin(), other.end());
+    return *this;
+  }
+  mexVector &operator=(mexVector &&other)
+  {
+    if (this != &other)
+    {
+      deallocate();
+      std::swap(data_m, other.data_m);
+      std::swap(size_m, other.size_m);
+      std::swap(capacity_m, other.capacity_m);
+    }
+    return *this;
+  }
+
+  T *data() { return data_m; }
+  const T *data() const { return data_m; }
+  size_type size() const { return size_m; }
+  size_type capacity() const { return capacity_m; }
+  bool empty() const { return size_m == 0; }
+
+  iterator begin() { return data_m; }
+  iterator end() { return data_m + size_m; }
+  const_iterator begin() const { return data_m; }
+  const_iterator end() const { return data_m + size_m; }
+
+  T &operator[](size_type i) { return data_m[i]; }
+  const T &operator[](size_type i) const { return data_m[i]; }
+  T &back() { return data_m[size_m - 1]; }
+  const T &back() const { return data_m[size_m - 1]; }
+
+  void clear() { size_m = 0; }
+
+  void reserve(size_type n)
+  {
+    if (n > capacity_m)
+      reallocate(n);
+  }
+
+  void resize(size_type n)
+  {
+    reserve(n);
+    if (n > size_m)
+      std::fill(data_m + size_m, data_m + n, T());
+    size_m = n;
+  }
+
+  void resize(size_type n, const T &value)
+  {
+    reserve(n);
+    if (n > size_m)
+      std::fill(data_m + size_m, data_m + n, value);
+    size_m = n;
+  }
+
+  void push_back(const T &value)
+  {
+    if (size_m == capacity_m)
+      reallocate(capacity_m ? 2 * capacity_m : 4);
+    data_m[size_m++] = value;
+  }
+
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last)
+  {
+    size_type n = (size_type)std::distance(first, last);
+    reserve(n);
+    std::copy(first, last, data_m);
+    size_m = n;
+  }
+
+  /**
+   * \brief Copy the elements to a new column vector mxArray (copy-on-export)
+   */
+  mxArray *to_mxArray() const { return to_mxArray(size_m, 1); }
+
+  /**
+   * \brief Copy the elements to a new m-by-n mxArray (copy-on-export)
+   *
+   * \throws std::length_error if m*n does not match the number of elements
+   */
+  mxArray *to_mxArray(mwSize m, mwSize n) const
+  {
+    check_dims(m, n);
+    mxArray *out = mxCreateNumericMatrix(m, n, mexClassId<T>::value, mxREAL);
+    if (size_m)
+      std::memcpy(mxGetData(out), data_m, size_m * sizeof(T));
+    return out;
+  }
+
+  /**
+   * \brief Hand over the buffer to a new column vector mxArray (move-out)
+   */
+  mxArray *release_mxArray() { return release_mxArray(size_m, 1); }
+
+  /**
+   * \brief Hand over the buffer to a new m-by-n mxArray (move-out)
+   *
+   * No element is copied: the buffer becomes the data of the returned mxArray via
+   * mxSetData() and the mexVector is left empty.
+   *
+   * \throws std::length_error if m*n does not match the number of elements
+   */
+  mxArray *release_mxArray(mwSize m, mwSize n)
+  {
+    check_dims(m, n);
+    // trim the unused capacity (in-place for the MATLAB memory manager), keeps the buffer on failure
+    if (size_m && capacity_m > size_m)
+      reallocate(size_m);
+    mxArray *out = mxCreateNumericMatrix(0, 0, mexClassId<T>::value, mxREAL);
+    if (size_m)
+    {
+      mxSetData(out, data_m);
+      mxSetM(out, m);
+      mxSetN(out, n);
+    }
+    else
+    {
+      deallocate();
+    }
+    data_m = NULL;
+    size_m = capacity_m = 0;
+    return out;
+  }
+
+private:
+  T *data_m;
+  size_type size_m;
+  size_type capacity_m;
+
+  void check_dims(mwSize m, mwSize n) const
+  {
+    if (m * n != size_m)
+      throw std::length_error("mexVector: mxArray dimensions do not match the number of elements.");
+  }
+
+  void reallocate(size_type n)
+  {
+    // mxRealloc may grow the buffer in place; otherwise it copies the elements
+    data_m = allocator_type().reallocate(data_m, capacity_m, n);
+    capacity_m = n;
+  }
+
+  void deallocate()
+  {
+    if (data_m)
+      allocator_type().deallocate(data_m, capacity_m);
+    data_m = NULL;
+    capacity_m = 0;
+  }
+};